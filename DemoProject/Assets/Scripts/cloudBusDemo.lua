@@ -34,12 +34,6 @@ local cloud_bus_demo = {
             p04_sunLightIntensity = {
                 default = 1.0
             },
-            p05_ambientLightColor = {
-                default = Color(1.0, 1.0, 1.0, 1.0)
-            },
-            p06_ambientLightIntensity = {
-                default = 1.0
-            },
         },
         weatherData = {
             p00_weatherMapSizeKm = 100.0,
@@ -137,13 +131,6 @@ function cloud_bus_demo:_OnTickState_Running(deltaTime, timePoint)
     sunLightColorAndIntensity.a = pdProps.p04_sunLightIntensity
     VolumetricCloudsRequestBus.Broadcast.SetSunLightColorAndIntensity(sunLightColorAndIntensity)
 
-    local ambientLightColorAndIntensity = VolumetricCloudsRequestBus.Broadcast.GetAmbientLightColorAndIntensity()
-    Debug.Log("Current ambientLightColor=" .. tostring(ambientLightColorAndIntensity) .. ", will be changed to " .. tostring(pdProps.p05_ambientLightColor))
-    Debug.Log("Current ambientLightIntensity=" .. tostring(ambientLightColorAndIntensity.a) .. ", will be changed to " .. tostring(pdProps.p06_ambientLightIntensity))
-    ambientLightColorAndIntensity = pdProps.p05_ambientLightColor:Clone()
-    ambientLightColorAndIntensity.a = pdProps.p06_ambientLightIntensity
-    VolumetricCloudsRequestBus.Broadcast.SetAmbientLightColorAndIntensity(ambientLightColorAndIntensity)
-
     -- Weather data
     local wdProps = self.Properties.weatherData
 
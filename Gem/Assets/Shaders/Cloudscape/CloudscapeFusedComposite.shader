@@ -0,0 +1,36 @@
+{
+  "Source": "CloudscapeFusedComposite.azsl",
+  "AddBuildArguments": {
+    "debug": false
+  },
+  "DepthStencilState" : 
+  {
+      "Depth" : 
+      { 
+          "Enable" : false 
+      },
+      "Stencil" :
+      {
+          "Enable" : false
+      }
+  },
+  "GlobalTargetBlendState" : {
+    "Enable" : true,
+    "BlendSource" : "One",
+    "BlendDest" : "AlphaSourceInverse",
+    "BlendOp" : "Add"
+},
+  "DrawList": "cloudscape",
+  "ProgramSettings": {
+    "EntryPoints": [
+      {
+        "name": "MainVS",
+        "type": "Vertex"
+      },
+      {
+        "name": "MainPS",
+        "type": "Fragment"
+      }
+    ]
+  }
+}
@@ -0,0 +1,16 @@
+{
+  "Source": "CloudscapeShadowMapCS.azsl",
+  "AddBuildArguments": {
+    "debug": false
+  },
+  "ProgramSettings":
+  {
+    "EntryPoints":
+    [
+      {
+        "name": "MainCS",
+        "type": "Compute"
+      }
+    ]
+  }
+}
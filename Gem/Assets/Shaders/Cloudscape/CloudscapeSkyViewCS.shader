@@ -0,0 +1,16 @@
+{
+  "Source": "CloudscapeSkyViewCS.azsl",
+  "AddBuildArguments": {
+    "debug": false
+  },
+  "ProgramSettings":
+  {
+    "EntryPoints":
+    [
+      {
+        "name": "MainCS",
+        "type": "Compute"
+      }
+    ]
+  }
+}
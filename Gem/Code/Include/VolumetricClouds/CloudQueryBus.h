@@ -0,0 +1,102 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/EBus/EBus.h>
+#include <AzCore/Interface/Interface.h>
+#include <AzCore/Math/Vector3.h>
+#include <AzCore/std/containers/span.h>
+#include <AzCore/std/parallel/mutex.h>
+
+#include <VolumetricClouds/VolumetricCloudsTypeIds.h>
+
+namespace VolumetricClouds
+{
+    // Result of a line of sight query through the cloud layer.
+    struct CloudTransmittanceResult
+    {
+        // Integral of the extinction along the segment. Unitless.
+        float m_opticalDepth = 0.0f;
+        // exp(-m_opticalDepth). 1 means the segment doesn't cross any clouds, 0 means it is fully blocked.
+        float m_transmittance = 1.0f;
+    };
+
+    // See CloudQueryRequests::GetCloudQueryStatus().
+    enum class CloudQueryStatus : uint32_t
+    {
+        // There's no cloudscape, or its textures are still loading.
+        NotReady,
+        Ready,
+        // At least one of the textures will never have a CPU copy. The queries always fail.
+        Unsupported,
+    };
+
+    // CPU queries of the cloud layer for gameplay, e.g. aircraft turbulence, visibility or AI sensors.
+    // They evaluate the same density function as CloudscapeCS.azsl, from CPU copies of the noise textures
+    // and the weather map, and with the shader constants of the current frame.
+    // The CPU copies are only available for the textures loaded from R8G8B8A8 or B8G8R8A8 streaming image assets,
+    // e.g. by a CloudTextureAssetComponent. The noise textures generated at runtime by a CloudTextureComputeComponent,
+    // the default setup, only exist on the GPU, so the density and transmittance queries are not supported with them.
+    // All the functions are thread safe, and can be called from jobs.
+    class CloudQueryRequests
+    {
+    public:
+        AZ_RTTI(CloudQueryRequests, CloudQueryRequestsTypeId);
+        virtual ~CloudQueryRequests() = default;
+
+        // Returns false while the CPU copies of the textures are not available, for example
+        // if the noise textures are generated on the GPU. See CloudDensitySampler.
+        virtual bool IsCloudQueryReady() = 0;
+        // Same as IsCloudQueryReady(), but tells the textures that are still loading apart from the ones that
+        // can't be read on the CPU. A query that returns false while the status is Unsupported will never succeed,
+        // and its results of 0 density, or full transmittance, don't mean there are no clouds.
+        virtual CloudQueryStatus GetCloudQueryStatus() = 0;
+
+        // Writes the cloud density at each one of @worldPositions, in meters, to @densities. Both spans must
+        // have the same size. Points outside of the cloud slab get 0. Returns false, and fills
+        // @densities with 0, if the query is not ready.
+        virtual bool QueryCloudDensity(AZStd::span<const AZ::Vector3> worldPositions, AZStd::span<float> densities) = 0;
+
+        // Marches the clouds between each pair of @segmentStarts and @segmentEnds, in meters, and writes how much
+        // light makes it through to @results. Useful to tell if a target is hidden by the clouds. The three spans
+        // must have the same size. Returns false, and fills @results with fully visible segments,
+        // if the query is not ready.
+        virtual bool QueryCloudTransmittance(AZStd::span<const AZ::Vector3> segmentStarts, AZStd::span<const AZ::Vector3> segmentEnds,
+            AZStd::span<CloudTransmittanceResult> results) = 0;
+
+        // Unlike the queries above, the sun visibility is evaluated on the GPU, with the same density function
+        // as the rendered clouds, so it also works with noise textures generated at runtime.
+        // Replaces the list of world positions, in meters, whose transmittance towards the sun is evaluated
+        // every frame, e.g. the player position or light probes. Up to 256 positions. An empty list stops the evaluation.
+        virtual void SetSunVisibilityPositions(AZStd::span<const AZ::Vector3> worldPositions) = 0;
+
+        // Writes the latest transmittance towards the sun, between 0 and 1, of each one of the positions
+        // given to SetSunVisibilityPositions() to @transmittances. The results are read back from the GPU
+        // asynchronously, so they are at least one frame old, and right after the positions change they may
+        // still belong to the previous positions. Positions without results get 1.
+        // Returns false if no results have been read back yet.
+        virtual bool GetSunVisibility(AZStd::span<float> transmittances) = 0;
+    };
+
+    class CloudQueryBusTraits
+        : public AZ::EBusTraits
+    {
+    public:
+        //////////////////////////////////////////////////////////////////////////
+        // EBusTraits overrides
+        static constexpr AZ::EBusHandlerPolicy HandlerPolicy = AZ::EBusHandlerPolicy::Single;
+        static constexpr AZ::EBusAddressPolicy AddressPolicy = AZ::EBusAddressPolicy::Single;
+        // The handler is thread safe, calls from different threads don't need to be serialized.
+        using MutexType = AZStd::recursive_mutex;
+        static constexpr bool LocklessDispatch = true;
+        //////////////////////////////////////////////////////////////////////////
+    };
+
+    using CloudQueryRequestBus = AZ::EBus<CloudQueryRequests, CloudQueryBusTraits>;
+    using CloudQueryInterface = AZ::Interface<CloudQueryRequests>;
+
+} // namespace VolumetricClouds
@@ -8,6 +8,9 @@
 
 #include <AzCore/EBus/EBus.h>
 #include <AzCore/Interface/Interface.h>
+#include <AzCore/Math/Vector2.h>
+#include <AzCore/RTTI/TypeInfoSimple.h>
+#include <AzCore/std/containers/vector.h>
 
 #include <VolumetricClouds/VolumetricCloudsTypeIds.h>
 
@@ -16,6 +19,17 @@ namespace VolumetricClouds
     class CloudTexturesFeatureProcessor;
     struct CloudMaterialProperties;
 
+    // The parameters that can be animated with VolumetricCloudsRequests::AnimateParameter().
+    enum class AnimatedCloudParameter : uint32_t
+    {
+        CloudCoverage,
+        CloudDensity,
+        WindSpeedKmPerSec,
+        CloudTopShiftKm,
+        SunLightIntensity,
+        Count
+    };
+
     class VolumetricCloudsRequests
     {
     public:
@@ -46,8 +60,6 @@ namespace VolumetricClouds
         virtual void SetCloudSlabThicknessKm(float thicknessKm) = 0;
         virtual AZ::Color GetSunLightColorAndIntensity() = 0; // Alpha is the intensity
         virtual void SetSunLightColorAndIntensity(const AZ::Color& rgbColorAlphaIntensity) = 0;
-        virtual AZ::Color GetAmbientLightColorAndIntensity() = 0; // Alpha is the intensity
-        virtual void SetAmbientLightColorAndIntensity(const AZ::Color& rgbColorAlphaIntensity) = 0;
         // Weather Data
         virtual float GetWeatherMapSizeKm() = 0;
         virtual void SetWeatherMapSizeKm(float mapSizeKm) = 0;
@@ -62,6 +74,16 @@ namespace VolumetricClouds
         // Cloud Material Properties 
         virtual const CloudMaterialProperties& GetCloudMaterialProperties() = 0;
         virtual void SetCloudMaterialProperties(const CloudMaterialProperties& cmp) = 0;
+        // Animation
+        // Plays a curve on @parameter, evaluated by the renderer once per frame, so there's no need
+        // to call the Set..() functions every tick. Each keyframe is (normalizedTime, value), where normalizedTime
+        // goes from 0 to 1 over @durationSeconds. Values are linearly interpolated, and when the curve ends the last value
+        // is held. Replaces any animation already playing on @parameter. Calling the matching Set..() function,
+        // or StopParameterAnimation(), stops the animation and the parameter goes back to its set value.
+        // The Get..() functions always return the set value, not the animated one. The animations started
+        // with this function are not saved with the component configuration.
+        virtual void AnimateParameter(AnimatedCloudParameter parameter, const AZStd::vector<AZ::Vector2>& keyframes, float durationSeconds) = 0;
+        virtual void StopParameterAnimation(AnimatedCloudParameter parameter) = 0;
 
         // Submits the current state of the parameters to the renderer.
         virtual void EndCallBatch() = 0;
@@ -83,3 +105,8 @@ namespace VolumetricClouds
     using VolumetricCloudsInterface = AZ::Interface<VolumetricCloudsRequests>;
 
 } // namespace VolumetricClouds
+
+namespace AZ
+{
+    AZ_TYPE_INFO_SPECIALIZE(VolumetricClouds::AnimatedCloudParameter, VolumetricClouds::AnimatedCloudParameterTypeId);
+}
@@ -0,0 +1,106 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/EBus/EBus.h>
+#include <AzCore/Interface/Interface.h>
+#include <AzCore/std/containers/vector.h>
+#include <AzCore/std/string/string.h>
+
+#include <VolumetricClouds/VolumetricCloudsTypeIds.h>
+
+namespace VolumetricClouds
+{
+    // Rolling statistics of a single profiled scope. GPU scopes are measured
+    // with timestamp queries around the cloud passes, CPU scopes with a high resolution clock.
+    // All times are in milliseconds and cover, at most, the last few hundred samples.
+    struct VolumetricCloudsScopeStats
+    {
+        uint32_t m_sampleCount = 0;
+        float m_averageMs = 0.0f;
+        float m_p50Ms = 0.0f;
+        float m_p95Ms = 0.0f;
+        float m_p99Ms = 0.0f;
+        float m_maxMs = 0.0f;
+        // Pipeline statistics of the latest GPU sample. Always 0 for CPU scopes.
+        uint64_t m_computeShaderInvocations = 0;
+        uint64_t m_fragmentShaderInvocations = 0;
+    };
+
+    // Totals of the per pixel ray marching counters of the last frame that was read back.
+    // Only available while the "r_volumetricCloudsRayMarchDebugView" console variable is not 0.
+    // Only 1 of every 16 pixels is ray marched per frame, so each pixel contributes the counters
+    // of the last frame it was ray marched in, and the totals span the last 16 frames.
+    struct VolumetricCloudsRayMarchTotals
+    {
+        uint64_t m_pixelCount = 0;
+        uint64_t m_primarySteps = 0;
+        uint64_t m_lightSamples = 0;
+        uint64_t m_expensiveDensityCalls = 0;
+        // Includes the light samples.
+        uint64_t m_cheapDensityCalls = 0;
+        // Why the ray marching loop ended, in number of pixels.
+        uint64_t m_notRayMarchedPixels = 0;
+        uint64_t m_endOfSlabPixels = 0;
+        uint64_t m_earlyExitPixels = 0;
+    };
+
+    // Profiling of the volumetric clouds passes. Collecting stats enables the timestamp and pipeline statistics
+    // queries of the cloud passes, so it is disabled by default. It can also be toggled
+    // with the "r_volumetricCloudsCollectStats" console variable.
+    class VolumetricCloudsStatsRequests
+    {
+    public:
+        AZ_RTTI(VolumetricCloudsStatsRequests, VolumetricCloudsStatsRequestsTypeId);
+        virtual ~VolumetricCloudsStatsRequests() = default;
+
+        virtual bool IsCollectingStats() const = 0;
+        virtual void SetCollectingStats(bool enable) = 0;
+
+        // Names like "GPU/CloudscapeComputePass" or "CPU/SubmitShaderConstantData".
+        virtual AZStd::vector<AZStd::string> GetScopeNames() const = 0;
+        // Returns false if @scopeName is unknown.
+        virtual bool GetScopeStats(const AZStd::string& scopeName, VolumetricCloudsScopeStats& stats) const = 0;
+        virtual void ResetStats() = 0;
+
+        // Returns false if the ray marching debug view is disabled or nothing has been read back yet.
+        virtual bool GetRayMarchTotals(VolumetricCloudsRayMarchTotals& totals) const = 0;
+
+        // While active, each frame appends one row to a CSV file, with one column per scope.
+        // Columns are empty for the scopes that were not measured during that frame.
+        // Collects stats while it is active, and then StopCsvFrameLog() restores the previous IsCollectingStats() state.
+        virtual bool StartCsvFrameLog(const AZStd::string& filePath) = 0;
+        virtual void StopCsvFrameLog() = 0;
+
+        // Discards the collected samples, collects stats during the next @frameCount frames, at most the few hundred
+        // samples kept per scope, and then appends one row per measured scope to the CSV file at @summaryFilePath,
+        // tagged with @label. Running it twice with the same camera and settings, e.g. with the labels "before"
+        // and "after" around a shader change, leaves both results side by side in the same file.
+        // Each row has the number of frames and the number of samples of the scope. Fewer samples than frames,
+        // when there are less frames than the samples kept per scope, means the scope was not measured every frame.
+        // Collects stats while it runs, and then restores the previous IsCollectingStats() state.
+        // The convergence and the dynamic quality of the clouds are suspended while it runs, so every frame
+        // does the full work at the highest quality.
+        virtual bool StartBenchmark(const AZStd::string& label, uint32_t frameCount, const AZStd::string& summaryFilePath) = 0;
+        virtual bool IsBenchmarkRunning() const = 0;
+    };
+
+    class VolumetricCloudsStatsBusTraits
+        : public AZ::EBusTraits
+    {
+    public:
+        //////////////////////////////////////////////////////////////////////////
+        // EBusTraits overrides
+        static constexpr AZ::EBusHandlerPolicy HandlerPolicy = AZ::EBusHandlerPolicy::Single;
+        static constexpr AZ::EBusAddressPolicy AddressPolicy = AZ::EBusAddressPolicy::Single;
+        //////////////////////////////////////////////////////////////////////////
+    };
+
+    using VolumetricCloudsStatsRequestBus = AZ::EBus<VolumetricCloudsStatsRequests, VolumetricCloudsStatsBusTraits>;
+    using VolumetricCloudsStatsInterface = AZ::Interface<VolumetricCloudsStatsRequests>;
+
+} // namespace VolumetricClouds
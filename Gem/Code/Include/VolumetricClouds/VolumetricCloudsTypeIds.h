@@ -24,6 +24,8 @@ namespace VolumetricClouds
     // Interface TypeIds
     inline constexpr const char* VolumetricCloudsRequestsTypeId = "{01F82831-F461-41A3-A116-5E6FAC87038F}";
     inline constexpr const char* CloudTextureSystemRequestsTypeId = "{08CF7D92-BF8B-4589-97E4-050861E25EDB}";
+    inline constexpr const char* VolumetricCloudsStatsRequestsTypeId = "{3E9A6C51-0B7D-4F28-9C14-D85A2F6E7B03}";
+    inline constexpr const char* CloudQueryRequestsTypeId = "{A41D7E26-93C5-4B8F-B0E2-5F6C18D3A947}";
 
     // Interface TypeIds
     inline constexpr const char* CloudscapeComponentTypeId = "{2B9B1A59-B803-4150-9AAD-784427250678}";
@@ -39,6 +41,10 @@ namespace VolumetricClouds
 
     inline constexpr const char* CloudMaterialPropertiesTypeId = "{515030BE-B95D-4A3D-87F4-F5249AF086AB}";
     inline constexpr const char* CloudscapeShaderConstantDataTypeId = "{9940E82C-AD4D-418E-B98C-FDB89FFE4BA5}";
+    inline constexpr const char* CloudscapeRenderSettingsTypeId = "{4C7A1E0B-3D52-4F8E-A6B9-2E5C8D17F940}";
+    inline constexpr const char* CloudParameterTrackTypeId = "{E5B7C924-1A3D-4F60-8B2E-97D04A6C1F58}";
+    inline constexpr const char* AnimatedCloudParameterTypeId = "{8D3F2A61-5C7B-4E09-9A1E-6B42C0F9D735}";
+    inline constexpr const char* VolumetricCloudsStatsCollectorTypeId = "{A2F47D18-6C3B-4E95-8B0A-71D5E9C2F346}";
 
 
     // Interface TypeIds
@@ -5,4 +5,6 @@
 #      ../Include/Android/VolumetricCloudsAndroid.h
 
 set(FILES
+    VolumetricClouds_Traits_Platform.h
+    VolumetricClouds_Traits_android.h
 )
@@ -0,0 +1,12 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+// When 1, CloudscapeComputePass uses the half precision (min16float) variant of the
+// cloudscape ray marching shader.
+// Desktop GPUs keep the full precision ray march by default.
+#define AZ_TRAIT_VOLUMETRICCLOUDS_USE_HALF_PRECISION_RAYMARCH 0
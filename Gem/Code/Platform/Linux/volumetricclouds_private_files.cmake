@@ -5,4 +5,6 @@
 #      ../Include/Linux/VolumetricCloudsLinux.h
 
 set(FILES
+    VolumetricClouds_Traits_Platform.h
+    VolumetricClouds_Traits_linux.h
 )
@@ -5,4 +5,6 @@
 #      ../Include/Mac/VolumetricCloudsMac.h
 
 set(FILES
+    VolumetricClouds_Traits_Platform.h
+    VolumetricClouds_Traits_mac.h
 )
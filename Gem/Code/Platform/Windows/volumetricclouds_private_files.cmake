@@ -5,4 +5,6 @@
 #      ../Include/Windows/VolumetricCloudsWindows.h
 
 set(FILES
+    VolumetricClouds_Traits_Platform.h
+    VolumetricClouds_Traits_windows.h
 )
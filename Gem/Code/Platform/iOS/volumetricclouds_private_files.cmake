@@ -5,4 +5,6 @@
 #      ../Include/iOS/VolumetricCloudsiOS.h
 
 set(FILES
+    VolumetricClouds_Traits_Platform.h
+    VolumetricClouds_Traits_ios.h
 )
@@ -7,6 +7,7 @@
 
 #include <AzCore/Asset/AssetSerializer.h>
 #include <AzCore/Serialization/SerializeContext.h>
+#include <AzCore/std/sort.h>
 
 #include <Atom/RPI.Public/Scene.h>
 #include <Atom/RPI.Public/RPIUtils.h>
@@ -14,6 +15,7 @@
 #include <Atom/RPI.Public/ViewportContext.h>
 
 #include <Renderer/CloudscapeFeatureProcessor.h>
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 #include "CloudscapeComponentController.h"
 
 namespace VolumetricClouds
@@ -21,6 +23,8 @@ namespace VolumetricClouds
         void CloudscapeComponentConfig::Reflect(AZ::ReflectContext* context)
         {
             CloudscapeShaderConstantData::Reflect(context);
+            CloudscapeRenderSettings::Reflect(context);
+            CloudParameterTrack::Reflect(context);
 
             if (auto serializeContext = azrtti_cast<AZ::SerializeContext*>(context))
             {
@@ -31,6 +35,8 @@ namespace VolumetricClouds
                     ->Field("SunEntity", &CloudscapeComponentConfig::m_sunEntity)
                     ->Field("WeatherMap", &CloudscapeComponentConfig::m_weatherMap)
                     ->Field("ShaderConstantData", &CloudscapeComponentConfig::m_shaderConstantData)
+                    ->Field("RenderSettings", &CloudscapeComponentConfig::m_renderSettings)
+                    ->Field("ParameterTracks", &CloudscapeComponentConfig::m_parameterTracks)
                     ;
 
                 if (auto editContext = serializeContext->GetEditContext())
@@ -45,6 +51,9 @@ namespace VolumetricClouds
                         ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeComponentConfig::m_weatherMap, "Weather Map", "4-channels weather map data.")
                         ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeComponentConfig::m_sunEntity, "Sun Entity", "An entity with a Directional Light Component, representing the Sun. Defines sun light direction and color.")
                         ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeComponentConfig::m_shaderConstantData, "Shader Constants", "")
+                        ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeComponentConfig::m_renderSettings, "Render Settings", "")
+                        ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeComponentConfig::m_parameterTracks, "Parameter Animations",
+                            "Curves played on the cloud parameters when the component is activated.")
                         ;
                 }
             }
@@ -58,6 +67,7 @@ namespace VolumetricClouds
             {
                 // Register all the tuple types used below so that they marshal to/from python and Lua correctly.
                 serializeContext->RegisterGenericType<AZStd::tuple<uint8_t, uint8_t>>();
+                serializeContext->RegisterGenericType<AZStd::vector<AZ::Vector2>>();
 
                 serializeContext->Class<CloudscapeComponentController>()
                     ->Version(1)
@@ -80,6 +90,17 @@ namespace VolumetricClouds
             AZ::BehaviorContext* behaviorContext = azrtti_cast<AZ::BehaviorContext*>(context);
             if (behaviorContext)
             {
+                behaviorContext->EnumProperty<static_cast<int>(AnimatedCloudParameter::CloudCoverage)>("AnimatedCloudParameter_CloudCoverage")
+                    ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName);
+                behaviorContext->EnumProperty<static_cast<int>(AnimatedCloudParameter::CloudDensity)>("AnimatedCloudParameter_CloudDensity")
+                    ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName);
+                behaviorContext->EnumProperty<static_cast<int>(AnimatedCloudParameter::WindSpeedKmPerSec)>("AnimatedCloudParameter_WindSpeedKmPerSec")
+                    ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName);
+                behaviorContext->EnumProperty<static_cast<int>(AnimatedCloudParameter::CloudTopShiftKm)>("AnimatedCloudParameter_CloudTopShiftKm")
+                    ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName);
+                behaviorContext->EnumProperty<static_cast<int>(AnimatedCloudParameter::SunLightIntensity)>("AnimatedCloudParameter_SunLightIntensity")
+                    ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName);
+
                 behaviorContext->EBus<VolumetricCloudsRequestBus>("VolumetricCloudsRequestBus")
                     ->Attribute(AZ::Script::Attributes::Scope, AZ::Script::Attributes::ScopeFlags::Common)
                     ->Attribute(AZ::Script::Attributes::Module, ScriptingModuleName)
@@ -107,8 +128,6 @@ namespace VolumetricClouds
                     ->Event("SetCloudSlabThicknessKm", &VolumetricCloudsRequestBus::Events::SetCloudSlabThicknessKm)
                     ->Event("GetSunLightColorAndIntensity", &VolumetricCloudsRequestBus::Events::GetSunLightColorAndIntensity)
                     ->Event("SetSunLightColorAndIntensity", &VolumetricCloudsRequestBus::Events::SetSunLightColorAndIntensity)
-                    ->Event("GetAmbientLightColorAndIntensity", &VolumetricCloudsRequestBus::Events::GetAmbientLightColorAndIntensity)
-                    ->Event("SetAmbientLightColorAndIntensity", &VolumetricCloudsRequestBus::Events::SetAmbientLightColorAndIntensity)
                     // Weather data
                     ->Event("GetWeatherMapSizeKm", &VolumetricCloudsRequestBus::Events::GetWeatherMapSizeKm)
                     ->Event("SetWeatherMapSizeKm", &VolumetricCloudsRequestBus::Events::SetWeatherMapSizeKm)
@@ -123,6 +142,14 @@ namespace VolumetricClouds
                     // Cloud Material Properties
                     ->Event("GetCloudMaterialProperties", &VolumetricCloudsRequestBus::Events::GetCloudMaterialProperties)
                     ->Event("SetCloudMaterialProperties", &VolumetricCloudsRequestBus::Events::SetCloudMaterialProperties)
+                    // Animation
+                    // From Lua
+                    // local keyframes = vector_Vector2()
+                    // keyframes:push_back(Vector2(0.0, 0.2))
+                    // keyframes:push_back(Vector2(1.0, 0.9))
+                    // VolumetricCloudsRequestBus.Broadcast.AnimateParameter(AnimatedCloudParameter_CloudCoverage, keyframes, 30.0)
+                    ->Event("AnimateParameter", &VolumetricCloudsRequestBus::Events::AnimateParameter)
+                    ->Event("StopParameterAnimation", &VolumetricCloudsRequestBus::Events::StopParameterAnimation)
                     ;
             }
         }
@@ -193,13 +220,11 @@ namespace VolumetricClouds
                 m_configuration.m_weatherMap.QueueLoad();
             }
 
+            RestartConfigurationParameterTracks();
+
             m_prevConfiguration = m_configuration;
             EnableFeatureProcessor();
-
-            auto viewportContextInterface = AZ::Interface<AZ::RPI::ViewportContextRequestsInterface>::Get();
-            auto viewportContext = viewportContextInterface->GetViewportContextByScene(m_scene);
-            AZ::RPI::ViewportContextIdNotificationBus::Handler::BusConnect(viewportContext->GetId());
-
+            SubmitParameterTracks();
         }
 
         void CloudscapeComponentController::Deactivate()
@@ -210,7 +235,6 @@ namespace VolumetricClouds
             }
 
             VolumetricCloudsRequestBus::Handler::BusDisconnect();
-            AZ::RPI::ViewportContextIdNotificationBus::Handler::BusDisconnect();
             m_directionalLightConfigChangedEventHandler.Disconnect();
             AZ::TransformNotificationBus::Handler::BusDisconnect();
             AZ::Data::AssetBus::Handler::BusDisconnect();
@@ -329,6 +353,17 @@ namespace VolumetricClouds
                     SubmitShaderConstantData();
                 }
 
+                if (m_prevConfiguration.m_parameterTracks != m_configuration.m_parameterTracks)
+                {
+                    RestartConfigurationParameterTracks();
+                    SubmitParameterTracks();
+                }
+
+                if (m_prevConfiguration.m_renderSettings != m_configuration.m_renderSettings)
+                {
+                    m_cloudscapeFeatureProcessor->UpdateRenderSettings(m_configuration.m_renderSettings);
+                }
+
             }
 
             m_prevConfiguration = m_configuration;
@@ -343,6 +378,7 @@ namespace VolumetricClouds
 
             AZ_Assert(!!m_cloudscapeFeatureProcessor, "Failed to enable CloudscapeFeatureProcessor");
             //m_cloudscapeFeatureProcessor->UpdateColor(m_configuration.m_color);
+            m_cloudscapeFeatureProcessor->UpdateRenderSettings(m_configuration.m_renderSettings);
         }
 
         void CloudscapeComponentController::SubmitShaderConstantData()
@@ -353,12 +389,51 @@ namespace VolumetricClouds
             }
             if (m_cloudscapeFeatureProcessor)
             {
+                ScopedCpuStatsTimer statsTimer(StatsScope::SubmitShaderConstantDataCpu);
                 const uint32_t imageMipLevels = m_configuration.m_shaderConstantData.m_lowFrequencyNoiseTexture
                     ? m_configuration.m_shaderConstantData.m_lowFrequencyNoiseTexture->GetDescriptor().m_mipLevels
                     : 1;
                 uint32_t maxMipLevels = AZStd::min(imageMipLevels, m_configuration.m_shaderConstantData.m_maxMipLevels);
                 m_configuration.m_shaderConstantData.m_clampedMipLevels = AZStd::max(1u, maxMipLevels);
-                m_cloudscapeFeatureProcessor->UpdateShaderConstantData(m_configuration.m_shaderConstantData);
+                m_cloudscapeFeatureProcessor->StageShaderConstantData(m_configuration.m_shaderConstantData);
+            }
+        }
+
+        void CloudscapeComponentController::SubmitParameterTracks()
+        {
+            if (m_isBatchingShaderConstantChanges)
+            {
+                return;
+            }
+            if (m_cloudscapeFeatureProcessor)
+            {
+                m_cloudscapeFeatureProcessor->StageParameterTracks(m_activeParameterTracks);
+            }
+        }
+
+        void CloudscapeComponentController::RestartConfigurationParameterTracks()
+        {
+            m_activeParameterTracks = m_configuration.m_parameterTracks;
+            for (auto& track : m_activeParameterTracks)
+            {
+                RestartParameterTrack(track);
+            }
+        }
+
+        void CloudscapeComponentController::RestartParameterTrack(CloudParameterTrack& track)
+        {
+            AZStd::sort(track.m_keyframes.begin(), track.m_keyframes.end(),
+                [](const AZ::Vector2& lhs, const AZ::Vector2& rhs) { return lhs.GetX() < rhs.GetX(); });
+            track.m_id = m_nextParameterTrackId++;
+        }
+
+        void CloudscapeComponentController::CancelParameterAnimation(AnimatedCloudParameter parameter)
+        {
+            const size_t erasedCount = AZStd::erase_if(m_activeParameterTracks,
+                [parameter](const CloudParameterTrack& track) { return track.m_parameter == parameter; });
+            if (erasedCount > 0)
+            {
+                SubmitParameterTracks();
             }
         }
 
@@ -394,7 +469,7 @@ namespace VolumetricClouds
                     if (m_cloudscapeFeatureProcessor)
                     {
                         m_configuration.m_shaderConstantData.m_weatherMap = AZ::RPI::StreamingImage::FindOrCreate(m_configuration.m_weatherMap);
-                        m_cloudscapeFeatureProcessor->UpdateShaderConstantData(m_configuration.m_shaderConstantData);
+                        m_cloudscapeFeatureProcessor->StageShaderConstantData(m_configuration.m_shaderConstantData);
                     }
                 };
                 AZ::TickBus::QueueFunction(AZStd::move(updateTexture));
@@ -435,7 +510,7 @@ namespace VolumetricClouds
             m_configuration.m_shaderConstantData.m_directionTowardsTheSun = -worldTM.GetBasisY();
             if (m_cloudscapeFeatureProcessor)
             {
-                m_cloudscapeFeatureProcessor->UpdateShaderConstantData(m_configuration.m_shaderConstantData);
+                m_cloudscapeFeatureProcessor->StageShaderConstantData(m_configuration.m_shaderConstantData);
             }
         }
         ////////////////////////////////////////////////////////////////////
@@ -464,32 +539,10 @@ namespace VolumetricClouds
             m_configuration.m_shaderConstantData.m_sunColor = newColor;
             if (m_cloudscapeFeatureProcessor)
             {
-                m_cloudscapeFeatureProcessor->UpdateShaderConstantData(m_configuration.m_shaderConstantData);
+                m_cloudscapeFeatureProcessor->StageShaderConstantData(m_configuration.m_shaderConstantData);
             }
         }
 
-        //! RPI::ViewportContextIdNotificationBus
-        void CloudscapeComponentController::OnViewportSizeChanged([[maybe_unused]] AzFramework::WindowSize size)
-        {
-            // The feature processor owns two image attachments that are used
-            // by the passes it owns. Their sizes must be of the size of the viewport.
-            // Once attachments are defined for a pass they can not be modified (making those changes
-            // is not supported by the APIs at the moment). So we have to reschedule the destruction of this feature processor
-            // and recreate this feature processor which in turns will recreate and add the passes
-            // to the render pipeline.
-            m_scene->DisableFeatureProcessor<CloudscapeFeatureProcessor>();
-            m_cloudscapeFeatureProcessor = nullptr;
-
-            // Recreate the feature processor on the next tick.
-            auto recreateFeatureProcessorFunc = [this]()
-            {
-                EnableFeatureProcessor();
-                SubmitShaderConstantData();
-            };
-            AZ::TickBus::QueueFunction(AZStd::move(recreateFeatureProcessorFunc));
-
-        }
-
         /////////////////////////////////////////////////////////
         // VolumetricCloudsRequestBus::Handler overrides START
         void CloudscapeComponentController::BeginCallBatch()
@@ -581,23 +634,10 @@ namespace VolumetricClouds
         {
             m_configuration.m_shaderConstantData.m_sunColor = rgbColorAlphaIntensity.GetAsVector3();
             m_configuration.m_shaderConstantData.m_sunLightIntensity = rgbColorAlphaIntensity.GetA();
+            CancelParameterAnimation(AnimatedCloudParameter::SunLightIntensity);
             SubmitShaderConstantData();
         }
         
-        AZ::Color CloudscapeComponentController::GetAmbientLightColorAndIntensity()
-        {
-            AZ::Color color = m_configuration.m_shaderConstantData.m_ambientLightColor;
-            color.SetA(m_configuration.m_shaderConstantData.m_ambientLightIntensity);
-            return color;
-        }
-        
-        void CloudscapeComponentController::SetAmbientLightColorAndIntensity(const AZ::Color& rgbColorAlphaIntensity)
-        {
-            m_configuration.m_shaderConstantData.m_ambientLightColor = rgbColorAlphaIntensity;
-            m_configuration.m_shaderConstantData.m_ambientLightIntensity = rgbColorAlphaIntensity.GetA();
-            SubmitShaderConstantData();
-        }
-
         float CloudscapeComponentController::GetWeatherMapSizeKm()
         {
             return m_configuration.m_shaderConstantData.m_weatherMapSizeKm;
@@ -618,6 +658,7 @@ namespace VolumetricClouds
         void CloudscapeComponentController::SetCloudCoverage(float coverage)
         {
             m_configuration.m_shaderConstantData.m_globalCloudCoverage = coverage;
+            CancelParameterAnimation(AnimatedCloudParameter::CloudCoverage);
             SubmitShaderConstantData();
         }
 
@@ -629,6 +670,7 @@ namespace VolumetricClouds
         void CloudscapeComponentController::SetCloudDensity(float density)
         {
             m_configuration.m_shaderConstantData.m_globalCloudDensity = density;
+            CancelParameterAnimation(AnimatedCloudParameter::CloudDensity);
             SubmitShaderConstantData();
         }
 
@@ -644,6 +686,7 @@ namespace VolumetricClouds
             const float speed = velocity.GetLength();
             m_configuration.m_shaderConstantData.m_windSpeedKmPerSec = speed;
             m_configuration.m_shaderConstantData.m_windDirection = AZ::IsClose(speed, 0.0f) ? AZ::Vector3::CreateAxisX() : velocity / speed;
+            CancelParameterAnimation(AnimatedCloudParameter::WindSpeedKmPerSec);
             SubmitShaderConstantData();
         }
 
@@ -655,6 +698,7 @@ namespace VolumetricClouds
         void CloudscapeComponentController::SetCloudTopShiftKm(float topShiftKm)
         {
             m_configuration.m_shaderConstantData.m_cloudTopOffsetKm = topShiftKm;
+            CancelParameterAnimation(AnimatedCloudParameter::CloudTopShiftKm);
             SubmitShaderConstantData();
         }
 
@@ -669,6 +713,33 @@ namespace VolumetricClouds
             SubmitShaderConstantData();
         }
 
+        void CloudscapeComponentController::AnimateParameter(AnimatedCloudParameter parameter, const AZStd::vector<AZ::Vector2>& keyframes, float durationSeconds)
+        {
+            if (parameter >= AnimatedCloudParameter::Count)
+            {
+                AZ_Warning(LogName, false, "AnimateParameter(): Invalid parameter %u", static_cast<uint32_t>(parameter));
+                return;
+            }
+            if (keyframes.empty())
+            {
+                AZ_Warning(LogName, false, "AnimateParameter(): At least one keyframe is required");
+                return;
+            }
+            AZStd::erase_if(m_activeParameterTracks,
+                [parameter](const CloudParameterTrack& track) { return track.m_parameter == parameter; });
+            CloudParameterTrack& track = m_activeParameterTracks.emplace_back();
+            track.m_parameter = parameter;
+            track.m_keyframes = keyframes;
+            track.m_durationSeconds = AZStd::max(durationSeconds, 0.0f);
+            RestartParameterTrack(track);
+            SubmitParameterTracks();
+        }
+
+        void CloudscapeComponentController::StopParameterAnimation(AnimatedCloudParameter parameter)
+        {
+            CancelParameterAnimation(parameter);
+        }
+
         void CloudscapeComponentController::EndCallBatch()
         {
             if (!m_isBatchingShaderConstantChanges)
@@ -678,6 +749,7 @@ namespace VolumetricClouds
             }
             m_isBatchingShaderConstantChanges = false;
             SubmitShaderConstantData();
+            SubmitParameterTracks();
         }
         // VolumetricCloudsRequestBus::Handler overrides END
         /////////////////////////////////////////////////////////
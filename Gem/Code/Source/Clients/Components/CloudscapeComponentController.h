@@ -10,13 +10,14 @@
 #include <AzCore/Component/Component.h>
 #include <AzCore/Component/TransformBus.h>
 
-#include <Atom/RPI.Public/ViewportContextBus.h>
 #include <Atom/RPI.Reflect/Image/StreamingImageAsset.h>
 #include <AtomLyIntegration/CommonFeatures/CoreLights/DirectionalLightBus.h>
 
 #include <VolumetricClouds/VolumetricCloudsBus.h>
 #include <VolumetricClouds/CloudTextureProviderBus.h>
 #include <Renderer/CloudscapeShaderConstantData.h>
+#include <Renderer/CloudscapeRenderSettings.h>
+#include <Renderer/CloudParameterAnimation.h>
 
 namespace AZ::RPI {
     class Scene;
@@ -49,6 +50,11 @@ namespace VolumetricClouds
         AZ::Data::Asset<AZ::RPI::StreamingImageAsset> m_weatherMap;
 
         CloudscapeShaderConstantData m_shaderConstantData;
+
+        CloudscapeRenderSettings m_renderSettings;
+
+        // Start playing when the component is activated. See VolumetricCloudsRequests::AnimateParameter().
+        AZStd::vector<CloudParameterTrack> m_parameterTracks;
     };
     
 
@@ -56,7 +62,6 @@ namespace VolumetricClouds
         : private CloudTextureProviderNotificationBus::MultiHandler
         , private AZ::Data::AssetBus::Handler
         , private AZ::TransformNotificationBus::Handler // To detect changes in Sun direction.
-        , private AZ::RPI::ViewportContextIdNotificationBus::Handler
         , public VolumetricCloudsRequestBus::Handler
     {
     public:
@@ -97,8 +102,6 @@ namespace VolumetricClouds
         void SetCloudSlabThicknessKm(float thicknessKm) override;
         AZ::Color GetSunLightColorAndIntensity() override;
         void SetSunLightColorAndIntensity(const AZ::Color& rgbColorAlphaIntensity) override;
-        AZ::Color GetAmbientLightColorAndIntensity() override;
-        void SetAmbientLightColorAndIntensity(const AZ::Color& rgbColorAlphaIntensity) override;
         // Weather Data
         float GetWeatherMapSizeKm() override;
         void SetWeatherMapSizeKm(float mapSizeKm) override;
@@ -113,6 +116,9 @@ namespace VolumetricClouds
         // Cloud Material Properties
         const CloudMaterialProperties& GetCloudMaterialProperties() override;
         void SetCloudMaterialProperties(const CloudMaterialProperties& cmp) override;
+        // Animation
+        void AnimateParameter(AnimatedCloudParameter parameter, const AZStd::vector<AZ::Vector2>& keyframes, float durationSeconds) override;
+        void StopParameterAnimation(AnimatedCloudParameter parameter) override;
 
         void EndCallBatch() override;
         // VolumetricCloudsRequestBus::Handler overrides END
@@ -130,9 +136,19 @@ namespace VolumetricClouds
 
         // A helper function that makes sure the shader constant data
         // make sense and are clamped within good boundaries before being sent to the
-        // feature processor.
+        // feature processor. The data is staged, and the feature processor publishes it
+        // to the passes in its next Simulate().
         void SubmitShaderConstantData();
 
+        // Sends @m_activeParameterTracks to the feature processor. Same rules as SubmitShaderConstantData().
+        void SubmitParameterTracks();
+        // Replaces @m_activeParameterTracks with @m_configuration.m_parameterTracks, played from the beginning.
+        void RestartConfigurationParameterTracks();
+        // Gives a new id to @track, so the feature processor plays it from the beginning.
+        void RestartParameterTrack(CloudParameterTrack& track);
+        // Called by the Set..() functions, so the set value is not overridden by the animation.
+        void CancelParameterAnimation(AnimatedCloudParameter parameter);
+
         //////////////////////////////////////////////////////////////////
         //! CloudTextureProviderNotificationBus overrides START...
         void OnCloudTextureImageReady(AZ::Data::Instance<AZ::RPI::Image> image) override;
@@ -150,9 +166,6 @@ namespace VolumetricClouds
         void OnTransformChanged(const AZ::Transform& /*local*/, const AZ::Transform& /*world*/) override;
         ////////////////////////////////////////////////////////////////////
 
-        //! RPI::ViewportContextIdNotificationBus
-        void OnViewportSizeChanged(AzFramework::WindowSize size) override;
-
         // This boolean was added so only one Volumetric Cloudscape component is active per level.
         bool m_isActive = false;
         
@@ -164,6 +177,11 @@ namespace VolumetricClouds
         AZ::EntityId m_entityId;
         CloudscapeComponentConfig m_configuration;
         CloudscapeComponentConfig m_prevConfiguration;
+        // The tracks being played. They start as a copy of @m_configuration.m_parameterTracks, and then
+        // AnimateParameter(), StopParameterAnimation() and the Set..() functions change them,
+        // so the animations requested at runtime are never saved with the configuration.
+        AZStd::vector<CloudParameterTrack> m_activeParameterTracks;
+        uint32_t m_nextParameterTrackId = 1;
 
         AZ::RPI::Scene* m_scene; //Cache a reference to the scene where @m_entityId exists.
         CloudscapeFeatureProcessor* m_cloudscapeFeatureProcessor = nullptr;
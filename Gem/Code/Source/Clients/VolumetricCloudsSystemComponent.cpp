@@ -14,6 +14,11 @@
 #include <Renderer/Passes/CloudTextureComputePass.h>
 #include <Renderer/Passes/CloudscapeComputePass.h>
 #include <Renderer/Passes/CloudscapeRasterPass.h>
+#include <Renderer/Passes/CloudscapeSkyViewComputePass.h>
+#include <Renderer/Passes/CloudscapeSunVisibilityComputePass.h>
+#include <Renderer/Passes/CloudscapeShadowMapComputePass.h>
+#include <Renderer/Passes/CloudscapeShadowMapBarrierPass.h>
+#include <Renderer/Passes/CloudscapeStereoReprojectionComputePass.h>
 #include <Renderer/CloudTexturesComputeFeatureProcessor.h>
 #include <Renderer/CloudTexturesDebugViewerFeatureProcessor.h>
 #include <Renderer/CloudscapeFeatureProcessor.h>
@@ -79,10 +84,17 @@ namespace VolumetricClouds
         passSystem->AddPassCreator(AZ::Name("CloudTextureComputePass"), &CloudTextureComputePass::Create);
         passSystem->AddPassCreator(AZ::Name("CloudscapeComputePass"), &CloudscapeComputePass::Create);
         passSystem->AddPassCreator(AZ::Name("CloudscapeRasterPass"), &CloudscapeRasterPass::Create);
+        passSystem->AddPassCreator(AZ::Name("CloudscapeSkyViewComputePass"), &CloudscapeSkyViewComputePass::Create);
+        passSystem->AddPassCreator(AZ::Name("CloudscapeSunVisibilityComputePass"), &CloudscapeSunVisibilityComputePass::Create);
+        passSystem->AddPassCreator(AZ::Name("CloudscapeShadowMapComputePass"), &CloudscapeShadowMapComputePass::Create);
+        passSystem->AddPassCreator(AZ::Name("CloudscapeShadowMapBarrierPass"), &CloudscapeShadowMapBarrierPass::Create);
+        passSystem->AddPassCreator(AZ::Name("CloudscapeStereoReprojectionComputePass"), &CloudscapeStereoReprojectionComputePass::Create);
 
         // Setup handler for load pass templates mappings
         m_loadTemplatesHandler = AZ::RPI::PassSystemInterface::OnReadyLoadTemplatesEvent::Handler([this]() { this->LoadPassTemplateMappings(); });
         passSystem->ConnectEvent(m_loadTemplatesHandler);
+
+        m_statsCollector = AZStd::make_unique<VolumetricCloudsStatsCollector>();
     }
 
     void VolumetricCloudsSystemComponent::LoadPassTemplateMappings()
@@ -96,6 +108,7 @@ namespace VolumetricClouds
 
     void VolumetricCloudsSystemComponent::Deactivate()
     {
+        m_statsCollector.reset();
         m_loadTemplatesHandler.Disconnect();
     }
 
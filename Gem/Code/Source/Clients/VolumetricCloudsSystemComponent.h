@@ -10,6 +10,8 @@
 
 #include <Atom/RPI.Public/Pass/PassSystemInterface.h>
 
+#include <Renderer/VolumetricCloudsStatsCollector.h>
+
 namespace VolumetricClouds
 {
     class VolumetricCloudsSystemComponent
@@ -41,6 +43,9 @@ namespace VolumetricClouds
 
         //! Used for loading the pass templates of the volumetric clouds gem.
         AZ::RPI::PassSystemInterface::OnReadyLoadTemplatesEvent::Handler m_loadTemplatesHandler;
+
+        //! Answers the VolumetricCloudsStatsRequestBus.
+        AZStd::unique_ptr<VolumetricCloudsStatsCollector> m_statsCollector;
     };
 
 } // namespace VolumetricClouds
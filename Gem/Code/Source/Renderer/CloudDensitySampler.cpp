@@ -0,0 +1,643 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/std/containers/array.h>
+
+#include <Atom/RPI.Public/Image/StreamingImage.h>
+#include <Atom/RPI.Reflect/Image/StreamingImageAsset.h>
+
+#include <Renderer/CloudscapeShaderConstantData.h>
+#include "CloudDensitySampler.h"
+
+namespace VolumetricClouds
+{
+    namespace
+    {
+        using Vec4 = AZ::Simd::Vec4;
+        using FloatType = Vec4::FloatType;
+
+        FloatType Saturate(FloatType value)
+        {
+            return Vec4::Min(Vec4::Max(value, Vec4::ZeroFloat()), Vec4::Splat(1.0f));
+        }
+
+        // Same as Remap() in CloudscapeCS.azsl.
+        FloatType Remap(FloatType value, FloatType oldMin, FloatType oldMax, FloatType newMin, FloatType newMax)
+        {
+            return Vec4::Madd(Vec4::Div(Vec4::Sub(value, oldMin), Vec4::Sub(oldMax, oldMin)), Vec4::Sub(newMax, newMin), newMin);
+        }
+
+        FloatType Remap(FloatType value, float oldMin, float oldMax, float newMin, float newMax)
+        {
+            return Remap(value, Vec4::Splat(oldMin), Vec4::Splat(oldMax), Vec4::Splat(newMin), Vec4::Splat(newMax));
+        }
+
+        FloatType Lerp(FloatType a, FloatType b, FloatType t)
+        {
+            return Vec4::Madd(Vec4::Sub(b, a), t, a);
+        }
+
+        uint32_t WrapTexelCoordinate(int32_t coordinate, uint32_t size)
+        {
+            const int32_t wrapped = coordinate % static_cast<int32_t>(size);
+            return static_cast<uint32_t>(wrapped < 0 ? wrapped + static_cast<int32_t>(size) : wrapped);
+        }
+
+        // Line of sight march, see CloudDensitySampler::SampleTransmittance().
+        // Size of the small steps inside clouds, as a fraction of the cloud slab thickness.
+        constexpr float FineStepsPerSlabThickness = 32.0f;
+        // The empty space is skipped with steps this many times larger.
+        constexpr float CoarseStepMultiplier = 4.0f;
+        // Long segments, e.g. close to the horizon, use larger steps instead of more steps.
+        constexpr float MaxFineStepsPerSegment = 256.0f;
+        // Same as RayMarchClouds(). Number of empty fine steps before going back to coarse steps.
+        constexpr uint32_t ZeroDensityStepsToEmptySpace = 6;
+        // exp(-7) < 0.001, nothing behind this is visible.
+        constexpr float MaxOpticalDepth = 7.0f;
+
+        // Distances along the segment, in km, inside the cloud slab.
+        struct SlabInterval
+        {
+            float m_startKm = 0.0f;
+            float m_endKm = 0.0f;
+        };
+
+        struct SegmentMarchState
+        {
+            AZ::Vector3 m_originKm = AZ::Vector3::CreateZero();
+            AZ::Vector3 m_direction = AZ::Vector3::CreateAxisZ();
+            // A straight segment can leave the slab through the inner sphere and enter it again.
+            SlabInterval m_intervals[2];
+            uint32_t m_intervalCount = 0;
+            uint32_t m_intervalIndex = 0;
+            float m_distanceKm = 0.0f;
+            float m_fineStepKm = 0.0f;
+            float m_sampleDistanceKm = 0.0f;
+            float m_sampleStepKm = 0.0f;
+            uint32_t m_zeroDensityStepCount = 0;
+            bool m_isEmptySpace = true;
+            float m_opticalDepth = 0.0f;
+
+            bool IsActive() const { return m_intervalIndex < m_intervalCount; }
+        };
+
+        // Returns false if the segment from @originKm along @direction, of length @lengthKm, misses the sphere.
+        // Done in double precision because the positions are relative to the planet center, and the squared
+        // distances lose too many digits in single precision.
+        bool IntersectSegmentWithSphere(const AZ::Vector3& originKm, const AZ::Vector3& direction, double lengthKm,
+            double sphereRadiusKm, SlabInterval& intervalOut)
+        {
+            const double ox = originKm.GetX();
+            const double oy = originKm.GetY();
+            const double oz = originKm.GetZ();
+            const double b = ox * direction.GetX() + oy * direction.GetY() + oz * direction.GetZ();
+            const double c = (ox * ox + oy * oy + oz * oz) - sphereRadiusKm * sphereRadiusKm;
+            const double discriminant = b * b - c;
+            if (discriminant <= 0.0)
+            {
+                return false;
+            }
+            const double sqrtDiscriminant = sqrt(discriminant);
+            const double start = AZStd::max(-b - sqrtDiscriminant, 0.0);
+            const double end = AZStd::min(-b + sqrtDiscriminant, lengthKm);
+            if (start >= end)
+            {
+                return false;
+            }
+            intervalOut.m_startKm = static_cast<float>(start);
+            intervalOut.m_endKm = static_cast<float>(end);
+            return true;
+        }
+
+        // The GPU converts sRGB texels to linear when sampling, so the CPU copy must do the same.
+        const AZStd::array<float, 256>& GetSrgbToLinearTable()
+        {
+            static const AZStd::array<float, 256> table = []()
+            {
+                AZStd::array<float, 256> values;
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    const float srgb = i / 255.0f;
+                    values[i] = (srgb <= 0.04045f) ? (srgb / 12.92f) : powf((srgb + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+            return table;
+        }
+
+        // Returns false for the formats that CloudCpuTexture can't read.
+        bool GetTexelLayout(AZ::RHI::Format format, bool& isBgraOut, bool& isSrgbOut)
+        {
+            switch (format)
+            {
+            case AZ::RHI::Format::R8G8B8A8_UNORM:
+                isBgraOut = false;
+                isSrgbOut = false;
+                return true;
+            case AZ::RHI::Format::R8G8B8A8_UNORM_SRGB:
+                isBgraOut = false;
+                isSrgbOut = true;
+                return true;
+            case AZ::RHI::Format::B8G8R8A8_UNORM:
+                isBgraOut = true;
+                isSrgbOut = false;
+                return true;
+            case AZ::RHI::Format::B8G8R8A8_UNORM_SRGB:
+                isBgraOut = true;
+                isSrgbOut = true;
+                return true;
+            default:
+                return false;
+            }
+        }
+    } // namespace
+
+    /////////////////////////////////////////////////////////////////////
+    // CloudCpuTexture
+    AZStd::shared_ptr<const CloudCpuTexture> CloudCpuTexture::CreateFromImage(const AZ::RPI::Image* image)
+    {
+        auto streamingImage = azrtti_cast<const AZ::RPI::StreamingImage*>(image);
+        if (!streamingImage || !streamingImage->GetAsset().IsReady())
+        {
+            return nullptr;
+        }
+
+        auto* imageAsset = streamingImage->GetAsset().Get();
+        const AZ::RHI::ImageDescriptor& descriptor = imageAsset->GetImageDescriptor();
+        bool isBgra = false;
+        bool isSrgb = false;
+        if (!GetTexelLayout(descriptor.m_format, isBgra, isSrgb))
+        {
+            return nullptr;
+        }
+
+        // The most detailed mips may not be streamed in.
+        for (uint32_t mip = 0; mip < descriptor.m_mipLevels; ++mip)
+        {
+            AZStd::span<const uint8_t> data = imageAsset->GetSubImageData(mip, 0);
+            if (data.empty())
+            {
+                continue;
+            }
+
+            auto cpuTexture = AZStd::make_shared<CloudCpuTexture>();
+            cpuTexture->m_width = AZStd::max(descriptor.m_size.m_width >> mip, 1u);
+            cpuTexture->m_height = AZStd::max(descriptor.m_size.m_height >> mip, 1u);
+            cpuTexture->m_depth = AZStd::max(descriptor.m_size.m_depth >> mip, 1u);
+            cpuTexture->m_bytesPerRow = aznumeric_cast<uint32_t>(data.size() / (cpuTexture->m_height * cpuTexture->m_depth));
+            cpuTexture->m_bytesPerSlice = cpuTexture->m_bytesPerRow * cpuTexture->m_height;
+            if (cpuTexture->m_bytesPerRow < cpuTexture->m_width * 4)
+            {
+                return nullptr;
+            }
+            cpuTexture->m_isBgra = isBgra;
+            cpuTexture->m_texels.assign(data.begin(), data.end());
+            if (isSrgb)
+            {
+                // Alpha is always linear.
+                const auto& srgbToLinear = GetSrgbToLinearTable();
+                for (size_t i = 0; i < cpuTexture->m_texels.size(); i += 4)
+                {
+                    for (size_t channel = 0; channel < 3; ++channel)
+                    {
+                        uint8_t& texel = cpuTexture->m_texels[i + channel];
+                        texel = static_cast<uint8_t>(srgbToLinear[texel] * 255.0f + 0.5f);
+                    }
+                }
+            }
+            return cpuTexture;
+        }
+        return nullptr;
+    }
+
+    bool CloudCpuTexture::CanBeCreatedFromImage(const AZ::RPI::Image* image)
+    {
+        auto streamingImage = azrtti_cast<const AZ::RPI::StreamingImage*>(image);
+        if (!streamingImage)
+        {
+            return false;
+        }
+        if (!streamingImage->GetAsset().IsReady())
+        {
+            return true;
+        }
+        bool isBgra = false;
+        bool isSrgb = false;
+        return GetTexelLayout(streamingImage->GetAsset()->GetImageDescriptor().m_format, isBgra, isSrgb);
+    }
+
+    void CloudCpuTexture::LoadTexel(uint32_t x, uint32_t y, uint32_t z, float rgbaOut[4]) const
+    {
+        const uint8_t* texel = m_texels.data() + (z * m_bytesPerSlice) + (y * m_bytesPerRow) + (x * 4);
+        constexpr float Normalize = 1.0f / 255.0f;
+        rgbaOut[0] = texel[m_isBgra ? 2 : 0] * Normalize;
+        rgbaOut[1] = texel[1] * Normalize;
+        rgbaOut[2] = texel[m_isBgra ? 0 : 2] * Normalize;
+        rgbaOut[3] = texel[3] * Normalize;
+    }
+
+    void CloudCpuTexture::SampleBilinear(float u, float v, float rgbaOut[4]) const
+    {
+        const float x = u * m_width - 0.5f;
+        const float y = v * m_height - 0.5f;
+        const float x0 = floorf(x);
+        const float y0 = floorf(y);
+        const float fx = x - x0;
+        const float fy = y - y0;
+        const uint32_t ix0 = WrapTexelCoordinate(static_cast<int32_t>(x0), m_width);
+        const uint32_t iy0 = WrapTexelCoordinate(static_cast<int32_t>(y0), m_height);
+        const uint32_t ix1 = (ix0 + 1) % m_width;
+        const uint32_t iy1 = (iy0 + 1) % m_height;
+
+        float t00[4], t10[4], t01[4], t11[4];
+        LoadTexel(ix0, iy0, 0, t00);
+        LoadTexel(ix1, iy0, 0, t10);
+        LoadTexel(ix0, iy1, 0, t01);
+        LoadTexel(ix1, iy1, 0, t11);
+        for (uint32_t channel = 0; channel < 4; ++channel)
+        {
+            const float top = AZ::Lerp(t00[channel], t10[channel], fx);
+            const float bottom = AZ::Lerp(t01[channel], t11[channel], fx);
+            rgbaOut[channel] = AZ::Lerp(top, bottom, fy);
+        }
+    }
+
+    void CloudCpuTexture::SampleTrilinear(float u, float v, float w, float rgbaOut[4]) const
+    {
+        const float x = u * m_width - 0.5f;
+        const float y = v * m_height - 0.5f;
+        const float z = w * m_depth - 0.5f;
+        const float x0 = floorf(x);
+        const float y0 = floorf(y);
+        const float z0 = floorf(z);
+        const float fx = x - x0;
+        const float fy = y - y0;
+        const float fz = z - z0;
+        const uint32_t ix0 = WrapTexelCoordinate(static_cast<int32_t>(x0), m_width);
+        const uint32_t iy0 = WrapTexelCoordinate(static_cast<int32_t>(y0), m_height);
+        const uint32_t iz0 = WrapTexelCoordinate(static_cast<int32_t>(z0), m_depth);
+        const uint32_t ix1 = (ix0 + 1) % m_width;
+        const uint32_t iy1 = (iy0 + 1) % m_height;
+        const uint32_t iz1 = (iz0 + 1) % m_depth;
+
+        float t000[4], t100[4], t010[4], t110[4], t001[4], t101[4], t011[4], t111[4];
+        LoadTexel(ix0, iy0, iz0, t000);
+        LoadTexel(ix1, iy0, iz0, t100);
+        LoadTexel(ix0, iy1, iz0, t010);
+        LoadTexel(ix1, iy1, iz0, t110);
+        LoadTexel(ix0, iy0, iz1, t001);
+        LoadTexel(ix1, iy0, iz1, t101);
+        LoadTexel(ix0, iy1, iz1, t011);
+        LoadTexel(ix1, iy1, iz1, t111);
+        for (uint32_t channel = 0; channel < 4; ++channel)
+        {
+            const float front = AZ::Lerp(AZ::Lerp(t000[channel], t100[channel], fx), AZ::Lerp(t010[channel], t110[channel], fx), fy);
+            const float back = AZ::Lerp(AZ::Lerp(t001[channel], t101[channel], fx), AZ::Lerp(t011[channel], t111[channel], fx), fy);
+            rgbaOut[channel] = AZ::Lerp(front, back, fz);
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // CloudDensitySampler
+    CloudDensitySampler::CloudDensitySampler(const CloudscapeShaderConstantData& shaderData,
+        AZStd::shared_ptr<const CloudCpuTexture> lowFrequencyNoise,
+        AZStd::shared_ptr<const CloudCpuTexture> highFrequencyNoise,
+        AZStd::shared_ptr<const CloudCpuTexture> weatherMap)
+        : m_lowFrequencyNoise(AZStd::move(lowFrequencyNoise))
+        , m_highFrequencyNoise(AZStd::move(highFrequencyNoise))
+        , m_weatherMap(AZStd::move(weatherMap))
+    {
+        m_planetRadiusKm = shaderData.m_planetRadiusKm;
+        m_innerSphereRadiusKm = shaderData.m_planetRadiusKm + shaderData.m_cloudSlabDistanceAboveSeaLevelKm;
+        m_outerSphereRadiusKm = m_innerSphereRadiusKm + shaderData.m_cloudSlabThicknessKm;
+        m_uvwScale = shaderData.m_uvwScale;
+        m_weatherMapSizeKm = shaderData.m_weatherMapSizeKm;
+        m_globalCloudCoverage = shaderData.m_globalCloudCoverage;
+        m_globalCloudDensity = shaderData.m_globalCloudDensity;
+        m_windDirection = shaderData.GetNormalizedWindDirection();
+        m_cloudTopOffsetKm = shaderData.m_cloudTopOffsetKm;
+        m_extinctionCoefficientPerKm = AZStd::max((shaderData.m_cloudMaterialProperties.m_absorptionCoefficient +
+            shaderData.m_cloudMaterialProperties.m_scatteringCoefficient) * 1000.0f, 0.0001f);
+    }
+
+    bool CloudDensitySampler::AreInputsEqual(const CloudscapeShaderConstantData& lhs, const CloudscapeShaderConstantData& rhs)
+    {
+        return (lhs.m_planetRadiusKm == rhs.m_planetRadiusKm) &&
+               (lhs.m_cloudSlabDistanceAboveSeaLevelKm == rhs.m_cloudSlabDistanceAboveSeaLevelKm) &&
+               (lhs.m_cloudSlabThicknessKm == rhs.m_cloudSlabThicknessKm) &&
+               (lhs.m_uvwScale == rhs.m_uvwScale) &&
+               (lhs.m_weatherMapSizeKm == rhs.m_weatherMapSizeKm) &&
+               (lhs.m_globalCloudCoverage == rhs.m_globalCloudCoverage) &&
+               (lhs.m_globalCloudDensity == rhs.m_globalCloudDensity) &&
+               (lhs.m_windDirection == rhs.m_windDirection) &&
+               (lhs.m_cloudTopOffsetKm == rhs.m_cloudTopOffsetKm) &&
+               (lhs.m_cloudMaterialProperties.m_absorptionCoefficient == rhs.m_cloudMaterialProperties.m_absorptionCoefficient) &&
+               (lhs.m_cloudMaterialProperties.m_scatteringCoefficient == rhs.m_cloudMaterialProperties.m_scatteringCoefficient)
+               ;
+    }
+
+    bool CloudDensitySampler::IsReady() const
+    {
+        return m_lowFrequencyNoise && m_highFrequencyNoise && m_weatherMap;
+    }
+
+    void CloudDensitySampler::SampleDensity(AZStd::span<const AZ::Vector3> worldPositions, AZStd::span<float> densities,
+        const AZ::Vector3& windOffsetKm) const
+    {
+        AZ_Assert(worldPositions.size() == densities.size(), "The number of positions and densities must match");
+        const size_t pointCount = AZStd::min(worldPositions.size(), densities.size());
+        for (size_t firstPoint = 0; firstPoint < pointCount; firstPoint += 4)
+        {
+            // The last group is padded by repeating its last point.
+            alignas(16) float posX[4];
+            alignas(16) float posY[4];
+            alignas(16) float posZ[4];
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                // Same as GetCameraPositionKm() in CloudscapeCommon.azsli.
+                const AZ::Vector3& worldPosition = worldPositions[AZStd::min(firstPoint + lane, pointCount - 1)];
+                posX[lane] = worldPosition.GetX() * 0.001f;
+                posY[lane] = worldPosition.GetY() * 0.001f;
+                posZ[lane] = worldPosition.GetZ() * 0.001f + m_planetRadiusKm;
+            }
+
+            alignas(16) float density[4];
+            Vec4::StoreAligned(density, SampleDensityKm(Vec4::LoadAligned(posX), Vec4::LoadAligned(posY), Vec4::LoadAligned(posZ), windOffsetKm, AllLanesMask));
+            const size_t laneCount = AZStd::min<size_t>(4, pointCount - firstPoint);
+            for (size_t lane = 0; lane < laneCount; ++lane)
+            {
+                densities[firstPoint + lane] = density[lane];
+            }
+        }
+    }
+
+    void CloudDensitySampler::SampleTransmittance(AZStd::span<const AZ::Vector3> segmentStarts, AZStd::span<const AZ::Vector3> segmentEnds,
+        AZStd::span<CloudTransmittanceResult> results, const AZ::Vector3& windOffsetKm) const
+    {
+        AZ_Assert((segmentStarts.size() == segmentEnds.size()) && (segmentStarts.size() == results.size()),
+            "The number of segment starts, segment ends and results must match");
+        const size_t segmentCount = AZStd::min(AZStd::min(segmentStarts.size(), segmentEnds.size()), results.size());
+        const float minFineStepKm = AZStd::max((m_outerSphereRadiusKm - m_innerSphereRadiusKm) / FineStepsPerSlabThickness, 0.001f);
+        for (size_t firstSegment = 0; firstSegment < segmentCount; firstSegment += 4)
+        {
+            const size_t laneCount = AZStd::min<size_t>(4, segmentCount - firstSegment);
+            SegmentMarchState lanes[4];
+            for (size_t lane = 0; lane < laneCount; ++lane)
+            {
+                // Same as GetCameraPositionKm() in CloudscapeCommon.azsli.
+                SegmentMarchState& state = lanes[lane];
+                const AZ::Vector3& start = segmentStarts[firstSegment + lane];
+                const AZ::Vector3& end = segmentEnds[firstSegment + lane];
+                state.m_originKm = AZ::Vector3(start.GetX() * 0.001f, start.GetY() * 0.001f, start.GetZ() * 0.001f + m_planetRadiusKm);
+                const AZ::Vector3 segmentKm = (end - start) * 0.001f;
+                const float lengthKm = segmentKm.GetLength();
+                if (lengthKm <= 0.0f)
+                {
+                    continue;
+                }
+                state.m_direction = segmentKm / lengthKm;
+
+                // The part of the segment inside the outer sphere minus the part inside the inner sphere.
+                SlabInterval outer;
+                if (!IntersectSegmentWithSphere(state.m_originKm, state.m_direction, lengthKm, m_outerSphereRadiusKm, outer))
+                {
+                    continue;
+                }
+                SlabInterval inner;
+                if (!IntersectSegmentWithSphere(state.m_originKm, state.m_direction, lengthKm, m_innerSphereRadiusKm, inner) ||
+                    (inner.m_endKm <= outer.m_startKm) || (inner.m_startKm >= outer.m_endKm))
+                {
+                    state.m_intervals[state.m_intervalCount++] = outer;
+                }
+                else
+                {
+                    if (inner.m_startKm > outer.m_startKm)
+                    {
+                        state.m_intervals[state.m_intervalCount++] = { outer.m_startKm, inner.m_startKm };
+                    }
+                    if (outer.m_endKm > inner.m_endKm)
+                    {
+                        state.m_intervals[state.m_intervalCount++] = { inner.m_endKm, outer.m_endKm };
+                    }
+                }
+
+                float slabLengthKm = 0.0f;
+                for (uint32_t intervalIndex = 0; intervalIndex < state.m_intervalCount; ++intervalIndex)
+                {
+                    slabLengthKm += state.m_intervals[intervalIndex].m_endKm - state.m_intervals[intervalIndex].m_startKm;
+                }
+                state.m_fineStepKm = AZStd::max(minFineStepKm, slabLengthKm / MaxFineStepsPerSegment);
+                state.m_distanceKm = (state.m_intervalCount > 0) ? state.m_intervals[0].m_startKm : 0.0f;
+            }
+
+            // All the lanes take one step per iteration, and the group is done when all of them are done.
+            // The lanes that are already done sample their origin, and the result is discarded.
+            while (lanes[0].IsActive() || lanes[1].IsActive() || lanes[2].IsActive() || lanes[3].IsActive())
+            {
+                alignas(16) float posX[4];
+                alignas(16) float posY[4];
+                alignas(16) float posZ[4];
+                uint32_t fineStepLaneMask = 0;
+                for (size_t lane = 0; lane < 4; ++lane)
+                {
+                    SegmentMarchState& state = lanes[lane];
+                    AZ::Vector3 samplePosKm = state.m_originKm;
+                    if (state.IsActive())
+                    {
+                        const float intervalEndKm = state.m_intervals[state.m_intervalIndex].m_endKm;
+                        if (state.m_isEmptySpace)
+                        {
+                            // Probe the end of a large step.
+                            state.m_sampleStepKm = AZStd::min(state.m_fineStepKm * CoarseStepMultiplier, intervalEndKm - state.m_distanceKm);
+                            state.m_sampleDistanceKm = state.m_distanceKm + state.m_sampleStepKm;
+                        }
+                        else
+                        {
+                            // Midpoint of a small step.
+                            state.m_sampleStepKm = AZStd::min(state.m_fineStepKm, intervalEndKm - state.m_distanceKm);
+                            state.m_sampleDistanceKm = state.m_distanceKm + state.m_sampleStepKm * 0.5f;
+                            fineStepLaneMask |= 1u << lane;
+                        }
+                        samplePosKm = state.m_originKm + state.m_direction * state.m_sampleDistanceKm;
+                    }
+                    posX[lane] = samplePosKm.GetX();
+                    posY[lane] = samplePosKm.GetY();
+                    posZ[lane] = samplePosKm.GetZ();
+                }
+
+                // Like RayMarchClouds(), the high frequency noise is only worth it inside clouds. The empty space
+                // probes of the other lanes must not be eroded by it, or they would find fewer clouds than the fine steps.
+                alignas(16) float densities[4];
+                Vec4::StoreAligned(densities, SampleDensityKm(Vec4::LoadAligned(posX), Vec4::LoadAligned(posY), Vec4::LoadAligned(posZ),
+                    windOffsetKm, fineStepLaneMask));
+
+                for (size_t lane = 0; lane < 4; ++lane)
+                {
+                    SegmentMarchState& state = lanes[lane];
+                    if (!state.IsActive())
+                    {
+                        continue;
+                    }
+
+                    if (state.m_isEmptySpace)
+                    {
+                        if (densities[lane] > 0.0f)
+                        {
+                            // Found a cloud somewhere in the large step, march it again with small steps.
+                            state.m_isEmptySpace = false;
+                            state.m_zeroDensityStepCount = 0;
+                            continue;
+                        }
+                        state.m_distanceKm += state.m_sampleStepKm;
+                    }
+                    else
+                    {
+                        if (densities[lane] > 0.0f)
+                        {
+                            state.m_opticalDepth += m_extinctionCoefficientPerKm * densities[lane] * state.m_sampleStepKm;
+                            state.m_zeroDensityStepCount = 0;
+                        }
+                        else if (++state.m_zeroDensityStepCount >= ZeroDensityStepsToEmptySpace)
+                        {
+                            state.m_isEmptySpace = true;
+                        }
+                        state.m_distanceKm += state.m_sampleStepKm;
+                    }
+
+                    if (state.m_opticalDepth >= MaxOpticalDepth)
+                    {
+                        state.m_intervalIndex = state.m_intervalCount;
+                    }
+                    else if (state.m_distanceKm >= state.m_intervals[state.m_intervalIndex].m_endKm)
+                    {
+                        if (++state.m_intervalIndex < state.m_intervalCount)
+                        {
+                            state.m_distanceKm = state.m_intervals[state.m_intervalIndex].m_startKm;
+                            state.m_isEmptySpace = true;
+                        }
+                    }
+                }
+            }
+
+            for (size_t lane = 0; lane < laneCount; ++lane)
+            {
+                CloudTransmittanceResult& result = results[firstSegment + lane];
+                result.m_opticalDepth = lanes[lane].m_opticalDepth;
+                result.m_transmittance = expf(-lanes[lane].m_opticalDepth);
+            }
+        }
+    }
+
+    CloudDensitySampler::FloatType CloudDensitySampler::GetHeightFraction(FloatType posX, FloatType posY, FloatType posZ) const
+    {
+        const FloatType lengthSq = Vec4::Madd(posX, posX, Vec4::Madd(posY, posY, Vec4::Mul(posZ, posZ)));
+        const FloatType distanceToCenterKm = Vec4::Sqrt(lengthSq);
+        return Vec4::Div(Vec4::Sub(distanceToCenterKm, Vec4::Splat(m_innerSphereRadiusKm)),
+            Vec4::Splat(m_outerSphereRadiusKm - m_innerSphereRadiusKm));
+    }
+
+    CloudDensitySampler::FloatType CloudDensitySampler::SampleDensityKm(FloatType posX, FloatType posY, FloatType posZ,
+        const AZ::Vector3& windOffsetKm, uint32_t highFreqNoiseLaneMask) const
+    {
+        if (!IsReady())
+        {
+            return Vec4::ZeroFloat();
+        }
+
+        const FloatType heightFraction = GetHeightFraction(posX, posY, posZ);
+
+        // ApplyWindEffect(). Skew in wind direction, then animate in wind direction with a small bias upwards.
+        const FloatType skewKm = Vec4::Mul(heightFraction, Vec4::Splat(m_cloudTopOffsetKm));
+        posX = Vec4::Madd(skewKm, Vec4::Splat(m_windDirection.GetX()), Vec4::Add(posX, Vec4::Splat(windOffsetKm.GetX())));
+        posY = Vec4::Madd(skewKm, Vec4::Splat(m_windDirection.GetY()), Vec4::Add(posY, Vec4::Splat(windOffsetKm.GetY())));
+        posZ = Vec4::Madd(skewKm, Vec4::Splat(m_windDirection.GetZ()), Vec4::Add(posZ, Vec4::Splat(windOffsetKm.GetZ())));
+
+        // Texture fetches, one point at a time.
+        alignas(16) float posXs[4];
+        alignas(16) float posYs[4];
+        alignas(16) float posZs[4];
+        Vec4::StoreAligned(posXs, posX);
+        Vec4::StoreAligned(posYs, posY);
+        Vec4::StoreAligned(posZs, posZ);
+        alignas(16) float lowFreq[4][4];
+        alignas(16) float weather[4][4];
+        alignas(16) float highFreq[4][4] = {};
+        alignas(16) float highFreqWeight[4] = {};
+        const float halfWorldSizeKm = m_weatherMapSizeKm * 0.5f;
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            float rgba[4];
+            const float u = posXs[lane] * m_uvwScale;
+            const float v = posYs[lane] * m_uvwScale;
+            const float w = posZs[lane] * m_uvwScale;
+            m_lowFrequencyNoise->SampleTrilinear(u, v, w, rgba);
+            for (uint32_t channel = 0; channel < 4; ++channel)
+            {
+                lowFreq[channel][lane] = rgba[channel];
+            }
+
+            // Same as GetWeatherData().
+            m_weatherMap->SampleBilinear(1.0f + (posXs[lane] - halfWorldSizeKm) / m_weatherMapSizeKm,
+                1.0f + (posYs[lane] - halfWorldSizeKm) / m_weatherMapSizeKm, rgba);
+            for (uint32_t channel = 0; channel < 4; ++channel)
+            {
+                weather[channel][lane] = rgba[channel];
+            }
+
+            if (highFreqNoiseLaneMask & (1u << lane))
+            {
+                m_highFrequencyNoise->SampleTrilinear(u, v, w, rgba);
+                for (uint32_t channel = 0; channel < 4; ++channel)
+                {
+                    highFreq[channel][lane] = rgba[channel];
+                }
+                highFreqWeight[lane] = 1.0f;
+            }
+        }
+
+        const FloatType lowFreqFBM = Vec4::Madd(Vec4::LoadAligned(lowFreq[1]), Vec4::Splat(0.625f),
+            Vec4::Madd(Vec4::LoadAligned(lowFreq[2]), Vec4::Splat(0.25f), Vec4::Mul(Vec4::LoadAligned(lowFreq[3]), Vec4::Splat(0.125f))));
+        const FloatType shapeNoiseSample = Remap(Vec4::LoadAligned(lowFreq[0]), Vec4::Sub(lowFreqFBM, Vec4::Splat(1.0f)),
+            Vec4::Splat(1.0f), Vec4::ZeroFloat(), Vec4::Splat(1.0f));
+
+        const FloatType weatherR = Vec4::LoadAligned(weather[0]);
+        const FloatType weatherG = Vec4::LoadAligned(weather[1]);
+        const FloatType cloudMaxHeight = Vec4::LoadAligned(weather[2]);
+        const FloatType weatherMapDensity = Vec4::LoadAligned(weather[3]);
+
+        const FloatType shapeRemapBottom = Saturate(Remap(heightFraction, 0.0f, 0.070f, 0.0f, 1.0f));
+        const FloatType shapeRemapTop = Saturate(Remap(heightFraction, Vec4::Mul(cloudMaxHeight, Vec4::Splat(0.20f)), cloudMaxHeight,
+            Vec4::Splat(1.0f), Vec4::ZeroFloat()));
+        const FloatType shapeAltering = Vec4::Mul(shapeRemapBottom, shapeRemapTop);
+
+        // These two remaps also make the density 0 outside of the cloud slab.
+        const FloatType densityRemapBottom = Vec4::Mul(heightFraction, Saturate(Remap(heightFraction, 0.0f, 0.15f, 0.0f, 0.10f)));
+        const FloatType densityRemapTop = Saturate(Remap(heightFraction, 0.9f, 1.0f, 1.0f, 0.0f));
+        const FloatType densityAlteration = Vec4::Mul(Vec4::Mul(Vec4::Splat(m_globalCloudDensity * 2.0f), Vec4::Mul(densityRemapBottom, densityRemapTop)),
+            weatherMapDensity);
+
+        const float coverage = m_globalCloudCoverage;
+        const FloatType weatherMapCoverage = Vec4::Max(weatherR, Vec4::Mul(weatherG, Vec4::Splat(AZ::GetClamp(coverage - 0.5f, 0.0f, 1.0f) * 2.0f)));
+
+        FloatType result = Saturate(Remap(Vec4::Mul(shapeNoiseSample, shapeAltering),
+            Vec4::Sub(Vec4::Splat(1.0f), Vec4::Mul(Vec4::Splat(coverage), weatherMapCoverage)), Vec4::Splat(1.0f), Vec4::ZeroFloat(), Vec4::Splat(1.0f)));
+        if (highFreqNoiseLaneMask != 0)
+        {
+            // Only "gba", see CloudscapeCS.azsl.
+            const FloatType highFreqFBM = Vec4::Madd(Vec4::LoadAligned(highFreq[1]), Vec4::Splat(0.625f),
+                Vec4::Madd(Vec4::LoadAligned(highFreq[2]), Vec4::Splat(0.25f), Vec4::Mul(Vec4::LoadAligned(highFreq[3]), Vec4::Splat(0.125f))));
+            // A remap from 0 leaves the lanes without high frequency noise unchanged.
+            const FloatType highFreqNoiseModified = Vec4::Mul(Vec4::Mul(Vec4::Splat(0.35f * expf(-coverage * 0.75f)),
+                Lerp(highFreqFBM, Vec4::Sub(Vec4::Splat(1.0f), highFreqFBM), Saturate(heightFraction))), Vec4::LoadAligned(highFreqWeight));
+            result = Saturate(Remap(result, highFreqNoiseModified, Vec4::Splat(1.0f), Vec4::ZeroFloat(), Vec4::Splat(1.0f)));
+        }
+
+        return Vec4::Mul(result, densityAlteration);
+    }
+
+} // namespace VolumetricClouds
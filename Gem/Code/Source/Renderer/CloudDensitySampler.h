@@ -0,0 +1,119 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/Math/Vector3.h>
+#include <AzCore/Math/Simd/SimdMath.h>
+#include <AzCore/std/containers/span.h>
+#include <AzCore/std/containers/vector.h>
+#include <AzCore/std/smart_ptr/shared_ptr.h>
+
+#include <VolumetricClouds/CloudQueryBus.h>
+
+namespace AZ::RPI
+{
+    class Image;
+}
+
+namespace VolumetricClouds
+{
+    struct CloudscapeShaderConstantData;
+
+    // CPU copy of the most detailed mip, available on the CPU, of an R8G8B8A8 or B8G8R8A8 2D or 3D texture.
+    struct CloudCpuTexture
+    {
+        // Only images created from a StreamingImageAsset have their data on the CPU.
+        // Returns nullptr for other images, e.g. the noise textures generated by CloudTexturesComputeFeatureProcessor,
+        // or for unsupported formats.
+        static AZStd::shared_ptr<const CloudCpuTexture> CreateFromImage(const AZ::RPI::Image* image);
+        // Returns false if CreateFromImage() will never succeed with @image, as opposed to
+        // its asset not being loaded yet.
+        static bool CanBeCreatedFromImage(const AZ::RPI::Image* image);
+
+        // Same as a WrapLinearSampler. Returns RGBA in the 0..1 range.
+        void SampleBilinear(float u, float v, float rgbaOut[4]) const;
+        void SampleTrilinear(float u, float v, float w, float rgbaOut[4]) const;
+
+        AZStd::vector<uint8_t> m_texels;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_depth = 0;
+        uint32_t m_bytesPerRow = 0;
+        uint32_t m_bytesPerSlice = 0;
+        bool m_isBgra = false;
+
+    private:
+        void LoadTexel(uint32_t x, uint32_t y, uint32_t z, float rgbaOut[4]) const;
+    };
+
+    // CPU implementation of SampleCloudDensity() in CloudscapeCS.azsl. Immutable once created, so one instance
+    // can be shared by any number of threads. The arithmetic is vectorized over groups of 4 points,
+    // the texture fetches are done per point.
+    // Always samples the most detailed mip available on the CPU.
+    class CloudDensitySampler
+    {
+    public:
+        using FloatType = AZ::Simd::Vec4::FloatType;
+
+        CloudDensitySampler(const CloudscapeShaderConstantData& shaderData,
+            AZStd::shared_ptr<const CloudCpuTexture> lowFrequencyNoise,
+            AZStd::shared_ptr<const CloudCpuTexture> highFrequencyNoise,
+            AZStd::shared_ptr<const CloudCpuTexture> weatherMap);
+
+        // True if the samplers created from @lhs and @rhs return the same densities, as long as they get
+        // the same textures. Most of the shader constant data, e.g. the sun, is not used by the sampler.
+        static bool AreInputsEqual(const CloudscapeShaderConstantData& lhs, const CloudscapeShaderConstantData& rhs);
+
+        // Returns false if any of the textures is missing.
+        bool IsReady() const;
+
+        // @worldPositions are in meters, in the same space as the camera, see GetCameraPositionKm() in CloudscapeCommon.azsli.
+        // @windOffsetKm must be the same wind offset as the one sent to the shaders, see CloudscapeFeatureProcessor::UpdateWindOffset().
+        void SampleDensity(AZStd::span<const AZ::Vector3> worldPositions, AZStd::span<float> densities, const AZ::Vector3& windOffsetKm) const;
+
+        // Optical depth and transmittance along each segment from @segmentStarts to @segmentEnds, in meters.
+        // Each segment is clipped to the cloud slab, which is marched with large cheap steps through empty space
+        // and with small steps, like RayMarchClouds() in CloudscapeCS.azsl, once clouds are found.
+        // 4 segments are marched at the same time. The march stops once the transmittance is almost 0,
+        // so the optical depth of opaque segments is a lower bound.
+        void SampleTransmittance(AZStd::span<const AZ::Vector3> segmentStarts, AZStd::span<const AZ::Vector3> segmentEnds,
+            AZStd::span<CloudTransmittanceResult> results, const AZ::Vector3& windOffsetKm) const;
+
+        // Same as SampleDensity(), for 4 points already in kilometers relative to the planet center.
+        // Bit N of @highFreqNoiseLaneMask enables the high frequency noise erosion of point N.
+        FloatType SampleDensityKm(FloatType posX, FloatType posY, FloatType posZ, const AZ::Vector3& windOffsetKm,
+            uint32_t highFreqNoiseLaneMask) const;
+        static constexpr uint32_t AllLanesMask = 0xF;
+
+        // Returns a value between 0 and 1 of the height of each point within the cloud slab.
+        FloatType GetHeightFraction(FloatType posX, FloatType posY, FloatType posZ) const;
+
+        float GetPlanetRadiusKm() const { return m_planetRadiusKm; }
+        float GetInnerSphereRadiusKm() const { return m_innerSphereRadiusKm; }
+        float GetOuterSphereRadiusKm() const { return m_outerSphereRadiusKm; }
+
+    private:
+        AZStd::shared_ptr<const CloudCpuTexture> m_lowFrequencyNoise;
+        AZStd::shared_ptr<const CloudCpuTexture> m_highFrequencyNoise;
+        AZStd::shared_ptr<const CloudCpuTexture> m_weatherMap;
+
+        // Copied from CloudscapeShaderConstantData.
+        float m_planetRadiusKm = 0.0f;
+        float m_innerSphereRadiusKm = 0.0f;
+        float m_outerSphereRadiusKm = 0.0f;
+        float m_uvwScale = 0.0f;
+        float m_weatherMapSizeKm = 0.0f;
+        float m_globalCloudCoverage = 0.0f;
+        float m_globalCloudDensity = 0.0f;
+        AZ::Vector3 m_windDirection = AZ::Vector3::CreateAxisX();
+        float m_cloudTopOffsetKm = 0.0f;
+        // (Absorption + Scattering) coefficients in [km-1], same as eCoef in RayMarchClouds().
+        float m_extinctionCoefficientPerKm = 0.0f;
+    };
+
+} // namespace VolumetricClouds
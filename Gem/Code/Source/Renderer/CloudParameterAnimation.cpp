@@ -0,0 +1,199 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/Serialization/SerializeContext.h>
+#include <AzCore/Serialization/EditContext.h>
+#include <AzCore/std/algorithm.h>
+
+#include <VolumetricClouds/VolumetricCloudsTypeIds.h>
+#include <Renderer/CloudscapeShaderConstantData.h>
+#include "CloudParameterAnimation.h"
+
+namespace VolumetricClouds
+{
+    AZ_CLASS_ALLOCATOR_IMPL(CloudParameterTrack, AZ::SystemAllocator);
+    AZ_TYPE_INFO_WITH_NAME_IMPL(CloudParameterTrack, "VolumetricClouds::CloudParameterTrack", CloudParameterTrackTypeId);
+    AZ_RTTI_NO_TYPE_INFO_IMPL(CloudParameterTrack);
+
+    void CloudParameterTrack::Reflect(AZ::ReflectContext* context)
+    {
+        if (auto serializeContext = azrtti_cast<AZ::SerializeContext*>(context))
+        {
+            serializeContext->Enum<AnimatedCloudParameter>()
+                ->Value("CloudCoverage", AnimatedCloudParameter::CloudCoverage)
+                ->Value("CloudDensity", AnimatedCloudParameter::CloudDensity)
+                ->Value("WindSpeedKmPerSec", AnimatedCloudParameter::WindSpeedKmPerSec)
+                ->Value("CloudTopShiftKm", AnimatedCloudParameter::CloudTopShiftKm)
+                ->Value("SunLightIntensity", AnimatedCloudParameter::SunLightIntensity)
+                ;
+
+            serializeContext->Class<CloudParameterTrack>()
+                ->Version(1)
+                ->Field("Parameter", &CloudParameterTrack::m_parameter)
+                ->Field("Keyframes", &CloudParameterTrack::m_keyframes)
+                ->Field("DurationSeconds", &CloudParameterTrack::m_durationSeconds)
+                ->Field("Loop", &CloudParameterTrack::m_loop)
+                ;
+
+            if (auto editContext = serializeContext->GetEditContext())
+            {
+                editContext->Enum<AnimatedCloudParameter>("Animated Cloud Parameter", "")
+                    ->Value("Cloud Coverage", AnimatedCloudParameter::CloudCoverage)
+                    ->Value("Cloud Density", AnimatedCloudParameter::CloudDensity)
+                    ->Value("Wind Speed Km/s", AnimatedCloudParameter::WindSpeedKmPerSec)
+                    ->Value("Cloud Top Shift Km", AnimatedCloudParameter::CloudTopShiftKm)
+                    ->Value("Sun Light Intensity", AnimatedCloudParameter::SunLightIntensity)
+                    ;
+
+                editContext->Class<CloudParameterTrack>(
+                    "Parameter Animation", "A curve played on one of the cloud parameters.")
+                    ->ClassElement(AZ::Edit::ClassElements::EditorData, "")
+                    ->Attribute(AZ::Edit::Attributes::AutoExpand, true)
+                    ->Attribute(AZ::Edit::Attributes::Visibility, AZ::Edit::PropertyVisibility::Show)
+                    ->DataElement(AZ::Edit::UIHandlers::ComboBox, &CloudParameterTrack::m_parameter, "Parameter", "The animated parameter.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudParameterTrack::m_keyframes, "Keyframes",
+                        "(normalized time, value) pairs. The time goes from 0 to 1 over the duration of the animation.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudParameterTrack::m_durationSeconds, "Duration", "")
+                        ->Attribute(AZ::Edit::Attributes::Suffix, " s")
+                        ->Attribute(AZ::Edit::Attributes::Min, 0.0)
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudParameterTrack::m_loop, "Loop",
+                        "Start over when the curve ends. Otherwise the last value is held.")
+                    ;
+            }
+        }
+    }
+
+    bool CloudParameterTrack::operator==(const CloudParameterTrack& rhs) const
+    {
+        return (m_parameter == rhs.m_parameter) &&
+               (m_keyframes == rhs.m_keyframes) &&
+               (m_durationSeconds == rhs.m_durationSeconds) &&
+               (m_loop == rhs.m_loop)
+               ;
+    }
+
+    bool CloudParameterTrack::operator!=(const CloudParameterTrack& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    float CloudParameterTrack::Evaluate(float elapsedSeconds) const
+    {
+        if (m_keyframes.empty())
+        {
+            return 0.0f;
+        }
+
+        float normalizedTime = 1.0f;
+        if (m_durationSeconds > 0.0f)
+        {
+            normalizedTime = elapsedSeconds / m_durationSeconds;
+            normalizedTime = m_loop ? (normalizedTime - floorf(normalizedTime)) : AZStd::min(normalizedTime, 1.0f);
+        }
+
+        if (normalizedTime <= m_keyframes.front().GetX())
+        {
+            return m_keyframes.front().GetY();
+        }
+        // First keyframe after @normalizedTime.
+        auto nextItor = AZStd::upper_bound(m_keyframes.begin(), m_keyframes.end(), normalizedTime,
+            [](float time, const AZ::Vector2& keyframe) { return time < keyframe.GetX(); });
+        if (nextItor == m_keyframes.end())
+        {
+            return m_keyframes.back().GetY();
+        }
+        const AZ::Vector2& prev = *(nextItor - 1);
+        const AZ::Vector2& next = *nextItor;
+        const float span = next.GetX() - prev.GetX();
+        const float t = (span > 0.0f) ? (normalizedTime - prev.GetX()) / span : 1.0f;
+        return AZ::Lerp(prev.GetY(), next.GetY(), t);
+    }
+
+    bool CloudParameterTrack::IsFinished(float elapsedSeconds) const
+    {
+        return !m_loop && (elapsedSeconds >= m_durationSeconds);
+    }
+
+    // Helper for ApplyValue().
+    static bool UpdateValue(float& field, float value)
+    {
+        if (field == value)
+        {
+            return false;
+        }
+        field = value;
+        return true;
+    }
+
+    bool CloudParameterTrack::ApplyValue(AnimatedCloudParameter parameter, float value, CloudscapeShaderConstantData& shaderData)
+    {
+        switch (parameter)
+        {
+        case AnimatedCloudParameter::CloudCoverage:
+            return UpdateValue(shaderData.m_globalCloudCoverage, value);
+        case AnimatedCloudParameter::CloudDensity:
+            return UpdateValue(shaderData.m_globalCloudDensity, value);
+        case AnimatedCloudParameter::WindSpeedKmPerSec:
+            return UpdateValue(shaderData.m_windSpeedKmPerSec, AZStd::max(value, 0.0f));
+        case AnimatedCloudParameter::CloudTopShiftKm:
+            return UpdateValue(shaderData.m_cloudTopOffsetKm, value);
+        case AnimatedCloudParameter::SunLightIntensity:
+            return UpdateValue(shaderData.m_sunLightIntensity, value);
+        default:
+            return false;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // CloudParameterAnimator
+    void CloudParameterAnimator::SetTracks(const AZStd::vector<CloudParameterTrack>& tracks)
+    {
+        AZStd::vector<PlayingTrack> playingTracks;
+        playingTracks.reserve(tracks.size());
+        for (const auto& track : tracks)
+        {
+            PlayingTrack playingTrack;
+            playingTrack.m_track = track;
+            auto itor = AZStd::find_if(m_playingTracks.begin(), m_playingTracks.end(),
+                [&track](const PlayingTrack& other) { return other.m_track.m_id == track.m_id; });
+            if (itor != m_playingTracks.end())
+            {
+                playingTrack.m_elapsedSeconds = itor->m_elapsedSeconds;
+                playingTrack.m_wasFinished = itor->m_wasFinished;
+            }
+            playingTracks.push_back(AZStd::move(playingTrack));
+        }
+        m_playingTracks = AZStd::move(playingTracks);
+    }
+
+    bool CloudParameterAnimator::HasTracks() const
+    {
+        return !m_playingTracks.empty();
+    }
+
+    bool CloudParameterAnimator::Update(float deltaTime, bool reapplyAll, CloudscapeShaderConstantData& shaderData)
+    {
+        bool modified = false;
+        for (auto& playingTrack : m_playingTracks)
+        {
+            if (playingTrack.m_wasFinished && !reapplyAll)
+            {
+                continue;
+            }
+            if (!playingTrack.m_wasFinished)
+            {
+                playingTrack.m_elapsedSeconds += deltaTime;
+                playingTrack.m_wasFinished = playingTrack.m_track.IsFinished(playingTrack.m_elapsedSeconds);
+            }
+            const float value = playingTrack.m_track.Evaluate(playingTrack.m_elapsedSeconds);
+            modified |= CloudParameterTrack::ApplyValue(playingTrack.m_track.m_parameter, value, shaderData);
+        }
+        return modified;
+    }
+
+} // namespace VolumetricClouds
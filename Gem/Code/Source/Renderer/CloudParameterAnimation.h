@@ -0,0 +1,91 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/RTTI/TypeInfoSimple.h>
+#include <AzCore/Memory/SystemAllocator.h>
+#include <AzCore/Math/Vector2.h>
+#include <AzCore/std/containers/vector.h>
+
+#include <VolumetricClouds/VolumetricCloudsBus.h>
+
+namespace VolumetricClouds
+{
+    struct CloudscapeShaderConstantData;
+
+    // A curve played on one of the parameters of CloudscapeShaderConstantData.
+    // Created with VolumetricCloudsRequests::AnimateParameter(), or serialized in
+    // CloudscapeComponentConfig to start playing when the component is activated.
+    struct CloudParameterTrack
+    {
+        AZ_CLASS_ALLOCATOR_DECL;
+        AZ_TYPE_INFO_WITH_NAME_DECL(CloudParameterTrack);
+        AZ_RTTI_NO_TYPE_INFO_DECL();
+
+        virtual ~CloudParameterTrack() = default;
+
+        static void Reflect(AZ::ReflectContext* reflection);
+
+        // Does not compare @m_id.
+        bool operator==(const CloudParameterTrack& rhs) const;
+        bool operator!=(const CloudParameterTrack& rhs) const;
+
+        // Returns the value of the curve @elapsedSeconds after the track started.
+        float Evaluate(float elapsedSeconds) const;
+        bool IsFinished(float elapsedSeconds) const;
+
+        // Writes @value to the field of @shaderData that corresponds to @parameter.
+        // Returns true if the field changed.
+        static bool ApplyValue(AnimatedCloudParameter parameter, float value, CloudscapeShaderConstantData& shaderData);
+
+        AnimatedCloudParameter m_parameter = AnimatedCloudParameter::CloudCoverage;
+
+        // (normalizedTime, value) pairs, sorted by time. The time goes from 0 to 1 over @m_durationSeconds.
+        AZStd::vector<AZ::Vector2> m_keyframes;
+        float m_durationSeconds = 10.0f;
+
+        // When true the curve starts over when it ends, otherwise the last value is held.
+        bool m_loop = false;
+
+        // Not serialized. Assigned by CloudscapeComponentController each time the track is (re)started,
+        // so CloudParameterAnimator can tell a new track from one that is already playing.
+        uint32_t m_id = 0;
+    };
+
+    // Owned by CloudscapeFeatureProcessor. Plays the tracks and writes the animated values
+    // into the shader constant data once per frame.
+    class CloudParameterAnimator
+    {
+    public:
+        CloudParameterAnimator() = default;
+        ~CloudParameterAnimator() = default;
+
+        // Tracks with the same @m_id as a playing track keep their elapsed time,
+        // all the others start from the beginning.
+        void SetTracks(const AZStd::vector<CloudParameterTrack>& tracks);
+
+        bool HasTracks() const;
+
+        // Advances all the tracks by @deltaTime and writes their values into @shaderData.
+        // Finished tracks only write their last value when @reapplyAll is true, which is needed
+        // each time @shaderData is overwritten with new data from the controller.
+        // Returns true if @shaderData was modified. Tracks that are on a flat part of their curve don't modify it.
+        bool Update(float deltaTime, bool reapplyAll, CloudscapeShaderConstantData& shaderData);
+
+    private:
+        struct PlayingTrack
+        {
+            CloudParameterTrack m_track;
+            float m_elapsedSeconds = 0.0f;
+            bool m_wasFinished = false;
+        };
+
+        AZStd::vector<PlayingTrack> m_playingTracks;
+    };
+
+} // namespace VolumetricClouds
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/std/algorithm.h>
+
+#include <Atom/RPI.Public/Image/ImageSystemInterface.h>
+
+#include <Renderer/CloudMaterialProperties.h>
+#include "CloudPhaseFunctionLut.h"
+
+namespace VolumetricClouds
+{
+    // Same as the former CalcHenyeyGreenstein() in CloudscapeCS.azsl.
+    static float CalcHenyeyGreenstein(float cosAngle, float g)
+    {
+        // Largest half precision float. For excentricities close to +/-1 the peak of the lobe
+        // overflows 16 bits floats, see CloudscapeHalfPrecisionCS.azsl.
+        static constexpr float MaxPhase = 65504.0f;
+        g = AZStd::clamp(g, -CloudPhaseFunctionLut::MaxExcentricity, CloudPhaseFunctionLut::MaxExcentricity);
+        const float g2 = g * g;
+        const float denom = 1.0f + g2 - 2.0f * g * cosAngle;
+        // denom*denom*sqrt(denom) instead of pow(denom, 1.5)
+        const float henyeyGreenstein = (1.0f - g2) / (denom * denom * sqrtf(denom)) / (4.0f * AZ::Constants::Pi);
+        return AZStd::min(henyeyGreenstein, MaxPhase);
+    }
+
+    float CloudPhaseFunctionLut::GetTexelAngle(uint32_t texelIndex)
+    {
+        const float u = static_cast<float>(texelIndex) / static_cast<float>(Width - 1);
+        return AZ::Constants::Pi * u * u;
+    }
+
+    void CloudPhaseFunctionLut::GenerateTexels(const CloudMaterialProperties& materialProperties, AZStd::vector<float>& texels)
+    {
+        texels.resize(Width * 4);
+        // The shader works in kilometers.
+        const float scatteringCoefficientKm = materialProperties.m_scatteringCoefficient * 1000.0f;
+        const float g = materialProperties.m_henyeyGreensteinG;
+        for (uint32_t texelIndex = 0; texelIndex < Width; ++texelIndex)
+        {
+            const float cosAngle = cosf(GetTexelAngle(texelIndex));
+            float* texel = &texels[texelIndex * 4];
+            float powB = 1.0f;
+            float powC = 1.0f;
+            for (uint32_t octave = 0; octave < OctaveCount; ++octave)
+            {
+                const float forwardPhase = CalcHenyeyGreenstein(cosAngle, powC * g);
+                const float backwardPhase = CalcHenyeyGreenstein(cosAngle, powC * (-g * 0.25f));
+                const float dualLobePhase = AZ::Lerp(forwardPhase, backwardPhase, DualLobeWeight);
+                texel[octave] = scatteringCoefficientKm * powB * dualLobePhase;
+                powB *= materialProperties.m_multiScatteringB;
+                powC *= materialProperties.m_multiScatteringC;
+            }
+            for (uint32_t channel = OctaveCount; channel < 4; ++channel)
+            {
+                texel[channel] = 0.0f;
+            }
+        }
+    }
+
+    AZ::Data::Instance<AZ::RPI::StreamingImage> CloudPhaseFunctionLut::CreateImage(const CloudMaterialProperties& materialProperties)
+    {
+        AZStd::vector<float> texels;
+        GenerateTexels(materialProperties, texels);
+        AZ::Data::Instance<AZ::RPI::StreamingImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemStreamingPool();
+        return AZ::RPI::StreamingImage::CreateFromCpuData(*pool.get(), AZ::RHI::ImageDimension::Image2D, AZ::RHI::Size(Width, 1, 1),
+            AZ::RHI::Format::R32G32B32A32_FLOAT, texels.data(), texels.size() * sizeof(float));
+    }
+
+} // namespace VolumetricClouds
@@ -0,0 +1,47 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/std/containers/vector.h>
+
+#include <Atom/RPI.Public/Image/StreamingImage.h>
+
+namespace VolumetricClouds
+{
+    struct CloudMaterialProperties;
+
+    // Lookup table with the phase function terms of each multiple scattering octave in GetMultiScatteredLuminance(),
+    // see CloudscapeCS.azsl. They only depend on the angle between the view ray and the sun, and on CloudMaterialProperties,
+    // so they are computed on the CPU each time the material changes instead of per ray marching step.
+    // The texture is Width x 1 texels of R32G32B32A32_FLOAT. Texel i is the angle PI * (i / (Width - 1))^2, so most
+    // of the texels go to the narrow forward lobe. 32 bits float formats are not guaranteed to be filterable, so the
+    // shader loads the two nearest texels and interpolates them itself.
+    // Channel N is the scattering coefficient, in [km-1], times b^N times the dual lobe Henyey-Greenstein
+    // phase function with the excentricity attenuated by c^N. Alpha is not used.
+    struct CloudPhaseFunctionLut
+    {
+        // Must match PHASE_FUNCTION_LUT_WIDTH in CloudscapeCS.azsl.
+        static constexpr uint32_t Width = 256;
+        // Must match MAX_OCTAVES in CloudscapeCS.azsl.
+        static constexpr uint32_t OctaveCount = 3;
+        // Weight of the backward lobe.
+        static constexpr float DualLobeWeight = 0.75f;
+        // The excentricity is clamped to +/-MaxExcentricity. At +/-1 the phase function is 0/0 in the direction of the lobe.
+        static constexpr float MaxExcentricity = 0.999f;
+
+        // Returns the angle, in radians, of the texel at @texelIndex.
+        static float GetTexelAngle(uint32_t texelIndex);
+
+        // Writes Width * 4 floats to @texels.
+        static void GenerateTexels(const CloudMaterialProperties& materialProperties, AZStd::vector<float>& texels);
+
+        // Returns nullptr if the image can't be created.
+        static AZ::Data::Instance<AZ::RPI::StreamingImage> CreateImage(const CloudMaterialProperties& materialProperties);
+    };
+
+} // namespace VolumetricClouds
@@ -0,0 +1,172 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/std/algorithm.h>
+
+#include "CloudSkyIrradiance.h"
+
+namespace VolumetricClouds
+{
+    // Same coefficients as "A Scalable and Production Ready Sky and Atmosphere Rendering Technique" (Hillaire 2020),
+    // which are also the defaults of the Sky Atmosphere component. All in [km-1] and [km].
+    static constexpr float AtmosphereThicknessKm = 100.0f;
+    static const AZ::Vector3 RayleighScattering(5.802e-3f, 13.558e-3f, 33.1e-3f);
+    static constexpr float RayleighScaleHeightKm = 8.0f;
+    static constexpr float MieScattering = 3.996e-3f;
+    static constexpr float MieExtinction = 4.440e-3f;
+    static constexpr float MieScaleHeightKm = 1.2f;
+    static constexpr float MieG = 0.8f;
+    static const AZ::Vector3 OzoneAbsorption(0.650e-3f, 1.881e-3f, 0.085e-3f);
+    static constexpr float OzoneCenterHeightKm = 25.0f;
+    static constexpr float OzoneHalfWidthKm = 15.0f;
+
+    // The sky hemisphere is sampled with a stratified cosine weighted distribution. The sky is symmetric
+    // around the vertical plane that contains the sun, so only half of the azimuths are sampled.
+    static constexpr uint32_t ZenithSampleCount = 8;
+    static constexpr uint32_t AzimuthSampleCount = 8;
+    static constexpr uint32_t ViewStepCount = 12;
+    static constexpr uint32_t SunStepCount = 8;
+
+    struct AtmosphereSample
+    {
+        AZ::Vector3 m_rayleighScattering;
+        float m_mieScattering;
+        AZ::Vector3 m_extinction;
+    };
+
+    static AZ::Vector3 Exp(const AZ::Vector3& v)
+    {
+        return AZ::Vector3(expf(v.GetX()), expf(v.GetY()), expf(v.GetZ()));
+    }
+
+    static AtmosphereSample SampleAtmosphere(float heightKm)
+    {
+        heightKm = AZStd::max(heightKm, 0.0f);
+        const float rayleighDensity = expf(-heightKm / RayleighScaleHeightKm);
+        const float mieDensity = expf(-heightKm / MieScaleHeightKm);
+        const float ozoneDensity = AZStd::max(0.0f, 1.0f - fabsf(heightKm - OzoneCenterHeightKm) / OzoneHalfWidthKm);
+
+        AtmosphereSample sample;
+        sample.m_rayleighScattering = RayleighScattering * rayleighDensity;
+        sample.m_mieScattering = MieScattering * mieDensity;
+        sample.m_extinction = sample.m_rayleighScattering + AZ::Vector3(MieExtinction * mieDensity) + OzoneAbsorption * ozoneDensity;
+        return sample;
+    }
+
+    // Distance from @origin, inside the sphere, to the sphere centered at the planet center. Returns -1 if there's no hit.
+    static float GetDistanceToSphere(const AZ::Vector3& origin, const AZ::Vector3& direction, float radiusKm)
+    {
+        const float b = origin.Dot(direction);
+        const float c = origin.Dot(origin) - radiusKm * radiusKm;
+        const float discriminant = b * b - c;
+        if (discriminant < 0.0f)
+        {
+            return -1.0f;
+        }
+        const float sqrtDiscriminant = sqrtf(discriminant);
+        const float nearDistance = -b - sqrtDiscriminant;
+        return (nearDistance > 0.0f) ? nearDistance : (-b + sqrtDiscriminant);
+    }
+
+    static AZ::Vector3 GetSunTransmittance(const AZ::Vector3& positionKm, const AZ::Vector3& directionTowardsTheSun, float planetRadiusKm)
+    {
+        // The planet blocks the sun when the ray towards the sun gets closer to the planet center than the ground.
+        const float b = positionKm.Dot(directionTowardsTheSun);
+        if ((b < 0.0f) && ((positionKm.Dot(positionKm) - b * b) < planetRadiusKm * planetRadiusKm))
+        {
+            return AZ::Vector3::CreateZero();
+        }
+        const float distanceKm = GetDistanceToSphere(positionKm, directionTowardsTheSun, planetRadiusKm + AtmosphereThicknessKm);
+        if (distanceKm <= 0.0f)
+        {
+            return AZ::Vector3::CreateOne();
+        }
+        const float stepSizeKm = distanceKm / SunStepCount;
+        AZ::Vector3 opticalDepth = AZ::Vector3::CreateZero();
+        for (uint32_t stepIndex = 0; stepIndex < SunStepCount; ++stepIndex)
+        {
+            const AZ::Vector3 samplePositionKm = positionKm + directionTowardsTheSun * ((stepIndex + 0.5f) * stepSizeKm);
+            opticalDepth += SampleAtmosphere(samplePositionKm.GetLength() - planetRadiusKm).m_extinction * stepSizeKm;
+        }
+        return Exp(-opticalDepth);
+    }
+
+    // Single scattered radiance, relative to the sun illuminance, that arrives at @positionKm from @viewDirection.
+    static AZ::Vector3 GetSkyRadiance(const AZ::Vector3& positionKm, const AZ::Vector3& viewDirection,
+        const AZ::Vector3& directionTowardsTheSun, float planetRadiusKm)
+    {
+        const float distanceKm = GetDistanceToSphere(positionKm, viewDirection, planetRadiusKm + AtmosphereThicknessKm);
+        if (distanceKm <= 0.0f)
+        {
+            return AZ::Vector3::CreateZero();
+        }
+
+        const float cosAngle = viewDirection.Dot(directionTowardsTheSun);
+        const float rayleighPhase = 3.0f / (16.0f * AZ::Constants::Pi) * (1.0f + cosAngle * cosAngle);
+        // Cornette-Shanks.
+        const float g2 = MieG * MieG;
+        const float mieDenom = 1.0f + g2 - 2.0f * MieG * cosAngle;
+        const float miePhase = 3.0f / (8.0f * AZ::Constants::Pi) * (1.0f - g2) * (1.0f + cosAngle * cosAngle) /
+            ((2.0f + g2) * mieDenom * sqrtf(mieDenom));
+
+        const float stepSizeKm = distanceKm / ViewStepCount;
+        AZ::Vector3 radiance = AZ::Vector3::CreateZero();
+        AZ::Vector3 transmittance = AZ::Vector3::CreateOne();
+        for (uint32_t stepIndex = 0; stepIndex < ViewStepCount; ++stepIndex)
+        {
+            const AZ::Vector3 samplePositionKm = positionKm + viewDirection * ((stepIndex + 0.5f) * stepSizeKm);
+            const AtmosphereSample sample = SampleAtmosphere(samplePositionKm.GetLength() - planetRadiusKm);
+            const AZ::Vector3 stepTransmittance = Exp(-sample.m_extinction * stepSizeKm);
+            const AZ::Vector3 scattering = sample.m_rayleighScattering * rayleighPhase + AZ::Vector3(sample.m_mieScattering * miePhase);
+            const AZ::Vector3 inScattering = scattering * GetSunTransmittance(samplePositionKm, directionTowardsTheSun, planetRadiusKm);
+            // Same energy conserving integration as RayMarchClouds() in CloudscapeCS.azsl.
+            radiance += transmittance * (inScattering - inScattering * stepTransmittance) / sample.m_extinction;
+            transmittance *= stepTransmittance;
+        }
+        return radiance;
+    }
+
+    static AZ::Vector3 GetSkyIrradiance(float heightKm, const AZ::Vector3& directionTowardsTheSun, float planetRadiusKm)
+    {
+        const AZ::Vector3 positionKm(0.0f, 0.0f, planetRadiusKm + heightKm);
+        AZ::Vector3 radianceSum = AZ::Vector3::CreateZero();
+        for (uint32_t zenithIndex = 0; zenithIndex < ZenithSampleCount; ++zenithIndex)
+        {
+            const float u = (zenithIndex + 0.5f) / ZenithSampleCount;
+            const float sinTheta = sqrtf(u);
+            const float cosTheta = sqrtf(1.0f - u);
+            for (uint32_t azimuthIndex = 0; azimuthIndex < AzimuthSampleCount; ++azimuthIndex)
+            {
+                const float phi = AZ::Constants::Pi * (azimuthIndex + 0.5f) / AzimuthSampleCount;
+                const AZ::Vector3 viewDirection(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta);
+                radianceSum += GetSkyRadiance(positionKm, viewDirection, directionTowardsTheSun, planetRadiusKm);
+            }
+        }
+        // The cosine weighted pdf is cos(theta) / PI. The mirrored half of the azimuths has the same radiance.
+        return radianceSum * (AZ::Constants::Pi / (ZenithSampleCount * AzimuthSampleCount));
+    }
+
+    CloudSkyIrradiance CloudSkyIrradiance::Calculate(const AZ::Vector3& directionTowardsTheSun, float planetRadiusKm, float cloudSlabTopKm)
+    {
+        // The sky only depends on the sun elevation, so the sun is placed in the XZ plane above the sample positions.
+        const float sunCosZenith = AZ::GetClamp(directionTowardsTheSun.GetNormalizedSafe().GetZ(), -1.0f, 1.0f);
+        const AZ::Vector3 sunDirection(sqrtf(1.0f - sunCosZenith * sunCosZenith), 0.0f, sunCosZenith);
+
+        CloudSkyIrradiance result;
+        result.m_skyIrradiance = GetSkyIrradiance(cloudSlabTopKm, sunDirection, planetRadiusKm);
+
+        const AZ::Vector3 groundPositionKm(0.0f, 0.0f, planetRadiusKm);
+        const AZ::Vector3 directSunIrradiance =
+            GetSunTransmittance(groundPositionKm, sunDirection, planetRadiusKm) * AZStd::max(sunCosZenith, 0.0f);
+        const AZ::Vector3 groundIrradiance = directSunIrradiance + GetSkyIrradiance(0.0f, sunDirection, planetRadiusKm);
+        // A Lambertian ground reflects albedo * irradiance.
+        result.m_groundIrradiance = groundIrradiance * GroundAlbedo;
+        return result;
+    }
+
+} // namespace VolumetricClouds
@@ -0,0 +1,34 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/Math/Vector3.h>
+
+namespace VolumetricClouds
+{
+    // CPU estimate of the ambient light that reaches the cloud slab. Integrates the single scattering of an
+    // Earth like atmosphere, with the default coefficients of the Sky Atmosphere component, over the sky hemisphere,
+    // and bounces the light that reaches the ground off a diffuse surface.
+    // Both values are relative to the sun illuminance at the top of the atmosphere, so they only depend on the
+    // sun elevation and on the planetary data. The sun color and intensity are applied by CloudscapeComputePass.
+    struct CloudSkyIrradiance
+    {
+        // Typical albedo of soil and vegetation.
+        static constexpr float GroundAlbedo = 0.3f;
+
+        // Irradiance on a horizontal surface facing up, at the top of the cloud slab.
+        AZ::Vector3 m_skyIrradiance = AZ::Vector3::CreateZero();
+        // Irradiance on a horizontal surface facing down, at the bottom of the cloud slab. Only the light
+        // reflected by the ground, the attenuation between the ground and the clouds is ignored.
+        AZ::Vector3 m_groundIrradiance = AZ::Vector3::CreateZero();
+
+        // Takes a fraction of a millisecond, so it should only be called when the sun moves noticeably.
+        static CloudSkyIrradiance Calculate(const AZ::Vector3& directionTowardsTheSun, float planetRadiusKm, float cloudSlabTopKm);
+    };
+
+} // namespace VolumetricClouds
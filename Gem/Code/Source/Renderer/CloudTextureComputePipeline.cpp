@@ -14,6 +14,7 @@
 #include <Atom/RPI.Reflect/System/AnyAsset.h>
 
 #include <Renderer/Passes/CloudTextureComputePass.h>
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 #include "CloudTextureComputePipeline.h"
 
 namespace VolumetricClouds
@@ -74,6 +75,8 @@ namespace VolumetricClouds
             AZ_Error(LogName, false, "Failed to set render data for CloudTexturePipeline with name %s", renderPipelineDescriptor.m_name.c_str());
             return 0;
         }
+
+        m_textureComputePass->SetGpuQueriesEnabled(VolumetricCloudsStatsCollector::IsCollecting());
     
         // Add the pipeline to the scene
         m_scene->AddRenderPipeline(renderPipeline);
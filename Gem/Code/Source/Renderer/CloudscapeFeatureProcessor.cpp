@@ -5,7 +5,15 @@
 *
 */
 
+#include <AzCore/Component/TickBus.h>
+#include <AzCore/Console/IConsole.h>
+#include <AzCore/Jobs/JobCompletion.h>
+#include <AzCore/Jobs/JobFunction.h>
+#include <AzCore/Math/MathUtils.h>
 #include <AzCore/Name/NameDictionary.h>
+#include <AzCore/std/algorithm.h>
+
+#include <AzFramework/Windowing/WindowBus.h>
 
 #include <Atom/RHI/DrawPacketBuilder.h>
 #include <Atom/RHI.Reflect/InputStreamLayoutBuilder.h>
@@ -24,13 +32,25 @@
 #include <Atom/RPI.Public/ViewportContext.h>
 #include <Atom/RPI.Public/Image/ImageSystemInterface.h>
 
+#include <Renderer/CloudPhaseFunctionLut.h>
 #include <Renderer/Passes/CloudscapeComputePass.h>
 #include <Renderer/Passes/CloudscapeRasterPass.h>
+#include <Renderer/Passes/CloudscapeShadowMapBarrierPass.h>
+#include <Renderer/Passes/CloudscapeShadowMapComputePass.h>
+#include <Renderer/Passes/CloudscapeSkyViewComputePass.h>
+#include <Renderer/Passes/CloudscapeStereoReprojectionComputePass.h>
+#include <Renderer/Passes/CloudscapeSunVisibilityComputePass.h>
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 // #include <Renderer/Passes/DepthBufferCopyPass.h>
 #include "CloudscapeFeatureProcessor.h"
 
 namespace VolumetricClouds
 {
+    AZ_CVAR(uint32_t, r_volumetricCloudsRayMarchDebugView, 0, nullptr, AZ::ConsoleFunctorFlags::Null,
+        "Replaces the clouds with a ray marching cost heatmap. 0: Disabled, 1: Primary steps, 2: Light samples, "
+        "3: Expensive density calls, 4: Cheap density calls, 5: Exit reason (dark gray: not marched, green: end of slab, red: opaque). "
+        "The totals are printed by r_volumetricCloudsPrintStats.");
+
     void CloudscapeFeatureProcessor::Reflect(AZ::ReflectContext* context)
     {
         if (auto* serializeContext = azrtti_cast<AZ::SerializeContext*>(context))
@@ -46,106 +66,387 @@ namespace VolumetricClouds
     void CloudscapeFeatureProcessor::Activate()
     {
         ActivateInternal();
+        m_prepareSceneSrgHandler = AZ::RPI::Scene::PrepareSceneSrgEvent::Handler(
+            [this](AZ::RPI::ShaderResourceGroup* sceneSrg) { UpdateSceneSrg(sceneSrg); });
+        GetParentScene()->ConnectEvent(m_prepareSceneSrgHandler);
+        // Only the first scene with clouds answers the queries.
+        if (!CloudQueryInterface::Get())
+        {
+            CloudQueryInterface::Register(this);
+            CloudQueryRequestBus::Handler::BusConnect();
+        }
     }
 
     void CloudscapeFeatureProcessor::Deactivate()
     {
-        if (m_cloudscapeComputePass)
+        for (auto& viewStateItor : m_viewStates)
         {
+            ViewState& viewState = *viewStateItor.second;
             // This is necessary to avoid pesky error messages of invalid attachments when
             // the feature processor is being destroyed.
-            m_cloudscapeComputePass->QueueForRemoval();
-            m_cloudscapeReprojectionPass->QueueForRemoval();
-            m_cloudscapeRenderPass->QueueForRemoval();
+            viewState.QueuePassesForRemoval();
             //m_depthBufferCopyPass->QueueForRemoval();
+            RemoveViewState(viewState);
+        }
+        m_viewStates.clear();
+
+        if (auto statsCollector = VolumetricCloudsStatsCollector::Get())
+        {
+            statsCollector->SetRayMarchTotals(nullptr);
+        }
+
+        if (CloudQueryInterface::Get() == this)
+        {
+            CloudQueryRequestBus::Handler::BusDisconnect();
+            CloudQueryInterface::Unregister(this);
+        }
+        {
+            AZStd::scoped_lock lock(m_densitySamplerMutex);
+            m_densitySampler.reset();
+            m_cloudQueryStatus = CloudQueryStatus::NotReady;
         }
+        m_densitySamplerImages = {};
+        m_densitySamplerResidentMips = {};
+        m_cpuTextures = {};
+        m_phaseFunctionLut = nullptr;
+        m_isSkyIrradianceValid = false;
+
+        m_prepareSceneSrgHandler.Disconnect();
+        m_areSceneSrgIndicesInitialized = false;
+        m_sceneCloudShadowMap = nullptr;
+        m_windOffsetKm = AZ::Vector3::CreateZero();
+        m_prevWindOffsetKm = AZ::Vector3::CreateZero();
 
         DisableSceneNotification();
-        m_viewportSize = { 0,0 };
     }
 
     void CloudscapeFeatureProcessor::Simulate(const SimulatePacket&)
     {
-        if (m_cloudscapeComputePass)
+        UpdateAnimatedShaderConstantData();
+        UpdateWindOffset();
+        if (m_shaderConstantData)
         {
-            m_cloudscapeComputePass->UpdateFrameCounter(m_frameCounter);
+            // Also called when nothing changed, to pick up the mips streamed in or out since the last frame.
+            UpdateDensitySampler(*m_shaderConstantData);
+        }
 
-            const auto& passSrg = m_cloudscapeReprojectionPass->GetShaderResourceGroup();
-            const uint32_t pixelIndex4x4 = m_frameCounter % 16;
-            passSrg->SetConstant(m_pixelIndex4x4Index, pixelIndex4x4);
+        // Only the main render pipeline reports to VolumetricCloudsStatsCollector, otherwise
+        // the samples of views with different resolutions would be mixed.
+        const AZ::RPI::RenderPipelinePtr defaultRenderPipeline = GetParentScene()->GetDefaultRenderPipeline();
+        for (auto& viewStateItor : m_viewStates)
+        {
+            ViewState& viewState = *viewStateItor.second;
+            if (viewState.HasPasses() && !FindStereoSourceViewState(viewState))
+            {
+                SimulateView(viewState, viewState.m_renderPipeline == defaultRenderPipeline.get());
+            }
+        }
 
-            m_cloudscapeRenderPass->UpdateFrameCounter(m_frameCounter);
-            
-            m_frameCounter++;
+        // The right eyes of stereo pairs need the state of their left eye in the current frame.
+        for (auto& viewStateItor : m_viewStates)
+        {
+            ViewState& viewState = *viewStateItor.second;
+            if (!viewState.HasPasses())
+            {
+                continue;
+            }
+            if (ViewState* sourceViewState = FindStereoSourceViewState(viewState))
+            {
+                SimulateStereoSecondEye(viewState, *sourceViewState);
+            }
         }
     }
 
-    void CloudscapeFeatureProcessor::AddRenderPasses([[maybe_unused]] AZ::RPI::RenderPipeline* renderPipeline)
+    void CloudscapeFeatureProcessor::AddRenderPasses(AZ::RPI::RenderPipeline* renderPipeline)
     {
-        // Get the pass requests to create passes from the asset
-        AddPassRequestToRenderPipeline(renderPipeline, "Passes/CloudscapeComputePassRequest.azasset", "DepthPrePass", false /*before*/);
-        // Hold a reference to the compute pass
+        // Pipelines without the reference passes, like the reflection probes baking pipeline,
+        // don't render the cloudscape.
+        const char* referencePassNames[] = { "DepthPrePass", "MotionVectorPass", "TransparentPass" };
+        for (const char* referencePassName : referencePassNames)
         {
-            const auto passName = AZ::Name("CloudscapeComputePass");
-            AZ::RPI::PassFilter passFilter = AZ::RPI::PassFilter::CreateWithPassName(passName, renderPipeline);
-            AZ::RPI::Pass* existingPass = AZ::RPI::PassSystemInterface::Get()->FindFirstPass(passFilter);
-            m_cloudscapeComputePass = azrtti_cast<CloudscapeComputePass*>(existingPass);
-            if (!m_cloudscapeComputePass)
+            if (!renderPipeline->FindFirstPass(AZ::Name(referencePassName)))
             {
-                AZ_Error(LogName, false, "%s Failed to find as RenderPass: %s", __FUNCTION__, passName.GetCStr());
                 return;
             }
+        }
 
-            if (m_shaderConstantData)
+        auto& viewStatePtr = m_viewStates[renderPipeline];
+        if (!viewStatePtr)
+        {
+            viewStatePtr = AZStd::make_shared<ViewState>();
+            viewStatePtr->m_renderPipeline = renderPipeline;
+            viewStatePtr->m_size = GetRenderPipelineSize(renderPipeline);
+            if (!viewStatePtr->m_size.m_width || !viewStatePtr->m_size.m_height)
             {
-                m_cloudscapeComputePass->UpdateShaderConstantData(*m_shaderConstantData);
+                // The attachments are resized by UpdateViewSize() once the size is known.
+                viewStatePtr->m_size = { 1, 1 };
             }
+            viewStatePtr->m_skyView = CreateSkyViewAttachment(AZ::Name(AZStd::string::format("CloudscapeSkyView_%s",
+                renderPipeline->GetId().GetCStr())));
+            AZ_Assert(!!viewStatePtr->m_skyView, "Failed to create CloudscapeSkyView");
         }
+        ViewState& viewState = *viewStatePtr;
 
-        AddPassRequestToRenderPipeline(renderPipeline, "Passes/CloudscapeReprojectionComputePassRequest.azasset", "MotionVectorPass", false /*before*/);
-        // Hold a reference to the compute pass
+        // The passes are new, so the ray march debug view is reapplied by the next Simulate().
+        viewState.m_rayMarchDebugView = RayMarchDebugView::Disabled;
+        if (viewState.m_rayMarchDebugReadback)
         {
-            const auto passName = AZ::Name("CloudscapeReprojectionComputePass");
-            AZ::RPI::PassFilter passFilter = AZ::RPI::PassFilter::CreateWithPassName(passName, renderPipeline);
-            AZ::RPI::Pass* existingPass = AZ::RPI::PassSystemInterface::Get()->FindFirstPass(passFilter);
-            m_cloudscapeReprojectionPass = azrtti_cast<AZ::RPI::ComputePass*>(existingPass);
-            if (!m_cloudscapeReprojectionPass)
-            {
-                AZ_Error(LogName, false, "%s Failed to find as RenderPass: %s", __FUNCTION__, passName.GetCStr());
-                return;
-            }
-            m_cloudscapeReprojectionPass->SetTargetThreadCounts(m_viewportSize.m_width, m_viewportSize.m_height, 1);
+            viewState.m_rayMarchDebugReadback->SetCallback(nullptr);
+            viewState.m_rayMarchDebugReadback = nullptr;
+        }
+        viewState.m_isRayMarchDebugReadbackPending = false;
+        if (viewState.m_sunVisibilityReadback)
+        {
+            viewState.m_sunVisibilityReadback->SetCallback(nullptr);
+            viewState.m_sunVisibilityReadback = nullptr;
         }
+        viewState.m_isSunVisibilityReadbackPending = false;
+        // The new pass doesn't have the positions yet.
+        viewState.m_sunVisibilityPositionsVersion = 0;
+        viewState.m_isCloudShadowMapValid = false;
+        viewState.m_isCloudDepthEnabled = m_renderSettings.m_enableCloudDepthOutput;
+        viewState.m_isCompactHistoryEnabled = m_renderSettings.m_enableCompactHistory;
+        viewState.m_isHdrOutputEnabled = m_renderSettings.m_enableHdrOutput;
+        CreateViewSizedAttachments(viewState);
+        UpdateCloudShadowMapAttachment(viewState);
 
+        // Get the pass requests to create passes from the asset, and hold a reference to each pass.
+        viewState.m_cloudscapeComputePass = AddPass<CloudscapeComputePass>(renderPipeline,
+            "Passes/CloudscapeComputePassRequest.azasset", "CloudscapeComputePass", "DepthPrePass", false /*before*/);
+        viewState.m_cloudscapeSkyViewPass = AddPass<CloudscapeSkyViewComputePass>(renderPipeline,
+            "Passes/CloudscapeSkyViewComputePassRequest.azasset", "CloudscapeSkyViewComputePass", "CloudscapeComputePass", false /*before*/);
+        // It is idle until there are sun visibility positions.
+        viewState.m_cloudscapeSunVisibilityPass = AddPass<CloudscapeSunVisibilityComputePass>(renderPipeline,
+            "Passes/CloudscapeSunVisibilityComputePassRequest.azasset", "CloudscapeSunVisibilityComputePass",
+            "CloudscapeSkyViewComputePass", false /*before*/);
+        // It is idle until the cloud shadow map is enabled, and then only dispatched when the shadows are stale.
+        viewState.m_cloudscapeShadowMapPass = AddPass<CloudscapeShadowMapComputePass>(renderPipeline,
+            "Passes/CloudscapeShadowMapComputePassRequest.azasset", "CloudscapeShadowMapComputePass",
+            "CloudscapeSunVisibilityComputePass", false /*before*/);
+        viewState.m_cloudscapeShadowMapBarrierPass = AddPass<CloudscapeShadowMapBarrierPass>(renderPipeline,
+            "Passes/CloudscapeShadowMapBarrierPassRequest.azasset", "CloudscapeShadowMapBarrierPass",
+            "CloudscapeShadowMapComputePass", false /*before*/);
+        // It is disabled until the ray march debug view is enabled. Without it the debug view works, but there are no totals.
+        viewState.m_cloudscapeRayMarchDebugStatsReductionPass = AddPass<AZ::RPI::ComputePass>(renderPipeline,
+            "Passes/CloudscapeRayMarchDebugStatsReductionPassRequest.azasset", "CloudscapeRayMarchDebugStatsReductionPass",
+            "CloudscapeSkyViewComputePass", false /*before*/);
+        viewState.m_cloudscapeReprojectionPass = AddPass<AZ::RPI::ComputePass>(renderPipeline,
+            "Passes/CloudscapeReprojectionComputePassRequest.azasset", "CloudscapeReprojectionComputePass", "MotionVectorPass", false /*before*/);
+        viewState.m_cloudscapeRenderPass = AddPass<CloudscapeRasterPass>(renderPipeline,
+            "Passes/CloudscapeRasterPassRequest.azasset", "CloudscapeRasterPass", "TransparentPass", true /*before*/);
+        // Only added by UpdateFusedCompositeSettings() while the fused composite is enabled.
+        viewState.m_cloudscapeFusedRenderPass = nullptr;
+        viewState.m_cloudscapeStereoReprojectionPass = nullptr;
+        viewState.m_stereoSourceOutput1 = nullptr;
+        if (renderPipeline->GetViewType() == AZ::RPI::ViewType::XrRight)
+        {
+            // It is idle until SimulateStereoSecondEye() finds the left eye.
+            viewState.m_cloudscapeStereoReprojectionPass = AddPass<CloudscapeStereoReprojectionComputePass>(renderPipeline,
+                "Passes/CloudscapeStereoReprojectionComputePassRequest.azasset", "CloudscapeStereoReprojectionComputePass",
+                "CloudscapeReprojectionComputePass", false /*before*/);
+        }
+
+        if (!viewState.HasPasses())
+        {
+            // Don't leave the passes that were added in the render pipeline, they would read attachments
+            // that nobody writes.
+            viewState.QueuePassesForRemoval();
+            RemoveViewState(viewState);
+            m_viewStates.erase(renderPipeline);
+            return;
+        }
 
-        AddPassRequestToRenderPipeline(renderPipeline, "Passes/CloudscapeRasterPassRequest.azasset", "TransparentPass", true /*before*/);
-        // Hold a reference to the render pass
+        if (m_shaderConstantData)
         {
-            const auto passName = AZ::Name("CloudscapeRasterPass");
-            AZ::RPI::PassFilter passFilter = AZ::RPI::PassFilter::CreateWithPassName(passName, renderPipeline);
-            AZ::RPI::Pass* existingPass = AZ::RPI::PassSystemInterface::Get()->FindFirstPass(passFilter);
-            m_cloudscapeRenderPass = azrtti_cast<CloudscapeRasterPass*>(existingPass);
-            if (!m_cloudscapeRenderPass)
+            viewState.m_cloudscapeComputePass->UpdateShaderConstantData(*m_shaderConstantData);
+            viewState.m_cloudscapeSkyViewPass->UpdateShaderConstantData(*m_shaderConstantData);
+            viewState.m_cloudscapeSunVisibilityPass->UpdateShaderConstantData(*m_shaderConstantData);
+            viewState.m_cloudscapeShadowMapPass->UpdateShaderConstantData(*m_shaderConstantData);
+            if (viewState.m_cloudscapeStereoReprojectionPass)
             {
-                AZ_Error(LogName, false, "%s Failed to find as RenderPass: %s", __FUNCTION__, passName.GetCStr());
-                return;
+                viewState.m_cloudscapeStereoReprojectionPass->UpdateShaderConstantData(*m_shaderConstantData);
             }
         }
+        viewState.m_cloudscapeReprojectionPass->SetTargetThreadCounts(viewState.m_size.m_width, viewState.m_size.m_height, 1);
+        viewState.m_cloudscapeComputePass->SetCloudDepthEnabled(viewState.m_isCloudDepthEnabled);
+        viewState.m_cloudscapeComputePass->SetCompactHistoryEnabled(viewState.m_isCompactHistoryEnabled);
+        viewState.m_cloudscapeComputePass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+        }
+        viewState.m_staticFrameCount = 0;
 
+        UpdateSkyViewParameters(viewState);
+        UpdateDynamicQualitySettings(viewState);
+        UpdateAsyncComputeSettings(viewState);
+        UpdateFusedCompositeSettings(viewState);
     }
 
     //! AZ::RPI::FeatureProcessor overrides END ...
     /////////////////////////////////////////////////////////////////////////////
 
 
+    /////////////////////////////////////////////////////////////////////////////
+    //! CloudQueryRequestBus overrides START ...
+    bool CloudscapeFeatureProcessor::IsCloudQueryReady()
+    {
+        auto densitySampler = GetDensitySampler();
+        return densitySampler && densitySampler->IsReady();
+    }
+
+    CloudQueryStatus CloudscapeFeatureProcessor::GetCloudQueryStatus()
+    {
+        AZStd::scoped_lock lock(m_densitySamplerMutex);
+        return m_cloudQueryStatus;
+    }
+
+    bool CloudscapeFeatureProcessor::QueryCloudDensity(AZStd::span<const AZ::Vector3> worldPositions, AZStd::span<float> densities)
+    {
+        AZ_Assert(worldPositions.size() == densities.size(), "The number of positions and densities must match");
+        auto densitySampler = GetDensitySampler();
+        if (!densitySampler || !densitySampler->IsReady())
+        {
+            AZStd::fill(densities.begin(), densities.end(), 0.0f);
+            return false;
+        }
+
+        const AZ::Vector3 windOffsetKm = GetDensitySamplerWindOffsetKm();
+
+        static constexpr size_t PointsPerBatch = 1024;
+        const size_t pointCount = AZStd::min(worldPositions.size(), densities.size());
+        RunQueryBatches(pointCount, PointsPerBatch, [&](size_t firstPoint, size_t batchPointCount)
+            {
+                densitySampler->SampleDensity(worldPositions.subspan(firstPoint, batchPointCount),
+                    densities.subspan(firstPoint, batchPointCount), windOffsetKm);
+            });
+        return true;
+    }
+
+    bool CloudscapeFeatureProcessor::QueryCloudTransmittance(AZStd::span<const AZ::Vector3> segmentStarts,
+        AZStd::span<const AZ::Vector3> segmentEnds, AZStd::span<CloudTransmittanceResult> results)
+    {
+        AZ_Assert((segmentStarts.size() == segmentEnds.size()) && (segmentStarts.size() == results.size()),
+            "The number of segment starts, segment ends and results must match");
+        auto densitySampler = GetDensitySampler();
+        if (!densitySampler || !densitySampler->IsReady())
+        {
+            AZStd::fill(results.begin(), results.end(), CloudTransmittanceResult{});
+            return false;
+        }
+
+        const AZ::Vector3 windOffsetKm = GetDensitySamplerWindOffsetKm();
+
+        // Each segment takes tens to hundreds of density samples.
+        static constexpr size_t SegmentsPerBatch = 64;
+        const size_t segmentCount = AZStd::min(AZStd::min(segmentStarts.size(), segmentEnds.size()), results.size());
+        RunQueryBatches(segmentCount, SegmentsPerBatch, [&](size_t firstSegment, size_t batchSegmentCount)
+            {
+                densitySampler->SampleTransmittance(segmentStarts.subspan(firstSegment, batchSegmentCount),
+                    segmentEnds.subspan(firstSegment, batchSegmentCount), results.subspan(firstSegment, batchSegmentCount), windOffsetKm);
+            });
+        return true;
+    }
+
+    void CloudscapeFeatureProcessor::SetSunVisibilityPositions(AZStd::span<const AZ::Vector3> worldPositions)
+    {
+        SunVisibilityState& sunVisibility = *m_sunVisibility;
+        AZStd::scoped_lock lock(sunVisibility.m_mutex);
+        sunVisibility.m_positions.assign(worldPositions.begin(), worldPositions.end());
+        ++sunVisibility.m_positionsVersion;
+        if (sunVisibility.m_positions.empty())
+        {
+            sunVisibility.m_results.clear();
+        }
+    }
+
+    bool CloudscapeFeatureProcessor::GetSunVisibility(AZStd::span<float> transmittances)
+    {
+        SunVisibilityState& sunVisibility = *m_sunVisibility;
+        AZStd::scoped_lock lock(sunVisibility.m_mutex);
+        const size_t resultCount = AZStd::min(transmittances.size(), sunVisibility.m_results.size());
+        AZStd::copy(sunVisibility.m_results.begin(), sunVisibility.m_results.begin() + resultCount, transmittances.begin());
+        AZStd::fill(transmittances.begin() + resultCount, transmittances.end(), 1.0f);
+        return !sunVisibility.m_results.empty();
+    }
+    //! CloudQueryRequestBus overrides END ...
+    /////////////////////////////////////////////////////////////////////////////
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    //! AZ::RPI::SceneNotificationBus overrides START ...
+    void CloudscapeFeatureProcessor::OnRenderPipelineChanged(AZ::RPI::RenderPipeline* renderPipeline,
+        AZ::RPI::SceneNotification::RenderPipelineChangeType changeType)
+    {
+        // Added and PassChanged are handled by AddRenderPasses().
+        if (changeType != AZ::RPI::SceneNotification::RenderPipelineChangeType::Removed)
+        {
+            return;
+        }
+
+        auto viewStateItor = m_viewStates.find(renderPipeline);
+        if (viewStateItor == m_viewStates.end())
+        {
+            return;
+        }
+        // The passes are removed together with the render pipeline.
+        RemoveViewState(*viewStateItor->second);
+        m_viewStates.erase(viewStateItor);
+    }
+    //! AZ::RPI::SceneNotificationBus overrides END ...
+    /////////////////////////////////////////////////////////////////////////////
+
+
     /////////////////////////////////////////////////////////////////////
     //! Functions called by CloudscapeComponentController START
+    void CloudscapeFeatureProcessor::StageShaderConstantData(const CloudscapeShaderConstantData& shaderData)
+    {
+        m_stagedShaderConstantData.Stage(shaderData);
+    }
+
+    void CloudscapeFeatureProcessor::StageParameterTracks(const AZStd::vector<CloudParameterTrack>& tracks)
+    {
+        m_stagedParameterTracks.Stage(tracks);
+    }
+
     void CloudscapeFeatureProcessor::UpdateShaderConstantData(const CloudscapeShaderConstantData& shaderData)
     {
         m_shaderConstantData = &shaderData;
-        if (m_cloudscapeComputePass)
+        for (auto& viewStateItor : m_viewStates)
+        {
+            ViewState& viewState = *viewStateItor.second;
+            viewState.m_staticFrameCount = 0;
+            if (viewState.HasPasses())
+            {
+                viewState.m_cloudscapeComputePass->UpdateShaderConstantData(shaderData);
+                viewState.m_cloudscapeSkyViewPass->UpdateShaderConstantData(shaderData);
+                viewState.m_cloudscapeSunVisibilityPass->UpdateShaderConstantData(shaderData);
+                viewState.m_cloudscapeShadowMapPass->UpdateShaderConstantData(shaderData);
+                if (viewState.m_cloudscapeStereoReprojectionPass)
+                {
+                    viewState.m_cloudscapeStereoReprojectionPass->UpdateShaderConstantData(shaderData);
+                }
+                UpdateSkyViewParameters(viewState);
+            }
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdateRenderSettings(const CloudscapeRenderSettings& renderSettings)
+    {
+        m_renderSettings = renderSettings;
+        for (auto& viewStateItor : m_viewStates)
         {
-            m_cloudscapeComputePass->UpdateShaderConstantData(shaderData);
+            ViewState& viewState = *viewStateItor.second;
+            viewState.m_staticFrameCount = 0;
+            if (viewState.HasPasses())
+            {
+                UpdateSkyViewParameters(viewState);
+                UpdateDynamicQualitySettings(viewState);
+                UpdateAsyncComputeSettings(viewState);
+                UpdateAttachmentSettings(viewState);
+                UpdateFusedCompositeSettings(viewState);
+                UpdateCloudShadowMapAttachment(viewState);
+            }
         }
     }
 
@@ -153,28 +454,1272 @@ namespace VolumetricClouds
     /////////////////////////////////////////////////////////////////////
 
 
-    void CloudscapeFeatureProcessor::ActivateInternal()
+    bool CloudscapeFeatureProcessor::ViewState::HasPasses() const
     {
-        auto viewportContextInterface = AZ::Interface<AZ::RPI::ViewportContextRequestsInterface>::Get();
-        auto viewportContext = viewportContextInterface->GetViewportContextByScene(GetParentScene());
-        m_viewportSize = viewportContext->GetViewportSize();
+        return m_cloudscapeComputePass && m_cloudscapeReprojectionPass && m_cloudscapeSkyViewPass && m_cloudscapeSunVisibilityPass &&
+               m_cloudscapeShadowMapPass && m_cloudscapeShadowMapBarrierPass && m_cloudscapeRenderPass;
+    }
+
+    AZStd::fixed_vector<CloudscapeRasterPass*, 2> CloudscapeFeatureProcessor::ViewState::GetRenderPasses() const
+    {
+        AZStd::fixed_vector<CloudscapeRasterPass*, 2> renderPasses;
+        for (CloudscapeRasterPass* renderPass : { m_cloudscapeRenderPass, m_cloudscapeFusedRenderPass })
+        {
+            if (renderPass)
+            {
+                renderPasses.push_back(renderPass);
+            }
+        }
+        return renderPasses;
+    }
 
-        m_cloudOutput0 = CreateCloudscapeOutputAttachment(AZ::Name("CloudscapeOutput0"), m_viewportSize);
-        AZ_Assert(!!m_cloudOutput0, "Failed to create CloudscapeOutput0");
-        m_cloudOutput1 = CreateCloudscapeOutputAttachment(AZ::Name("CloudscapeOutput1"), m_viewportSize);
-        AZ_Assert(!!m_cloudOutput1, "Failed to create CloudscapeOutput1");
+    void CloudscapeFeatureProcessor::ViewState::QueuePassesForRemoval() const
+    {
+        AZ::RPI::Pass* passes[] = { m_cloudscapeComputePass, m_cloudscapeSkyViewPass, m_cloudscapeSunVisibilityPass,
+            m_cloudscapeShadowMapPass, m_cloudscapeShadowMapBarrierPass, m_cloudscapeReprojectionPass, m_cloudscapeRenderPass,
+            m_cloudscapeFusedRenderPass, m_cloudscapeRayMarchDebugStatsReductionPass, m_cloudscapeStereoReprojectionPass };
+        for (AZ::RPI::Pass* pass : passes)
+        {
+            if (pass)
+            {
+                pass->QueueForRemoval();
+            }
+        }
+    }
 
+    void CloudscapeFeatureProcessor::ActivateInternal()
+    {
         DisableSceneNotification();
         EnableSceneNotification();
     }
 
+    CloudscapeFeatureProcessor::ViewState* CloudscapeFeatureProcessor::FindViewState(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        auto viewStateItor = m_viewStates.find(renderPipeline);
+        return (viewStateItor != m_viewStates.end()) ? viewStateItor->second.get() : nullptr;
+    }
 
-    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateCloudscapeOutputAttachment(const AZ::Name& attachmentName
-        , const AzFramework::WindowSize attachmentSize) const
+    void CloudscapeFeatureProcessor::RemoveViewState(ViewState& viewState)
     {
-        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
-            AZ::RHI::ImageBindFlags::ShaderReadWrite, attachmentSize.m_width, attachmentSize.m_height, AZ::RHI::Format::R8G8B8A8_UNORM);
-        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(0, 0, 0, 0);
+        if (viewState.m_rayMarchDebugReadback)
+        {
+            viewState.m_rayMarchDebugReadback->SetCallback(nullptr);
+            viewState.m_rayMarchDebugReadback = nullptr;
+        }
+        if (viewState.m_sunVisibilityReadback)
+        {
+            viewState.m_sunVisibilityReadback->SetCallback(nullptr);
+            viewState.m_sunVisibilityReadback = nullptr;
+        }
+    }
+
+    template<typename PassType>
+    PassType* CloudscapeFeatureProcessor::AddPass(AZ::RPI::RenderPipeline* renderPipeline, const char* passRequestAssetFilePath,
+        const char* passName, const char* referencePassName, bool beforeReferencePass)
+    {
+        AddPassRequestToRenderPipeline(renderPipeline, passRequestAssetFilePath, referencePassName, beforeReferencePass);
+        AZ::RPI::PassFilter passFilter = AZ::RPI::PassFilter::CreateWithPassName(AZ::Name(passName), renderPipeline);
+        AZ::RPI::Pass* existingPass = AZ::RPI::PassSystemInterface::Get()->FindFirstPass(passFilter);
+        PassType* pass = azrtti_cast<PassType*>(existingPass);
+        AZ_Error(LogName, !!pass, "%s Failed to find as RenderPass: %s", __FUNCTION__, passName);
+        return pass;
+    }
+
+    AzFramework::WindowSize CloudscapeFeatureProcessor::GetRenderPipelineSize(const AZ::RPI::RenderPipeline* renderPipeline)
+    {
+        AzFramework::WindowSize size{ 0, 0 };
+        const AzFramework::NativeWindowHandle windowHandle = renderPipeline->GetWindowHandle();
+        if (windowHandle)
+        {
+            AzFramework::WindowRequestBus::EventResult(size, windowHandle, &AzFramework::WindowRequests::GetRenderResolution);
+            return size;
+        }
+
+        // Render to texture pipelines (minimaps, security cameras, etc) have a fixed size.
+        const auto& renderSettings = renderPipeline->GetRenderSettings();
+        size.m_width = renderSettings.m_size.m_width;
+        size.m_height = renderSettings.m_size.m_height;
+        return size;
+    }
+
+    void CloudscapeFeatureProcessor::CreateViewSizedAttachments(ViewState& viewState) const
+    {
+        // The render pipeline, the size and the format are part of the names, otherwise the instance database
+        // would return the images of another view or of the previous size.
+        const char* renderPipelineName = viewState.m_renderPipeline->GetId().GetCStr();
+        const AzFramework::WindowSize size = viewState.m_size;
+        const bool isHdr = viewState.m_isHdrOutputEnabled;
+        const char* formatSuffix = isHdr ? "_Hdr" : "";
+        viewState.m_cloudOutput0 = CreateCloudscapeOutputAttachment(AZ::Name(AZStd::string::format("CloudscapeOutput0_%s_%ux%u%s",
+            renderPipelineName, size.m_width, size.m_height, formatSuffix)), size, isHdr);
+        AZ_Assert(!!viewState.m_cloudOutput0, "Failed to create CloudscapeOutput0");
+        // With compact history it only has one pixel per 4x4 block. The stereo reprojection only writes CloudscapeOutput0.
+        const AzFramework::WindowSize output1Size = viewState.m_isStereoTarget
+            ? AzFramework::WindowSize{ 1, 1 }
+            : viewState.m_isCompactHistoryEnabled
+                ? AzFramework::WindowSize{ (size.m_width + 3) / 4, (size.m_height + 3) / 4 }
+                : size;
+        viewState.m_cloudOutput1 = CreateCloudscapeOutputAttachment(AZ::Name(AZStd::string::format("CloudscapeOutput1_%s_%ux%u%s",
+            renderPipelineName, output1Size.m_width, output1Size.m_height, formatSuffix)), output1Size, isHdr);
+        AZ_Assert(!!viewState.m_cloudOutput1, "Failed to create CloudscapeOutput1");
+        const AzFramework::WindowSize cloudAlpha0Size = isHdr ? size : AzFramework::WindowSize{ 1, 1 };
+        const AzFramework::WindowSize cloudAlpha1Size = isHdr ? output1Size : AzFramework::WindowSize{ 1, 1 };
+        viewState.m_cloudAlpha0 = CreateR8UnormAttachment(AZ::Name(AZStd::string::format("CloudscapeCloudAlpha0_%s_%ux%u",
+            renderPipelineName, cloudAlpha0Size.m_width, cloudAlpha0Size.m_height)), cloudAlpha0Size);
+        AZ_Assert(!!viewState.m_cloudAlpha0, "Failed to create CloudscapeCloudAlpha0");
+        viewState.m_cloudAlpha1 = CreateR8UnormAttachment(AZ::Name(AZStd::string::format("CloudscapeCloudAlpha1_%s_%ux%u",
+            renderPipelineName, cloudAlpha1Size.m_width, cloudAlpha1Size.m_height)), cloudAlpha1Size);
+        AZ_Assert(!!viewState.m_cloudAlpha1, "Failed to create CloudscapeCloudAlpha1");
+        // Only the reprojection uses the confidence.
+        const AzFramework::WindowSize confidenceSize = viewState.m_isStereoTarget ? AzFramework::WindowSize{ 1, 1 } : size;
+        viewState.m_confidence0 = CreateR8UnormAttachment(AZ::Name(AZStd::string::format("CloudscapeConfidence0_%s_%ux%u",
+            renderPipelineName, confidenceSize.m_width, confidenceSize.m_height)), confidenceSize);
+        AZ_Assert(!!viewState.m_confidence0, "Failed to create CloudscapeConfidence0");
+        viewState.m_confidence1 = CreateR8UnormAttachment(AZ::Name(AZStd::string::format("CloudscapeConfidence1_%s_%ux%u",
+            renderPipelineName, confidenceSize.m_width, confidenceSize.m_height)), confidenceSize);
+        AZ_Assert(!!viewState.m_confidence1, "Failed to create CloudscapeConfidence1");
+
+        const AzFramework::WindowSize debugStatsSize = ((viewState.m_rayMarchDebugView != RayMarchDebugView::Disabled) && !viewState.m_isStereoTarget)
+            ? size
+            : AzFramework::WindowSize{ 1, 1 };
+        viewState.m_rayMarchDebugStats = CreateRayMarchDebugStatsAttachment(AZ::Name(AZStd::string::format("CloudscapeRayMarchDebugStats_%s_%ux%u",
+            renderPipelineName, debugStatsSize.m_width, debugStatsSize.m_height)), debugStatsSize);
+        AZ_Assert(!!viewState.m_rayMarchDebugStats, "Failed to create CloudscapeRayMarchDebugStats");
+
+        const AzFramework::WindowSize cloudDepthSize = (viewState.m_isCloudDepthEnabled && !viewState.m_isStereoTarget)
+            ? size
+            : AzFramework::WindowSize{ 1, 1 };
+        viewState.m_cloudDepth = CreateCloudDepthAttachment(AZ::Name(AZStd::string::format("CloudscapeCloudDepth_%s_%ux%u",
+            renderPipelineName, cloudDepthSize.m_width, cloudDepthSize.m_height)), cloudDepthSize);
+        AZ_Assert(!!viewState.m_cloudDepth, "Failed to create CloudscapeCloudDepth");
+    }
+
+    void CloudscapeFeatureProcessor::UpdateViewSize(ViewState& viewState)
+    {
+        const AzFramework::WindowSize size = GetRenderPipelineSize(viewState.m_renderPipeline);
+        // Minimized windows report a zero size.
+        if (!size.m_width || !size.m_height ||
+            ((size.m_width == viewState.m_size.m_width) && (size.m_height == viewState.m_size.m_height)))
+        {
+            return;
+        }
+
+        viewState.m_size = size;
+        CreateViewSizedAttachments(viewState);
+        // The history doesn't match the new size.
+        viewState.m_staticFrameCount = 0;
+
+        // CloudscapeComputePass binds the new attachments in BuildInternal(), and the passes connected
+        // to its slots need to be rebuilt to see them. The sky-view pass is not affected.
+        if (viewState.m_cloudscapeComputePass)
+        {
+            viewState.m_cloudscapeComputePass->QueueForBuildAndInitialization();
+        }
+        if (viewState.m_cloudscapeReprojectionPass)
+        {
+            viewState.m_cloudscapeReprojectionPass->QueueForBuildAndInitialization();
+            viewState.m_cloudscapeReprojectionPass->SetTargetThreadCounts(size.m_width, size.m_height, 1);
+        }
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->QueueForBuildAndInitialization();
+        }
+        if (viewState.m_cloudscapeRayMarchDebugStatsReductionPass)
+        {
+            viewState.m_cloudscapeRayMarchDebugStatsReductionPass->QueueForBuildAndInitialization();
+            const auto rayMarchDebugStatsSize = viewState.m_rayMarchDebugStats->GetDescriptor().m_size;
+            viewState.m_cloudscapeRayMarchDebugStatsReductionPass->SetTargetThreadCounts(
+                rayMarchDebugStatsSize.m_width, rayMarchDebugStatsSize.m_height, 1);
+        }
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            viewState.m_cloudscapeStereoReprojectionPass->QueueForBuildAndInitialization();
+        }
+    }
+
+    void CloudscapeFeatureProcessor::SimulateView(ViewState& viewState, bool isDefaultView)
+    {
+        UpdateViewSize(viewState);
+        UpdateStereoTargetState(viewState, false);
+        UpdateGpuQueries(viewState, isDefaultView);
+        UpdateRayMarchDebugView(viewState, isDefaultView);
+        UpdateSunVisibility(viewState, isDefaultView);
+        UpdateCloudShadowMap(viewState, isDefaultView);
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            // Stereo reprojection was disabled, or the left eye is gone.
+            viewState.m_cloudscapeStereoReprojectionPass->SetIdle(true);
+            viewState.m_stereoSourceOutput1 = nullptr;
+        }
+
+        const bool isConverged = UpdateConvergenceState(viewState);
+        viewState.m_cloudscapeComputePass->SetIdle(isConverged);
+        viewState.m_cloudscapeReprojectionPass->SetEnabled(!isConverged && !viewState.m_isFusedCompositeEnabled);
+        if (viewState.m_cloudscapeFusedRenderPass)
+        {
+            viewState.m_cloudscapeFusedRenderPass->SetReprojectionEnabled(!isConverged);
+        }
+        // Convergence requires at least 16 static frames, which is enough to refresh all the sky-view slices.
+        viewState.m_cloudscapeSkyViewPass->SetIdle(isConverged || !m_renderSettings.m_enableSkyView);
+        if (isConverged)
+        {
+            // The frame counter is not incremented, this way CloudscapeRasterPass
+            // keeps reading from the attachment written during the last active frame.
+            return;
+        }
+
+        UpdateDynamicQuality(viewState);
+
+        const uint32_t frameCounter = viewState.m_frameCounter;
+        viewState.m_cloudscapeComputePass->UpdateFrameCounter(frameCounter);
+        // Each accumulated sample requires 16 frames, one per pixel in the 4x4 block.
+        viewState.m_cloudscapeComputePass->UpdateAccumulatedSampleCount(viewState.m_staticFrameCount / 16);
+
+        const uint32_t pixelIndex4x4 = frameCounter % 16;
+        if (viewState.m_isFusedCompositeEnabled)
+        {
+            // The planet radius and the cloud slab distance come from UpdateSkyViewParameters().
+            const float cloudSlabThicknessKm = m_shaderConstantData ? m_shaderConstantData->m_cloudSlabThicknessKm : 0.0f;
+            viewState.m_cloudscapeFusedRenderPass->SetReprojectionParameters(pixelIndex4x4, GetFrameWindOffsetKm(), cloudSlabThicknessKm,
+                viewState.m_isCloudDepthEnabled, viewState.m_isCompactHistoryEnabled);
+        }
+        else
+        {
+            const auto& passSrg = viewState.m_cloudscapeReprojectionPass->GetShaderResourceGroup();
+            passSrg->SetConstant(m_pixelIndex4x4Index, pixelIndex4x4);
+            if (m_shaderConstantData)
+            {
+                passSrg->SetConstant(m_reprojectionPlanetRadiusKmIndex, m_shaderConstantData->m_planetRadiusKm);
+                passSrg->SetConstant(m_reprojectionCloudSlabDistanceAboveSeaLevelKmIndex, m_shaderConstantData->m_cloudSlabDistanceAboveSeaLevelKm);
+                passSrg->SetConstant(m_reprojectionCloudSlabThicknessKmIndex, m_shaderConstantData->m_cloudSlabThicknessKm);
+                passSrg->SetConstant(m_reprojectionWindOffsetKmIndex, GetFrameWindOffsetKm());
+            }
+            passSrg->SetConstant(m_reprojectionCloudDepthEnabledIndex, static_cast<uint32_t>(viewState.m_isCloudDepthEnabled));
+            passSrg->SetConstant(m_reprojectionCompactHistoryEnabledIndex, static_cast<uint32_t>(viewState.m_isCompactHistoryEnabled));
+            passSrg->SetConstant(m_reprojectionHdrOutputEnabledIndex, static_cast<uint32_t>(viewState.m_isHdrOutputEnabled));
+        }
+
+        viewState.m_outputTextureIndex = viewState.m_isCompactHistoryEnabled ? 0 : frameCounter % 2;
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->UpdateOutputTextureIndex(viewState.m_outputTextureIndex);
+        }
+
+        viewState.m_cloudscapeSkyViewPass->UpdateSlice(frameCounter, GetSkyViewSliceCount(viewState));
+
+        viewState.m_frameCounter++;
+        viewState.m_staticFrameCount++;
+    }
+
+
+    CloudscapeFeatureProcessor::ViewState* CloudscapeFeatureProcessor::FindStereoSourceViewState(const ViewState& viewState) const
+    {
+        if (!m_renderSettings.m_enableStereoReprojection || !viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            return nullptr;
+        }
+
+        // The stereo reprojection pass can only be ordered after the passes of the left eye when the frame graph
+        // sees them first, which requires the render pipeline of the left eye to be added to the scene first.
+        const auto& renderPipelines = GetParentScene()->GetRenderPipelines();
+        auto getRenderPipelineIndex = [&renderPipelines](const AZ::RPI::RenderPipeline* renderPipeline)
+        {
+            auto renderPipelineItor = AZStd::find_if(renderPipelines.begin(), renderPipelines.end(),
+                [renderPipeline](const AZ::RPI::RenderPipelinePtr& candidate) { return candidate.get() == renderPipeline; });
+            return AZStd::distance(renderPipelines.begin(), renderPipelineItor);
+        };
+        const auto renderPipelineIndex = getRenderPipelineIndex(viewState.m_renderPipeline);
+
+        for (const auto& viewStateItor : m_viewStates)
+        {
+            ViewState* sourceViewState = viewStateItor.second.get();
+            if (sourceViewState->HasPasses() && (sourceViewState->m_renderPipeline->GetViewType() == AZ::RPI::ViewType::XrLeft) &&
+                (getRenderPipelineIndex(sourceViewState->m_renderPipeline) < renderPipelineIndex))
+            {
+                return sourceViewState;
+            }
+        }
+        return nullptr;
+    }
+
+    const AZ::RPI::RenderPipeline* CloudscapeFeatureProcessor::GetStereoSourceRenderPipeline(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        const ViewState* sourceViewState = viewState ? FindStereoSourceViewState(*viewState) : nullptr;
+        return sourceViewState ? sourceViewState->m_renderPipeline : nullptr;
+    }
+
+    void CloudscapeFeatureProcessor::SimulateStereoSecondEye(ViewState& viewState, ViewState& sourceViewState)
+    {
+        UpdateViewSize(viewState);
+        UpdateStereoTargetState(viewState, true);
+        UpdateGpuQueries(viewState, false /*reportStats*/);
+        UpdateRayMarchDebugView(viewState, false /*reportTotals*/);
+
+        // The clouds of this eye are reprojected from the left eye, which was already simulated this frame.
+        // The sky-view texture is cheap and amortized, so it is still refreshed for this eye.
+        viewState.m_cloudscapeComputePass->SetIdle(true);
+        viewState.m_cloudscapeReprojectionPass->SetEnabled(false);
+        if (viewState.m_cloudscapeFusedRenderPass)
+        {
+            viewState.m_cloudscapeFusedRenderPass->SetReprojectionEnabled(false);
+        }
+        viewState.m_cloudscapeSkyViewPass->SetIdle(!m_renderSettings.m_enableSkyView);
+        viewState.m_staticFrameCount = 0;
+
+        auto* stereoPass = viewState.m_cloudscapeStereoReprojectionPass;
+        // The attachments of the left eye are recreated when its size or history storage changes.
+        if (viewState.m_stereoSourceOutput1 != sourceViewState.m_cloudOutput1)
+        {
+            viewState.m_stereoSourceOutput1 = sourceViewState.m_cloudOutput1;
+            stereoPass->QueueForBuildAndInitialization();
+        }
+        stereoPass->SetIdle(false);
+
+        const AZ::RPI::ViewPtr sourceView = sourceViewState.m_renderPipeline->GetDefaultView();
+        const AZ::Matrix4x4 sourceWorldToClipMatrix = sourceView ? sourceView->GetWorldToClipMatrix() : AZ::Matrix4x4::CreateIdentity();
+        const uint32_t frameCounter = viewState.m_frameCounter;
+        // There's no history to ping-pong with, the left eye is reprojected again each frame.
+        viewState.m_outputTextureIndex = 0;
+        stereoPass->UpdateSourceEye(sourceWorldToClipMatrix, sourceViewState.m_outputTextureIndex, viewState.m_outputTextureIndex);
+        stereoPass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->UpdateOutputTextureIndex(viewState.m_outputTextureIndex);
+        }
+        viewState.m_cloudscapeSkyViewPass->UpdateSlice(frameCounter, GetSkyViewSliceCount(viewState));
+
+        viewState.m_frameCounter++;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateStereoTargetState(ViewState& viewState, bool isStereoTarget)
+    {
+        if (viewState.m_isStereoTarget == isStereoTarget)
+        {
+            return;
+        }
+        viewState.m_isStereoTarget = isStereoTarget;
+
+        CreateViewSizedAttachments(viewState);
+        // The history of this view is stale, or gone.
+        viewState.m_staticFrameCount = 0;
+        viewState.m_cloudscapeComputePass->QueueForBuildAndInitialization();
+        viewState.m_cloudscapeReprojectionPass->QueueForBuildAndInitialization();
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->QueueForBuildAndInitialization();
+        }
+        if (viewState.m_cloudscapeRayMarchDebugStatsReductionPass)
+        {
+            const auto rayMarchDebugStatsSize = viewState.m_rayMarchDebugStats->GetDescriptor().m_size;
+            viewState.m_cloudscapeRayMarchDebugStatsReductionPass->QueueForBuildAndInitialization();
+            viewState.m_cloudscapeRayMarchDebugStatsReductionPass->SetTargetThreadCounts(
+                rayMarchDebugStatsSize.m_width, rayMarchDebugStatsSize.m_height, 1);
+        }
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            viewState.m_cloudscapeStereoReprojectionPass->QueueForBuildAndInitialization();
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdateSkyViewParameters(ViewState& viewState)
+    {
+        const float skyViewStartDistanceKm = m_renderSettings.m_enableSkyView
+            ? AZStd::max(m_renderSettings.m_skyViewStartDistanceKm, 0.0f)
+            : 0.0f;
+        viewState.m_cloudscapeComputePass->SetSkyViewStartDistanceKm(skyViewStartDistanceKm);
+        viewState.m_cloudscapeSkyViewPass->SetSkyViewStartDistanceKm(skyViewStartDistanceKm);
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            viewState.m_cloudscapeStereoReprojectionPass->SetSkyViewStartDistanceKm(skyViewStartDistanceKm);
+        }
+        if (m_shaderConstantData)
+        {
+            for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+            {
+                renderPass->UpdateSkyViewParameters(skyViewStartDistanceKm,
+                    m_shaderConstantData->m_planetRadiusKm, m_shaderConstantData->m_cloudSlabDistanceAboveSeaLevelKm);
+            }
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdateAsyncComputeSettings(ViewState& viewState)
+    {
+        // The sky-view pass reads nothing from the graphics queue, so it always moves together with the ray march.
+        viewState.m_cloudscapeComputePass->SetAsyncComputeEnabled(m_renderSettings.m_enableAsyncCompute);
+        viewState.m_cloudscapeSkyViewPass->SetAsyncComputeEnabled(m_renderSettings.m_enableAsyncCompute);
+    }
+
+    void CloudscapeFeatureProcessor::UpdateFusedCompositeSettings(ViewState& viewState)
+    {
+        // The compact history is updated in place, which a pixel shader can't do without racing
+        // with the other pixels. Only the reprojection compute pass supports it.
+        const bool useFusedComposite = m_renderSettings.m_enableFusedComposite && !viewState.m_isCompactHistoryEnabled;
+        if (useFusedComposite && !viewState.m_cloudscapeFusedRenderPass)
+        {
+            viewState.m_cloudscapeFusedRenderPass = AddPass<CloudscapeRasterPass>(viewState.m_renderPipeline,
+                "Passes/CloudscapeFusedRasterPassRequest.azasset", "CloudscapeFusedRasterPass", "TransparentPass", true /*before*/);
+            if (auto* fusedRenderPass = viewState.m_cloudscapeFusedRenderPass)
+            {
+                // Same state as m_cloudscapeRenderPass. The reprojection parameters are set each frame by SimulateView().
+                fusedRenderPass->SetEnabled(true);
+                fusedRenderPass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+                fusedRenderPass->UpdateOutputTextureIndex(viewState.m_outputTextureIndex);
+                fusedRenderPass->SetRayMarchDebugView(static_cast<uint32_t>(viewState.m_rayMarchDebugView),
+                    GetRayMarchDebugMaxValue(viewState.m_rayMarchDebugView));
+                UpdateSkyViewParameters(viewState);
+            }
+        }
+        else if (!useFusedComposite && viewState.m_cloudscapeFusedRenderPass)
+        {
+            viewState.m_cloudscapeFusedRenderPass->QueueForRemoval();
+            viewState.m_cloudscapeFusedRenderPass = nullptr;
+        }
+
+        // Falls back to the reprojection and composite passes when the fused pass couldn't be added.
+        // The reprojection compute pass is enabled each frame by SimulateView().
+        viewState.m_isFusedCompositeEnabled = viewState.m_cloudscapeFusedRenderPass != nullptr;
+        viewState.m_cloudscapeRenderPass->SetEnabled(!viewState.m_isFusedCompositeEnabled);
+    }
+
+    void CloudscapeFeatureProcessor::UpdateWindOffset()
+    {
+        m_prevWindOffsetKm = m_windOffsetKm;
+        if (m_shaderConstantData)
+        {
+            // Integrated here instead of multiplying the time by the wind speed in the shaders,
+            // so the clouds don't jump when the wind speed changes or is animated.
+            float deltaTime = 0.0f;
+            AZ::TickRequestBus::BroadcastResult(deltaTime, &AZ::TickRequests::GetTickDeltaTime);
+            m_windOffsetKm += m_shaderConstantData->GetWindVelocityKmPerSec() * deltaTime;
+        }
+
+        {
+            AZStd::scoped_lock lock(m_densitySamplerMutex);
+            m_densitySamplerWindOffsetKm = m_windOffsetKm;
+        }
+
+        for (auto& viewStateItor : m_viewStates)
+        {
+            ViewState& viewState = *viewStateItor.second;
+            if (!viewState.HasPasses())
+            {
+                continue;
+            }
+            viewState.m_cloudscapeComputePass->UpdateWindOffsetKm(m_windOffsetKm);
+            viewState.m_cloudscapeSkyViewPass->UpdateWindOffsetKm(m_windOffsetKm);
+            viewState.m_cloudscapeSunVisibilityPass->UpdateWindOffsetKm(m_windOffsetKm);
+            viewState.m_cloudscapeShadowMapPass->UpdateWindOffsetKm(m_windOffsetKm);
+            if (viewState.m_cloudscapeStereoReprojectionPass)
+            {
+                viewState.m_cloudscapeStereoReprojectionPass->UpdateWindOffsetKm(m_windOffsetKm);
+            }
+        }
+    }
+
+    AZ::Vector3 CloudscapeFeatureProcessor::GetFrameWindOffsetKm() const
+    {
+        return m_windOffsetKm - m_prevWindOffsetKm;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateDensitySampler(const CloudscapeShaderConstantData& shaderData)
+    {
+        const AZStd::array<const AZ::RPI::Image*, 3> images = {
+            shaderData.m_lowFrequencyNoiseTexture.get(),
+            shaderData.m_highFrequencyNoiseTexture.get(),
+            shaderData.m_weatherMap.get()
+        };
+        bool imagesChanged = false;
+        for (size_t imageIndex = 0; imageIndex < images.size(); ++imageIndex)
+        {
+            // The CPU copy is taken from the most detailed mip that is loaded, which changes as the image streams in or out.
+            const AZ::RHI::Image* rhiImage = images[imageIndex] ? images[imageIndex]->GetRHIImage() : nullptr;
+            const uint32_t residentMip = rhiImage ? rhiImage->GetResidentMipLevel() : 0;
+            if ((images[imageIndex] == m_densitySamplerImages[imageIndex]) && (residentMip == m_densitySamplerResidentMips[imageIndex]))
+            {
+                continue;
+            }
+            imagesChanged = true;
+            m_densitySamplerImages[imageIndex] = images[imageIndex];
+            m_densitySamplerResidentMips[imageIndex] = residentMip;
+            m_cpuTextures[imageIndex] = CloudCpuTexture::CreateFromImage(images[imageIndex]);
+            AZ_Warning(LogName, !images[imageIndex] || CloudCpuTexture::CanBeCreatedFromImage(images[imageIndex]),
+                "The CPU cloud queries need textures loaded from R8G8B8A8 or B8G8R8A8 streaming image assets. "
+                "Use a CloudTextureAssetComponent instead of generating the noise textures at runtime.");
+        }
+
+        // @m_cloudQueryStatus is only written by this function, so reading it here doesn't need the lock.
+        CloudQueryStatus cloudQueryStatus = CloudQueryStatus::Ready;
+        for (size_t imageIndex = 0; imageIndex < images.size(); ++imageIndex)
+        {
+            if (images[imageIndex] && !CloudCpuTexture::CanBeCreatedFromImage(images[imageIndex]))
+            {
+                cloudQueryStatus = CloudQueryStatus::Unsupported;
+                break;
+            }
+            if (!m_cpuTextures[imageIndex])
+            {
+                cloudQueryStatus = CloudQueryStatus::NotReady;
+            }
+        }
+        if (cloudQueryStatus != m_cloudQueryStatus)
+        {
+            AZStd::scoped_lock lock(m_densitySamplerMutex);
+            m_cloudQueryStatus = cloudQueryStatus;
+        }
+
+        // Animating the sun, or the wind speed, doesn't change the densities.
+        if (m_densitySampler && !imagesChanged && CloudDensitySampler::AreInputsEqual(m_densitySamplerShaderData, shaderData))
+        {
+            return;
+        }
+        m_densitySamplerShaderData = shaderData;
+
+        AZStd::shared_ptr<const CloudDensitySampler> densitySampler = AZStd::make_shared<CloudDensitySampler>(shaderData, m_cpuTextures[0], m_cpuTextures[1], m_cpuTextures[2]);
+        AZStd::scoped_lock lock(m_densitySamplerMutex);
+        m_densitySampler = AZStd::move(densitySampler);
+    }
+
+    AZStd::shared_ptr<const CloudDensitySampler> CloudscapeFeatureProcessor::GetDensitySampler() const
+    {
+        AZStd::scoped_lock lock(m_densitySamplerMutex);
+        return m_densitySampler;
+    }
+
+    AZ::Vector3 CloudscapeFeatureProcessor::GetDensitySamplerWindOffsetKm() const
+    {
+        AZStd::scoped_lock lock(m_densitySamplerMutex);
+        return m_densitySamplerWindOffsetKm;
+    }
+
+    void CloudscapeFeatureProcessor::RunQueryBatches(size_t itemCount, size_t batchSize, const AZStd::function<void(size_t, size_t)>& batchFunction)
+    {
+        // Small queries are not worth the overhead of the job system.
+        if (itemCount <= batchSize)
+        {
+            batchFunction(0, itemCount);
+            return;
+        }
+
+        AZ::JobCompletion jobCompletion;
+        for (size_t firstItem = 0; firstItem < itemCount; firstItem += batchSize)
+        {
+            const size_t batchItemCount = AZStd::min(batchSize, itemCount - firstItem);
+            AZ::Job* job = AZ::CreateJobFunction([&batchFunction, firstItem, batchItemCount]()
+                {
+                    batchFunction(firstItem, batchItemCount);
+                }, true);
+            job->SetDependent(&jobCompletion);
+            job->Start();
+        }
+        jobCompletion.StartAndWaitForCompletion();
+    }
+
+    void CloudscapeFeatureProcessor::UpdateAnimatedShaderConstantData()
+    {
+        const bool hasNewShaderData = m_stagedShaderConstantData.Publish();
+        const bool hasNewTracks = m_stagedParameterTracks.Publish();
+        if (hasNewTracks)
+        {
+            m_parameterAnimator.SetTracks(m_stagedParameterTracks.GetPublished());
+        }
+
+        // Nothing to send to the passes until the controller stages the first data.
+        if (!hasNewShaderData && !m_shaderConstantData)
+        {
+            return;
+        }
+
+        // Start over from the controller's data, so the parameters that are no longer
+        // animated go back to their set value.
+        const bool reapplyAll = hasNewShaderData || hasNewTracks;
+        if (reapplyAll)
+        {
+            m_animatedShaderConstantData = m_stagedShaderConstantData.GetPublished();
+        }
+
+        bool isAnimated = false;
+        if (m_parameterAnimator.HasTracks())
+        {
+            float deltaTime = 0.0f;
+            AZ::TickRequestBus::BroadcastResult(deltaTime, &AZ::TickRequests::GetTickDeltaTime);
+            isAnimated = m_parameterAnimator.Update(deltaTime, reapplyAll, m_animatedShaderConstantData);
+        }
+
+        if (reapplyAll || isAnimated)
+        {
+            UpdatePhaseFunctionLut(m_animatedShaderConstantData);
+            UpdateSkyIrradiance(m_animatedShaderConstantData);
+            UpdateShaderConstantData(m_animatedShaderConstantData);
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdatePhaseFunctionLut(CloudscapeShaderConstantData& shaderData)
+    {
+        if (!m_phaseFunctionLut || (m_phaseFunctionLutMaterialProperties != shaderData.m_cloudMaterialProperties))
+        {
+            m_phaseFunctionLut = CloudPhaseFunctionLut::CreateImage(shaderData.m_cloudMaterialProperties);
+            m_phaseFunctionLutMaterialProperties = shaderData.m_cloudMaterialProperties;
+            AZ_Error(LogName, m_phaseFunctionLut, "Failed to create the phase function lookup table. The clouds won't be rendered.");
+        }
+        shaderData.m_phaseFunctionLut = m_phaseFunctionLut;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateSkyIrradiance(CloudscapeShaderConstantData& shaderData)
+    {
+        const float cloudSlabTopKm = shaderData.m_cloudSlabDistanceAboveSeaLevelKm + shaderData.m_cloudSlabThicknessKm;
+        const float minSunDirectionCos = cosf(AZ::DegToRad(SkyIrradianceSunAngleThresholdDegrees));
+        const bool isUpToDate = m_isSkyIrradianceValid &&
+            (m_skyIrradianceSunDirection.Dot(shaderData.m_directionTowardsTheSun) >= minSunDirectionCos) &&
+            (m_skyIrradiancePlanetRadiusKm == shaderData.m_planetRadiusKm) &&
+            (m_skyIrradianceCloudSlabTopKm == cloudSlabTopKm);
+        if (!isUpToDate)
+        {
+            m_skyIrradiance = CloudSkyIrradiance::Calculate(shaderData.m_directionTowardsTheSun, shaderData.m_planetRadiusKm, cloudSlabTopKm);
+            m_isSkyIrradianceValid = true;
+            m_skyIrradianceSunDirection = shaderData.m_directionTowardsTheSun;
+            m_skyIrradiancePlanetRadiusKm = shaderData.m_planetRadiusKm;
+            m_skyIrradianceCloudSlabTopKm = cloudSlabTopKm;
+        }
+        shaderData.m_skyIrradiance = m_skyIrradiance;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateAttachmentSettings(ViewState& viewState)
+    {
+        if ((viewState.m_isCloudDepthEnabled == m_renderSettings.m_enableCloudDepthOutput) &&
+            (viewState.m_isCompactHistoryEnabled == m_renderSettings.m_enableCompactHistory) &&
+            (viewState.m_isHdrOutputEnabled == m_renderSettings.m_enableHdrOutput))
+        {
+            return;
+        }
+        viewState.m_isCloudDepthEnabled = m_renderSettings.m_enableCloudDepthOutput;
+        viewState.m_isCompactHistoryEnabled = m_renderSettings.m_enableCompactHistory;
+        viewState.m_isHdrOutputEnabled = m_renderSettings.m_enableHdrOutput;
+
+        // The other attachments keep their names, so they are not recreated and keep the history.
+        CreateViewSizedAttachments(viewState);
+        viewState.m_cloudscapeComputePass->SetCloudDepthEnabled(viewState.m_isCloudDepthEnabled);
+        viewState.m_cloudscapeComputePass->SetCompactHistoryEnabled(viewState.m_isCompactHistoryEnabled);
+        viewState.m_cloudscapeComputePass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+        viewState.m_cloudscapeComputePass->QueueForBuildAndInitialization();
+        viewState.m_cloudscapeReprojectionPass->QueueForBuildAndInitialization();
+        for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+        {
+            renderPass->SetHdrOutputEnabled(viewState.m_isHdrOutputEnabled);
+            renderPass->QueueForBuildAndInitialization();
+        }
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            viewState.m_cloudscapeStereoReprojectionPass->QueueForBuildAndInitialization();
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdateDynamicQualitySettings(ViewState& viewState)
+    {
+        if (!m_renderSettings.m_enableDynamicQuality)
+        {
+            viewState.m_qualityController.Reset();
+        }
+        ApplyQualityLevel(viewState);
+    }
+
+    void CloudscapeFeatureProcessor::UpdateGpuQueries(ViewState& viewState, bool reportStats)
+    {
+        const bool collectStats = VolumetricCloudsStatsCollector::IsCollecting();
+        const bool enableTimestamps = (collectStats && reportStats) || m_renderSettings.m_enableDynamicQuality;
+        AZ::RPI::Pass* passes[] = { viewState.m_cloudscapeComputePass, viewState.m_cloudscapeSkyViewPass,
+            viewState.m_cloudscapeReprojectionPass, viewState.m_cloudscapeRenderPass, viewState.m_cloudscapeFusedRenderPass };
+        for (AZ::RPI::Pass* pass : passes)
+        {
+            if (!pass)
+            {
+                continue;
+            }
+            pass->SetTimestampQueryEnabled(enableTimestamps);
+            pass->SetPipelineStatisticsQueryEnabled(collectStats && reportStats);
+        }
+
+        auto statsCollector = VolumetricCloudsStatsCollector::Get();
+        if (!collectStats || !reportStats || !statsCollector)
+        {
+            return;
+        }
+
+        // Results of passes that were not dispatched are stale.
+        auto addGpuPassSample = [statsCollector](StatsScope scope, const AZ::RPI::Pass* pass)
+        {
+            if (pass && pass->IsEnabled())
+            {
+                statsCollector->AddGpuPassSample(scope, *pass);
+            }
+        };
+        addGpuPassSample(StatsScope::CloudscapeComputeGpu, viewState.m_cloudscapeComputePass);
+        addGpuPassSample(StatsScope::CloudscapeSkyViewGpu, viewState.m_cloudscapeSkyViewPass);
+        addGpuPassSample(StatsScope::CloudscapeReprojectionGpu, viewState.m_cloudscapeReprojectionPass);
+        addGpuPassSample(StatsScope::CloudscapeRasterGpu, viewState.m_cloudscapeRenderPass);
+        addGpuPassSample(StatsScope::CloudscapeFusedRasterGpu, viewState.m_cloudscapeFusedRenderPass);
+    }
+
+    void CloudscapeFeatureProcessor::UpdateDynamicQuality(ViewState& viewState)
+    {
+        if (!m_renderSettings.m_enableDynamicQuality)
+        {
+            return;
+        }
+        if (IsBenchmarkRunning())
+        {
+            // Also discards the smoothed GPU time, so the quality level starts over once the benchmark ends.
+            const bool wasHighestQuality = (viewState.m_qualityController.GetQualityLevelIndex() == 0);
+            viewState.m_qualityController.Reset();
+            if (!wasHighestQuality)
+            {
+                ApplyQualityLevel(viewState);
+                viewState.m_staticFrameCount = 0;
+            }
+            return;
+        }
+
+        // Timestamps of passes that were not dispatched are stale.
+        auto getGpuTimeMs = [](const AZ::RPI::Pass* pass) -> float
+        {
+            if (!pass || !pass->IsEnabled())
+            {
+                return 0.0f;
+            }
+            return static_cast<float>(pass->GetLatestTimestampResult().GetDurationInNanoseconds()) * 1.0e-6f;
+        };
+        const float gpuTimeMs = getGpuTimeMs(viewState.m_cloudscapeComputePass) +
+                                getGpuTimeMs(viewState.m_cloudscapeSkyViewPass) +
+                                getGpuTimeMs(viewState.m_cloudscapeReprojectionPass) +
+                                getGpuTimeMs(viewState.m_cloudscapeFusedRenderPass);
+
+        if (viewState.m_qualityController.Update(gpuTimeMs, m_renderSettings.m_gpuBudgetMs))
+        {
+            AZ_Info(LogName, "Cloud quality level of render pipeline %s changed to %u. Smoothed GPU time %.3fms, budget %.3fms.",
+                viewState.m_renderPipeline->GetId().GetCStr(), viewState.m_qualityController.GetQualityLevelIndex(),
+                viewState.m_qualityController.GetSmoothedGpuTimeMs(), m_renderSettings.m_gpuBudgetMs);
+            ApplyQualityLevel(viewState);
+            // The image changes with the quality level.
+            viewState.m_staticFrameCount = 0;
+        }
+    }
+
+    bool CloudscapeFeatureProcessor::IsBenchmarkRunning()
+    {
+        auto statsCollector = VolumetricCloudsStatsCollector::Get();
+        return statsCollector && statsCollector->IsBenchmarkRunning();
+    }
+
+    void CloudscapeFeatureProcessor::ApplyQualityLevel(ViewState& viewState)
+    {
+        const auto& qualityLevel = viewState.m_qualityController.GetQualityLevel();
+        viewState.m_cloudscapeComputePass->SetQualityParameters(qualityLevel.m_rayMarchingStepsScale, qualityLevel.m_mipLevelBias);
+        viewState.m_cloudscapeSkyViewPass->SetQualityParameters(qualityLevel.m_rayMarchingStepsScale, qualityLevel.m_mipLevelBias);
+        if (viewState.m_cloudscapeStereoReprojectionPass)
+        {
+            viewState.m_cloudscapeStereoReprojectionPass->SetQualityParameters(qualityLevel.m_rayMarchingStepsScale, qualityLevel.m_mipLevelBias);
+        }
+    }
+
+    uint32_t CloudscapeFeatureProcessor::GetSkyViewSliceCount(const ViewState& viewState) const
+    {
+        const uint32_t sliceCount = m_renderSettings.m_skyViewSliceCount * viewState.m_qualityController.GetQualityLevel().m_skyViewSliceCountMultiplier;
+        return AZStd::clamp(sliceCount, 1u, 16u);
+    }
+
+    float CloudscapeFeatureProcessor::GetRayMarchDebugMaxValue(RayMarchDebugView rayMarchDebugView) const
+    {
+        // The heatmap is normalized by the worst case of each counter.
+        // Each primary step does at most NUM_LIGHT_SAMPLES (CloudscapeCS.azsl) light samples.
+        static constexpr float NumLightSamples = 6.0f;
+        const float maxSteps = m_shaderConstantData ? static_cast<float>(m_shaderConstantData->m_maxRayMarchingSteps) : 64.0f;
+        float maxValue = 1.0f;
+        switch (rayMarchDebugView)
+        {
+        case RayMarchDebugView::PrimarySteps:
+        case RayMarchDebugView::ExpensiveDensityCalls:
+            maxValue = maxSteps;
+            break;
+        case RayMarchDebugView::LightSamples:
+            maxValue = maxSteps * NumLightSamples;
+            break;
+        case RayMarchDebugView::CheapDensityCalls:
+            maxValue = maxSteps * (NumLightSamples + 1.0f);
+            break;
+        default:
+            break;
+        }
+        return AZStd::max(maxValue, 1.0f);
+    }
+
+    void CloudscapeFeatureProcessor::UpdateRayMarchDebugView(ViewState& viewState, bool reportTotals)
+    {
+        const uint32_t cvarValue = r_volumetricCloudsRayMarchDebugView;
+        const auto rayMarchDebugView = (cvarValue < static_cast<uint32_t>(RayMarchDebugView::Count))
+            ? static_cast<RayMarchDebugView>(cvarValue)
+            : RayMarchDebugView::Disabled;
+        const bool isEnabled = rayMarchDebugView != RayMarchDebugView::Disabled;
+
+        if (rayMarchDebugView != viewState.m_rayMarchDebugView)
+        {
+            const bool wasEnabled = viewState.m_rayMarchDebugView != RayMarchDebugView::Disabled;
+            viewState.m_rayMarchDebugView = rayMarchDebugView;
+
+            // Switching between two debug views doesn't change the attachment.
+            if (isEnabled != wasEnabled)
+            {
+                CreateViewSizedAttachments(viewState);
+                const auto imageSize = viewState.m_rayMarchDebugStats->GetDescriptor().m_size;
+                viewState.m_cloudscapeComputePass->SetRayMarchDebugStatsEnabled(isEnabled);
+                viewState.m_cloudscapeComputePass->QueueForBuildAndInitialization();
+                viewState.m_cloudscapeReprojectionPass->QueueForBuildAndInitialization();
+                for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+                {
+                    renderPass->QueueForBuildAndInitialization();
+                }
+                if (viewState.m_cloudscapeRayMarchDebugStatsReductionPass)
+                {
+                    viewState.m_cloudscapeRayMarchDebugStatsReductionPass->QueueForBuildAndInitialization();
+                    viewState.m_cloudscapeRayMarchDebugStatsReductionPass->SetTargetThreadCounts(imageSize.m_width, imageSize.m_height, 1);
+                    viewState.m_cloudscapeRayMarchDebugStatsReductionPass->SetEnabled(isEnabled);
+                }
+                if (!isEnabled && reportTotals)
+                {
+                    if (auto statsCollector = VolumetricCloudsStatsCollector::Get())
+                    {
+                        statsCollector->SetRayMarchTotals(nullptr);
+                    }
+                }
+            }
+
+            const float maxValue = GetRayMarchDebugMaxValue(rayMarchDebugView);
+            for (CloudscapeRasterPass* renderPass : viewState.GetRenderPasses())
+            {
+                renderPass->SetRayMarchDebugView(static_cast<uint32_t>(rayMarchDebugView), maxValue);
+            }
+
+            // The converged image doesn't have the counters.
+            viewState.m_staticFrameCount = 0;
+        }
+
+        if (!isEnabled || !reportTotals || viewState.m_isRayMarchDebugReadbackPending ||
+            !viewState.m_cloudscapeRayMarchDebugStatsReductionPass)
+        {
+            return;
+        }
+
+        if (!viewState.m_rayMarchDebugReadback)
+        {
+            viewState.m_rayMarchDebugReadback = AZStd::make_shared<AZ::RPI::AttachmentReadback>(
+                AZ::RHI::ScopeId{ "CloudscapeRayMarchDebugTotalsReadback" });
+            // The readback can complete after this feature processor or the view state are gone, so the callback
+            // doesn't capture the former and only holds a weak reference to the latter.
+            AZStd::weak_ptr<ViewState> weakViewState = m_viewStates[viewState.m_renderPipeline];
+            viewState.m_rayMarchDebugReadback->SetCallback([weakViewState](const AZ::RPI::AttachmentReadback::ReadbackResult& result)
+                {
+                    if (auto viewStatePtr = weakViewState.lock())
+                    {
+                        OnRayMarchDebugTotalsReadback(*viewStatePtr, result);
+                    }
+                });
+        }
+
+        viewState.m_isRayMarchDebugReadbackPending = true;
+        if (!viewState.m_cloudscapeRayMarchDebugStatsReductionPass->ReadbackAttachment(viewState.m_rayMarchDebugReadback, 0,
+            AZ::Name("Totals"), AZ::RPI::PassAttachmentReadbackOption::Output))
+        {
+            viewState.m_isRayMarchDebugReadbackPending = false;
+        }
+    }
+
+    void CloudscapeFeatureProcessor::OnRayMarchDebugTotalsReadback(ViewState& viewState, const AZ::RPI::AttachmentReadback::ReadbackResult& result)
+    {
+        // The order of the counters must match RAY_MARCH_TOTALS_* in CloudscapeRayMarchDebugStats.azsli.
+        // Each counter is written as two uints, low bits first.
+        static constexpr size_t TotalsCount = 8;
+        if ((result.m_state == AZ::RPI::AttachmentReadback::ReadbackState::Success) && result.m_dataBuffer &&
+            (result.m_dataBuffer->size() >= TotalsCount * 2 * sizeof(uint32_t)))
+        {
+            uint32_t counterBits[TotalsCount * 2];
+            memcpy(counterBits, result.m_dataBuffer->data(), sizeof(counterBits));
+            uint64_t counters[TotalsCount];
+            for (size_t counterIndex = 0; counterIndex < TotalsCount; ++counterIndex)
+            {
+                counters[counterIndex] = (static_cast<uint64_t>(counterBits[counterIndex * 2 + 1]) << 32) | counterBits[counterIndex * 2];
+            }
+
+            VolumetricCloudsRayMarchTotals totals;
+            totals.m_pixelCount = counters[0];
+            totals.m_primarySteps = counters[1];
+            totals.m_lightSamples = counters[2];
+            totals.m_expensiveDensityCalls = counters[3];
+            totals.m_cheapDensityCalls = counters[4];
+            totals.m_notRayMarchedPixels = counters[5];
+            totals.m_endOfSlabPixels = counters[6];
+            totals.m_earlyExitPixels = counters[7];
+            if (auto statsCollector = VolumetricCloudsStatsCollector::Get())
+            {
+                statsCollector->SetRayMarchTotals(&totals);
+            }
+        }
+        viewState.m_isRayMarchDebugReadbackPending = false;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateSunVisibility(ViewState& viewState, bool isDefaultView)
+    {
+        CloudscapeSunVisibilityComputePass* sunVisibilityPass = viewState.m_cloudscapeSunVisibilityPass;
+        if (!isDefaultView)
+        {
+            sunVisibilityPass->SetIdle(true);
+            // The positions are sent again if this becomes the default view.
+            viewState.m_sunVisibilityPositionsVersion = 0;
+            return;
+        }
+
+        {
+            AZStd::scoped_lock lock(m_sunVisibility->m_mutex);
+            if (viewState.m_sunVisibilityPositionsVersion != m_sunVisibility->m_positionsVersion)
+            {
+                sunVisibilityPass->SetPositions(m_sunVisibility->m_positions);
+                viewState.m_sunVisibilityPositionsVersion = m_sunVisibility->m_positionsVersion;
+            }
+        }
+
+        // Only one readback in flight. The results of the frames dispatched in between are not read.
+        if (!sunVisibilityPass->IsEnabled() || viewState.m_isSunVisibilityReadbackPending)
+        {
+            return;
+        }
+
+        if (!viewState.m_sunVisibilityReadback)
+        {
+            viewState.m_sunVisibilityReadback = AZStd::make_shared<AZ::RPI::AttachmentReadback>(
+                AZ::RHI::ScopeId{ "CloudscapeSunVisibilityReadback" });
+            // Same as the ray march totals readback, the callback only holds weak references.
+            AZStd::weak_ptr<ViewState> weakViewState = m_viewStates[viewState.m_renderPipeline];
+            AZStd::weak_ptr<SunVisibilityState> weakSunVisibility = m_sunVisibility;
+            viewState.m_sunVisibilityReadback->SetCallback([weakViewState, weakSunVisibility](
+                const AZ::RPI::AttachmentReadback::ReadbackResult& result)
+                {
+                    auto viewStatePtr = weakViewState.lock();
+                    auto sunVisibilityPtr = weakSunVisibility.lock();
+                    if (viewStatePtr && sunVisibilityPtr)
+                    {
+                        OnSunVisibilityReadback(*viewStatePtr, *sunVisibilityPtr, result);
+                    }
+                });
+        }
+
+        viewState.m_sunVisibilityReadbackPositionCount = sunVisibilityPass->GetPositionCount();
+        viewState.m_isSunVisibilityReadbackPending = true;
+        if (!sunVisibilityPass->ReadbackAttachment(viewState.m_sunVisibilityReadback, 0,
+            AZ::Name("SunTransmittance"), AZ::RPI::PassAttachmentReadbackOption::Output))
+        {
+            viewState.m_isSunVisibilityReadbackPending = false;
+        }
+    }
+
+    void CloudscapeFeatureProcessor::OnSunVisibilityReadback(ViewState& viewState, SunVisibilityState& sunVisibility,
+        const AZ::RPI::AttachmentReadback::ReadbackResult& result)
+    {
+        const uint32_t positionCount = viewState.m_sunVisibilityReadbackPositionCount;
+        if ((result.m_state == AZ::RPI::AttachmentReadback::ReadbackState::Success) && result.m_dataBuffer &&
+            (result.m_dataBuffer->size() >= positionCount * sizeof(float)))
+        {
+            AZStd::scoped_lock lock(sunVisibility.m_mutex);
+            // The positions may have been cleared while the readback was in flight.
+            if (!sunVisibility.m_positions.empty())
+            {
+                sunVisibility.m_results.resize(positionCount);
+                memcpy(sunVisibility.m_results.data(), result.m_dataBuffer->data(), positionCount * sizeof(float));
+            }
+        }
+        viewState.m_isSunVisibilityReadbackPending = false;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateCloudShadowMapAttachment(ViewState& viewState)
+    {
+        const uint32_t resolution = m_renderSettings.m_enableCloudShadowMap
+            ? AZStd::clamp(m_renderSettings.m_cloudShadowMapResolution, MinCloudShadowMapResolution, MaxCloudShadowMapResolution)
+            : 1;
+        if (viewState.m_cloudShadowMap && (viewState.m_cloudShadowMap->GetDescriptor().m_size.m_width == resolution))
+        {
+            return;
+        }
+
+        // The resolution is part of the name, otherwise the instance database would return the image of the previous resolution.
+        viewState.m_cloudShadowMap = CreateCloudShadowMapAttachment(AZ::Name(AZStd::string::format("CloudscapeShadowMap_%s_%u",
+            viewState.m_renderPipeline->GetId().GetCStr(), resolution)), resolution);
+        AZ_Assert(!!viewState.m_cloudShadowMap, "Failed to create CloudscapeShadowMap");
+        viewState.m_isCloudShadowMapValid = false;
+        // Both passes attach the new image in BuildInternal().
+        if (viewState.m_cloudscapeShadowMapPass)
+        {
+            viewState.m_cloudscapeShadowMapPass->QueueForBuildAndInitialization();
+        }
+        if (viewState.m_cloudscapeShadowMapBarrierPass)
+        {
+            viewState.m_cloudscapeShadowMapBarrierPass->QueueForBuildAndInitialization();
+        }
+    }
+
+    void CloudscapeFeatureProcessor::UpdateCloudShadowMap(ViewState& viewState, bool isDefaultView)
+    {
+        CloudscapeShadowMapComputePass* shadowMapPass = viewState.m_cloudscapeShadowMapPass;
+        shadowMapPass->SetIdle(true);
+        if (!isDefaultView)
+        {
+            // The shadow map is rendered again if this becomes the default view.
+            viewState.m_isCloudShadowMapValid = false;
+            return;
+        }
+
+        // The Scene SRG always gets a valid image, even while the shadow map is disabled.
+        m_sceneCloudShadowMap = viewState.m_cloudShadowMap;
+        m_sceneCloudShadowMapCenterAndSize = AZ::Vector4::CreateZero();
+        m_sceneCloudShadowMapWindOffset = AZ::Vector2::CreateZero();
+        const AZ::RPI::ViewPtr view = viewState.m_renderPipeline->GetDefaultView();
+        if (!m_renderSettings.m_enableCloudShadowMap || !m_shaderConstantData || !view)
+        {
+            viewState.m_isCloudShadowMapValid = false;
+            return;
+        }
+
+        const CloudscapeShaderConstantData& shaderData = *m_shaderConstantData;
+        const float sizeKm = AZStd::max(shaderData.m_weatherMapSizeKm, 0.001f);
+        const float texelSizeKm = sizeKm / static_cast<float>(viewState.m_cloudShadowMap->GetDescriptor().m_size.m_width);
+        const AZ::Vector3 cameraPosition = view->GetCameraTransform().GetTranslation();
+        const AZ::Vector2 cameraPositionKm(cameraPosition.GetX() * 0.001f, cameraPosition.GetY() * 0.001f);
+
+        // The wind keeps moving the clouds after the shadow map is rendered. Until they move
+        // far enough, the shadows are shifted by GetCloudShadowTransmittance() instead of rendered again.
+        const AZ::Vector3 windOffsetSinceRefreshKm = m_windOffsetKm - viewState.m_cloudShadowMapWindOffsetKm;
+        const AZ::Vector2 windOffsetSinceRefreshXYKm(windOffsetSinceRefreshKm.GetX(), windOffsetSinceRefreshKm.GetY());
+
+        const float cosSunAngleThreshold = cosf(AZ::DegToRad(AZStd::max(m_renderSettings.m_cloudShadowMapSunAngleThresholdDegrees, 0.0f)));
+        const float windThresholdKm = AZStd::max(m_renderSettings.m_cloudShadowMapWindThresholdMeters, 0.0f) * 0.001f;
+        const bool isStale = !viewState.m_isCloudShadowMapValid ||
+            (viewState.m_cloudShadowMapSizeKm != sizeKm) ||
+            !AreCloudShadowMapInputsEqual(viewState.m_cloudShadowMapShaderData, shaderData) ||
+            (viewState.m_cloudShadowMapSunDirection.Dot(shaderData.m_directionTowardsTheSun) < cosSunAngleThreshold) ||
+            (windOffsetSinceRefreshXYKm.GetLength() > windThresholdKm) ||
+            (cameraPositionKm.GetDistance(viewState.m_cloudShadowMapCenterKm) > (sizeKm * CloudShadowMapRecenterFraction));
+        if (isStale)
+        {
+            // Snapped to whole texels, so the shadows don't shimmer when the map is recentered.
+            viewState.m_cloudShadowMapCenterKm = AZ::Vector2(
+                roundf(cameraPositionKm.GetX() / texelSizeKm) * texelSizeKm,
+                roundf(cameraPositionKm.GetY() / texelSizeKm) * texelSizeKm);
+            viewState.m_cloudShadowMapSizeKm = sizeKm;
+            viewState.m_cloudShadowMapSunDirection = shaderData.m_directionTowardsTheSun;
+            viewState.m_cloudShadowMapShaderData = shaderData;
+            viewState.m_cloudShadowMapWindOffsetKm = m_windOffsetKm;
+            viewState.m_isCloudShadowMapValid = true;
+            shadowMapPass->UpdateRegion(viewState.m_cloudShadowMapCenterKm, sizeKm);
+            shadowMapPass->SetIdle(false);
+        }
+
+        const AZ::Vector2 centerMeters = viewState.m_cloudShadowMapCenterKm * 1000.0f;
+        m_sceneCloudShadowMapCenterAndSize = AZ::Vector4(centerMeters.GetX(), centerMeters.GetY(), sizeKm * 1000.0f, 1.0f);
+        m_sceneCloudShadowMapWindOffset = isStale ? AZ::Vector2::CreateZero() : (windOffsetSinceRefreshXYKm * 1000.0f);
+    }
+
+    bool CloudscapeFeatureProcessor::AreCloudShadowMapInputsEqual(const CloudscapeShaderConstantData& lhs, const CloudscapeShaderConstantData& rhs)
+    {
+        return (lhs.m_uvwScale == rhs.m_uvwScale) &&
+               (lhs.m_planetRadiusKm == rhs.m_planetRadiusKm) &&
+               (lhs.m_cloudSlabDistanceAboveSeaLevelKm == rhs.m_cloudSlabDistanceAboveSeaLevelKm) &&
+               (lhs.m_cloudSlabThicknessKm == rhs.m_cloudSlabThicknessKm) &&
+               (lhs.m_cloudMaterialProperties.m_absorptionCoefficient == rhs.m_cloudMaterialProperties.m_absorptionCoefficient) &&
+               (lhs.m_cloudMaterialProperties.m_scatteringCoefficient == rhs.m_cloudMaterialProperties.m_scatteringCoefficient) &&
+               (lhs.m_weatherMapSizeKm == rhs.m_weatherMapSizeKm) &&
+               (lhs.m_globalCloudCoverage == rhs.m_globalCloudCoverage) &&
+               (lhs.m_globalCloudDensity == rhs.m_globalCloudDensity) &&
+               (lhs.m_windDirection == rhs.m_windDirection) &&
+               (lhs.m_cloudTopOffsetKm == rhs.m_cloudTopOffsetKm) &&
+               (lhs.m_weatherMap == rhs.m_weatherMap) &&
+               (lhs.m_lowFrequencyNoiseTexture == rhs.m_lowFrequencyNoiseTexture) &&
+               (lhs.m_highFrequencyNoiseTexture == rhs.m_highFrequencyNoiseTexture)
+               ;
+    }
+
+    void CloudscapeFeatureProcessor::UpdateSceneSrg(AZ::RPI::ShaderResourceGroup* sceneSrg)
+    {
+        if (!m_areSceneSrgIndicesInitialized)
+        {
+            m_areSceneSrgIndicesInitialized = true;
+            m_sceneSrgCloudShadowMapIndex = sceneSrg->FindShaderInputImageIndex(AZ::Name("m_cloudShadowMap"));
+            m_sceneSrgCloudShadowMapCenterAndSizeIndex = sceneSrg->FindShaderInputConstantIndex(AZ::Name("m_cloudShadowMapCenterAndSize"));
+            m_sceneSrgCloudShadowMapWindOffsetIndex = sceneSrg->FindShaderInputConstantIndex(AZ::Name("m_cloudShadowMapWindOffset"));
+            AZ_Warning(LogName, !m_renderSettings.m_enableCloudShadowMap || m_sceneSrgCloudShadowMapIndex.IsValid(),
+                "The Scene SRG doesn't include CloudShadowMapSceneSrg.azsli. The cloud shadow map is only available "
+                "through the CloudShadowMap slot of CloudscapeShadowMapComputePass.");
+        }
+
+        if (!m_sceneSrgCloudShadowMapIndex.IsValid() || !m_sceneCloudShadowMap)
+        {
+            return;
+        }
+        sceneSrg->SetImage(m_sceneSrgCloudShadowMapIndex, m_sceneCloudShadowMap);
+        sceneSrg->SetConstant(m_sceneSrgCloudShadowMapCenterAndSizeIndex, m_sceneCloudShadowMapCenterAndSize);
+        sceneSrg->SetConstant(m_sceneSrgCloudShadowMapWindOffsetIndex, m_sceneCloudShadowMapWindOffset);
+    }
+
+    bool CloudscapeFeatureProcessor::UpdateConvergenceState(ViewState& viewState)
+    {
+        // When the wind is blowing the clouds change every frame, even if the view is static.
+        if (!m_renderSettings.m_enableConvergence || IsBenchmarkRunning() || !m_shaderConstantData ||
+            (m_shaderConstantData->m_windSpeedKmPerSec > 0.0f))
+        {
+            viewState.m_staticFrameCount = 0;
+            return false;
+        }
+
+        const AZ::RPI::ViewPtr view = viewState.m_renderPipeline->GetDefaultView();
+        if (!view)
+        {
+            viewState.m_staticFrameCount = 0;
+            return false;
+        }
+
+        const AZ::Matrix4x4& worldToClipMatrix = view->GetWorldToClipMatrix();
+        if (!worldToClipMatrix.IsClose(viewState.m_prevWorldToClipMatrix))
+        {
+            viewState.m_prevWorldToClipMatrix = worldToClipMatrix;
+            viewState.m_staticFrameCount = 0;
+            return false;
+        }
+
+        const uint32_t sampleCount = AZStd::clamp(m_renderSettings.m_convergenceSampleCount, 1u, 16u);
+        return viewState.m_staticFrameCount >= (sampleCount * 16);
+    }
+
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetOutput0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudOutput0 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetOutput1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudOutput1 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetCloudAlpha0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudAlpha0 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetCloudAlpha1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudAlpha1 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetConfidence0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_confidence0 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetConfidence1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_confidence1 : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetSkyViewImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_skyView : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetCloudShadowMapImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudShadowMap : nullptr;
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetRayMarchDebugStatsImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_rayMarchDebugStats : nullptr;
+    }
+
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::GetCloudDepthImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const
+    {
+        const ViewState* viewState = FindViewState(renderPipeline);
+        return viewState ? viewState->m_cloudDepth : nullptr;
+    }
+
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateCloudscapeOutputAttachment(const AZ::Name& attachmentName
+        , const AzFramework::WindowSize attachmentSize, bool isHdr) const
+    {
+        // Both formats are 32 bits per pixel. The HDR format has no alpha, see ViewState::m_cloudAlpha0.
+        const AZ::RHI::Format format = isHdr ? AZ::RHI::Format::R11G11B10_FLOAT : AZ::RHI::Format::R8G8B8A8_UNORM;
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, attachmentSize.m_width, attachmentSize.m_height, format);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(0, 0, 0, 0);
+        AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
+        return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateR8UnormAttachment(const AZ::Name& attachmentName
+        , const AzFramework::WindowSize attachmentSize) const
+    {
+        // Used for the confidence and the cloud alpha. Cleared to zero, so there's no trusted history
+        // and no clouds in the first frames.
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, attachmentSize.m_width, attachmentSize.m_height, AZ::RHI::Format::R8_UNORM);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(0, 0, 0, 0);
+        AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
+        return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateCloudDepthAttachment(const AZ::Name& attachmentName
+        , const AzFramework::WindowSize attachmentSize) const
+    {
+        // 16 bits float keeps a precision of a few meters at tens of kilometers.
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, attachmentSize.m_width, attachmentSize.m_height, AZ::RHI::Format::R16_FLOAT);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(0, 0, 0, 0);
+        AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
+        return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateSkyViewAttachment(const AZ::Name& attachmentName) const
+    {
+        // 16 bits per channel because the texture is magnified during composition and 8 bits would show banding.
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, SkyViewWidth, SkyViewHeight, AZ::RHI::Format::R16G16B16A16_FLOAT);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(0, 0, 0, 0);
+        AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
+        return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateCloudShadowMapAttachment(const AZ::Name& attachmentName
+        , uint32_t resolution) const
+    {
+        // Transmittance between 0 and 1. 16 bits because the soft edges of the shadows would show banding with 8 bits.
+        // Cleared to 1, no shadows, until it is rendered.
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, resolution, resolution, AZ::RHI::Format::R16_FLOAT);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Float(1, 1, 1, 1);
+        AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
+        return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
+    }
+
+    AZ::Data::Instance<AZ::RPI::AttachmentImage> CloudscapeFeatureProcessor::CreateRayMarchDebugStatsAttachment(const AZ::Name& attachmentName
+        , const AzFramework::WindowSize attachmentSize) const
+    {
+        AZ::RHI::ImageDescriptor imageDesc = AZ::RHI::ImageDescriptor::Create2D(
+            AZ::RHI::ImageBindFlags::ShaderReadWrite, attachmentSize.m_width, attachmentSize.m_height, AZ::RHI::Format::R32G32B32A32_UINT);
+        AZ::RHI::ClearValue clearValue = AZ::RHI::ClearValue::CreateVector4Uint(0, 0, 0, 0);
         AZ::Data::Instance<AZ::RPI::AttachmentImagePool> pool = AZ::RPI::ImageSystemInterface::Get()->GetSystemAttachmentPool();
         return AZ::RPI::AttachmentImage::Create(*pool.get(), imageDesc, attachmentName, &clearValue, nullptr);
     }
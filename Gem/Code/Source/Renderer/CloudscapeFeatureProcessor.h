@@ -7,6 +7,18 @@
 
 #pragma once
 
+#include <AzCore/Math/Matrix4x4.h>
+#include <AzCore/Math/Vector2.h>
+#include <AzCore/Math/Vector4.h>
+#include <AzCore/std/containers/array.h>
+#include <AzCore/std/containers/fixed_vector.h>
+#include <AzCore/std/containers/unordered_map.h>
+#include <AzCore/std/functional.h>
+#include <AzCore/std/parallel/atomic.h>
+#include <AzCore/std/parallel/mutex.h>
+#include <AzCore/std/smart_ptr/shared_ptr.h>
+#include <AzCore/std/smart_ptr/weak_ptr.h>
+
 #include <Atom/RPI.Reflect/Image/StreamingImageAsset.h>
 
 #include <Atom/RPI.Public/Buffer/Buffer.h>
@@ -14,18 +26,36 @@
 #include <Atom/RPI.Public/Shader/ShaderResourceGroup.h>
 #include <Atom/RPI.Public/ViewportContextBus.h>
 #include <Atom/RPI.Public/FeatureProcessor.h>
+#include <Atom/RPI.Public/Scene.h>
 #include <Atom/RPI.Public/Pass/ComputePass.h>
+#include <Atom/RPI.Public/Pass/AttachmentReadback.h>
+
+#include <VolumetricClouds/CloudQueryBus.h>
 
 #include <Renderer/CloudTexturePresentationData.h>
 #include <Renderer/Passes/CloudTextureComputeData.h>
 #include <Renderer/CloudscapeShaderConstantData.h>
+#include <Renderer/CloudscapeRenderSettings.h>
+#include <Renderer/CloudscapeQualityController.h>
+#include <Renderer/CloudDensitySampler.h>
+#include <Renderer/CloudParameterAnimation.h>
+#include <Renderer/TripleBuffer.h>
 
 class AZ::RPI::Scene;
 
 namespace VolumetricClouds
 {
+    class CloudscapeComputePass;
+    class CloudscapeRasterPass;
+    class CloudscapeShadowMapBarrierPass;
+    class CloudscapeShadowMapComputePass;
+    class CloudscapeSkyViewComputePass;
+    class CloudscapeStereoReprojectionComputePass;
+    class CloudscapeSunVisibilityComputePass;
+
     class CloudscapeFeatureProcessor final
         : public AZ::RPI::FeatureProcessor
+        , public CloudQueryRequestBus::Handler
     {
     public:
         AZ_CLASS_ALLOCATOR(CloudscapeFeatureProcessor, AZ::SystemAllocator)
@@ -33,28 +63,325 @@ namespace VolumetricClouds
 
         static void Reflect(AZ::ReflectContext* context);
 
+        // Selected with the r_volumetricCloudsRayMarchDebugView CVar. Replaces the clouds with a heatmap
+        // of the selected ray marching counter, or with the reason each ray stopped marching.
+        // Must match GetRayMarchDebugColor() in Cloudscape.azsl.
+        enum class RayMarchDebugView : uint32_t
+        {
+            Disabled,
+            PrimarySteps,
+            LightSamples,
+            ExpensiveDensityCalls,
+            CheapDensityCalls,
+            ExitReason,
+            Count
+        };
+
         CloudscapeFeatureProcessor() = default;
         virtual ~CloudscapeFeatureProcessor() = default;
 
-        void UpdateShaderConstantData(const CloudscapeShaderConstantData& shaderData);
+        // Can be called from any thread, concurrent calls don't block each other and the last one wins.
+        // The data is copied and becomes visible to the passes in the next Simulate(), without locking the render thread.
+        void StageShaderConstantData(const CloudscapeShaderConstantData& shaderData);
+        // Same threading rules as StageShaderConstantData(). Replaces all the playing parameter animations.
+        void StageParameterTracks(const AZStd::vector<CloudParameterTrack>& tracks);
+        void UpdateRenderSettings(const CloudscapeRenderSettings& renderSettings);
 
     private:
         CloudscapeFeatureProcessor(const CloudscapeFeatureProcessor&) = delete;
 
         friend class CloudscapeComputePass;
         friend class CloudscapeRasterPass;
+        friend class CloudscapeShadowMapBarrierPass;
+        friend class CloudscapeShadowMapComputePass;
+        friend class CloudscapeSkyViewComputePass;
+        friend class CloudscapeStereoReprojectionComputePass;
         //friend class DepthBufferCopyPass;
 
         static constexpr char LogName[] = "CloudscapeFeatureProcessor";
 
+        // Everything that depends on the render pipeline the clouds are rendered to.
+        // Each render pipeline (main viewport, secondary editor viewports, render to texture cameras, etc)
+        // gets its own passes, attachments and history.
+        struct ViewState
+        {
+            AZ::RPI::RenderPipeline* m_renderPipeline = nullptr;
+            AzFramework::WindowSize m_size{ 0, 0 };
+
+            // There are two fullscreen sized "render attachments" for the cloudscape.
+            // Each frame one of the attachments is the current attachment and the other
+            // represents the previous frame. This means that for all the passes involved
+            // in cloudscape rendering these attachments become "Imported" attachments.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudOutput0;
+            // With compact history m_cloudOutput1 is quarter by quarter resolution and only has the new samples.
+            // See CloudscapeRenderSettings::m_enableCompactHistory.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudOutput1;
+            bool m_isCompactHistoryEnabled = false;
+            // The alpha of m_cloudOutput0 and m_cloudOutput1 when they are R11G11B10_FLOAT, otherwise 1x1.
+            // See CloudscapeRenderSettings::m_enableHdrOutput.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudAlpha0;
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudAlpha1;
+            bool m_isHdrOutputEnabled = false;
+            // How much each pixel of the cloudscape attachment with the same index can be trusted.
+            // Written by the reprojection pass, see CloudscapeReprojectionCS.azsl.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_confidence0;
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_confidence1;
+
+            // Low resolution latitude/longitude texture with the far away clouds.
+            // Its size doesn't depend on the viewport size. See CloudscapeSkyViewComputePass.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_skyView;
+
+            // Top-down cloud shadow map, see CloudscapeShadowMapComputePass. It is 1x1 while
+            // CloudscapeRenderSettings::m_enableCloudShadowMap is disabled.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudShadowMap;
+
+            // The packed ray marching counters of each pixel, see CloudscapeRayMarchDebugStats.azsli.
+            // It is view sized only while the ray march debug view is enabled, otherwise it is 1x1.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_rayMarchDebugStats;
+
+            // Distance to the clouds in kilometers. See CloudscapeRenderSettings::m_enableCloudDepthOutput.
+            // It is view sized only while the cloud depth is enabled, otherwise it is 1x1.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudDepth;
+            bool m_isCloudDepthEnabled = false;
+
+            // The passes added to @m_renderPipeline.
+            CloudscapeComputePass* m_cloudscapeComputePass = nullptr;
+            AZ::RPI::ComputePass* m_cloudscapeReprojectionPass = nullptr;
+            CloudscapeSkyViewComputePass* m_cloudscapeSkyViewPass = nullptr;
+            // Only dispatched in the default render pipeline, while there are sun visibility positions.
+            CloudscapeSunVisibilityComputePass* m_cloudscapeSunVisibilityPass = nullptr;
+            // Only dispatched in the default render pipeline, in the frames where the cloud shadow map is stale.
+            CloudscapeShadowMapComputePass* m_cloudscapeShadowMapPass = nullptr;
+            // Runs every frame, so the passes that read SceneSrg::m_cloudShadowMap see the last dispatch of m_cloudscapeShadowMapPass.
+            CloudscapeShadowMapBarrierPass* m_cloudscapeShadowMapBarrierPass = nullptr;
+            CloudscapeRasterPass* m_cloudscapeRenderPass = nullptr;
+            // Does the work of m_cloudscapeReprojectionPass and m_cloudscapeRenderPass, which are disabled, when
+            // CloudscapeRenderSettings::m_enableFusedComposite is enabled. See CloudscapeFusedComposite.azsl.
+            // Only exists while the fused composite is enabled.
+            CloudscapeRasterPass* m_cloudscapeFusedRenderPass = nullptr;
+            bool m_isFusedCompositeEnabled = false;
+            // Optional, only used to read back the totals of the ray march debug view.
+            AZ::RPI::ComputePass* m_cloudscapeRayMarchDebugStatsReductionPass = nullptr;
+            // Only exists in the render pipeline of the right eye of a stereo (XR) pair.
+            CloudscapeStereoReprojectionComputePass* m_cloudscapeStereoReprojectionPass = nullptr;
+            // True while the clouds of this view are reprojected from the left eye instead of ray marched.
+            // The attachments that only the ray marching and the reprojection passes use are then 1x1,
+            // and CloudscapeOutput0 is the only full size cloudscape attachment.
+            bool m_isStereoTarget = false;
+
+            // We keep track of the number of rendered frames so we can do the modulo 16 and pass
+            // the counter to the Cloudscape passes so they know who is the current frame and who is the
+            // previous frame.
+            uint32_t m_frameCounter = 0;
+            // The cloudscape texture, 0 or 1, read by CloudscapeRasterPass in the current frame.
+            uint32_t m_outputTextureIndex = 0;
+
+            // The attachments of the left eye that m_cloudscapeStereoReprojectionPass was built with.
+            // Used to detect when the pass must be rebuilt. Output1 is the one that changes both
+            // with the size and with CloudscapeRenderSettings::m_enableCompactHistory.
+            AZ::Data::Instance<AZ::RPI::AttachmentImage> m_stereoSourceOutput1;
+
+            // Convergence state. See CloudscapeRenderSettings::m_enableConvergence.
+            uint32_t m_staticFrameCount = 0;
+            AZ::Matrix4x4 m_prevWorldToClipMatrix = AZ::Matrix4x4::CreateZero();
+
+            // See CloudscapeRenderSettings::m_enableDynamicQuality. The GPU time of each view
+            // is different, so each view has its own quality level.
+            CloudscapeQualityController m_qualityController;
+
+            // Ray march debug view state.
+            RayMarchDebugView m_rayMarchDebugView = RayMarchDebugView::Disabled;
+            AZStd::shared_ptr<AZ::RPI::AttachmentReadback> m_rayMarchDebugReadback;
+            AZStd::atomic_bool m_isRayMarchDebugReadbackPending{ false };
+
+            // Sun visibility readback state. @m_sunVisibilityReadbackPositionCount is the number of positions
+            // that were dispatched in the frame of the pending readback.
+            AZStd::shared_ptr<AZ::RPI::AttachmentReadback> m_sunVisibilityReadback;
+            AZStd::atomic_bool m_isSunVisibilityReadbackPending{ false };
+            uint32_t m_sunVisibilityReadbackPositionCount = 0;
+            // The version of the positions sent to m_cloudscapeSunVisibilityPass. See SunVisibilityState::m_positionsVersion.
+            uint32_t m_sunVisibilityPositionsVersion = 0;
+
+            // Cloud shadow map state. The last refresh of m_cloudShadowMap was rendered with these values.
+            bool m_isCloudShadowMapValid = false;
+            AZ::Vector2 m_cloudShadowMapCenterKm = AZ::Vector2::CreateZero();
+            float m_cloudShadowMapSizeKm = 0.0f;
+            AZ::Vector3 m_cloudShadowMapSunDirection = AZ::Vector3::CreateAxisZ();
+            CloudscapeShaderConstantData m_cloudShadowMapShaderData;
+            // The wind offset the shadow map was rendered with, see m_windOffsetKm.
+            AZ::Vector3 m_cloudShadowMapWindOffsetKm = AZ::Vector3::CreateZero();
+
+            bool HasPasses() const;
+            // The passes that composite the clouds and exist, only one of them is enabled.
+            AZStd::fixed_vector<CloudscapeRasterPass*, 2> GetRenderPasses() const;
+            // Queues the removal of all the passes that were added, even if some of them failed to be added.
+            void QueuePassesForRemoval() const;
+        };
+
+        // Sun visibility state, accessed from any thread. The positions are copied to the pass in Simulate()
+        // when @m_positionsVersion changes, and the results are written by the readback callback.
+        struct SunVisibilityState
+        {
+            AZStd::mutex m_mutex;
+            AZStd::vector<AZ::Vector3> m_positions;
+            uint32_t m_positionsVersion = 0;
+            AZStd::vector<float> m_results;
+        };
+
         void ActivateInternal();
 
+        // Returns null if the cloudscape is not rendered to @renderPipeline.
+        ViewState* FindViewState(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        // Disconnects the pending readbacks of @viewState before it is erased from @m_viewStates. It doesn't remove
+        // the passes, call ViewState::QueuePassesForRemoval() first unless the render pipeline is being removed.
+        void RemoveViewState(ViewState& viewState);
+
+        // The size of the output of @renderPipeline. Zero if it is unknown, e.g. a minimized window.
+        static AzFramework::WindowSize GetRenderPipelineSize(const AZ::RPI::RenderPipeline* renderPipeline);
+
+        // Creates CloudscapeOutput0/1, and the ray march debug stats when the debug view is enabled,
+        // with the size of ViewState::m_size.
+        void CreateViewSizedAttachments(ViewState& viewState) const;
+        // Called each frame. Reallocates the view sized attachments when the size of the render pipeline
+        // changes, and rebuilds the passes that use them.
+        void UpdateViewSize(ViewState& viewState);
+
+        // Calls AddPassRequestToRenderPipeline() and returns the pass named @passName.
+        template<typename PassType>
+        PassType* AddPass(AZ::RPI::RenderPipeline* renderPipeline, const char* passRequestAssetFilePath, const char* passName,
+            const char* referencePassName, bool beforeReferencePass);
+
+        // Runs the per frame logic of a single view. Only the default view reports
+        // to VolumetricCloudsStatsCollector.
+        // Points the passes to @shaderData, which must be @m_animatedShaderConstantData.
+        void UpdateShaderConstantData(const CloudscapeShaderConstantData& shaderData);
+
+        void SimulateView(ViewState& viewState, bool isDefaultView);
+
+        // Returns the view state of the left eye when @viewState is the right eye of a stereo pair
+        // and CloudscapeRenderSettings::m_enableStereoReprojection is enabled. Returns null otherwise.
+        ViewState* FindStereoSourceViewState(const ViewState& viewState) const;
+        // Called by CloudscapeStereoReprojectionComputePass. Returns the render pipeline of the left eye.
+        const AZ::RPI::RenderPipeline* GetStereoSourceRenderPipeline(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        // Called each frame instead of the ray marching logic for the right eye of a stereo pair.
+        // Must be called after the left eye has been simulated.
+        void SimulateStereoSecondEye(ViewState& viewState, ViewState& sourceViewState);
+        // Resizes the attachments, and rebuilds the passes that use them, when the view starts or stops
+        // being reprojected from the left eye. See ViewState::m_isStereoTarget.
+        void UpdateStereoTargetState(ViewState& viewState, bool isStereoTarget);
+
+        // Counts how many consecutive frames the view and the shader constants have been static.
+        // Returns true once enough samples have been accumulated per pixel, which means
+        // the ray marching and reprojection passes don't need to run.
+        bool UpdateConvergenceState(ViewState& viewState);
+
+        // Sends the sky-view related parameters from @m_renderSettings and @m_shaderConstantData to the passes.
+        void UpdateSkyViewParameters(ViewState& viewState);
+
+        // Moves the ray marching passes to the queue selected by CloudscapeRenderSettings::m_enableAsyncCompute.
+        void UpdateAsyncComputeSettings(ViewState& viewState);
+
+        // Adds the fused composite pass and disables the composite pass, or removes the fused composite pass.
+        // See CloudscapeRenderSettings::m_enableFusedComposite.
+        void UpdateFusedCompositeSettings(ViewState& viewState);
+
+        // Called once per frame. Moves @m_windOffsetKm by the wind velocity and sends it
+        // to the ray marching passes and to the density sampler queries.
+        void UpdateWindOffset();
+        // How far the wind moved the clouds since the previous frame.
+        AZ::Vector3 GetFrameWindOffsetKm() const;
+
+        // Called each frame. Replaces @m_densitySampler with one that uses @shaderData. The CPU copies of the textures
+        // are only recreated when the images, or their resident mips, change.
+        void UpdateDensitySampler(const CloudscapeShaderConstantData& shaderData);
+        AZStd::shared_ptr<const CloudDensitySampler> GetDensitySampler() const;
+        AZ::Vector3 GetDensitySamplerWindOffsetKm() const;
+
+        // Calls @batchFunction(firstItem, itemCount) for consecutive batches of @batchSize items out of @itemCount.
+        // Runs inline when there is only one batch, otherwise one job per batch, and waits for all of them.
+        static void RunQueryBatches(size_t itemCount, size_t batchSize, const AZStd::function<void(size_t, size_t)>& batchFunction);
+
+        // Called once per frame. Publishes the staged shader constant data and parameter tracks,
+        // plays the tracks on top of the data, and sends the result to the passes if anything changed.
+        void UpdateAnimatedShaderConstantData();
+        // Regenerates @m_phaseFunctionLut when the cloud material changes, and assigns it to @shaderData.
+        void UpdatePhaseFunctionLut(CloudscapeShaderConstantData& shaderData);
+        // Recalculates @m_skyIrradiance when the sun or the planetary data change, and assigns it to @shaderData.
+        void UpdateSkyIrradiance(CloudscapeShaderConstantData& shaderData);
+
+        // Resizes the attachments, and rebuilds the passes that use them, when
+        // CloudscapeRenderSettings::m_enableCloudDepthOutput, m_enableCompactHistory or m_enableHdrOutput change.
+        void UpdateAttachmentSettings(ViewState& viewState);
+
+        // Called each frame. Enables the GPU timestamp and pipeline statistics queries of the passes when
+        // needed by the dynamic quality or by VolumetricCloudsStatsCollector, and reports the latest results
+        // to the latter when @reportStats is true.
+        void UpdateGpuQueries(ViewState& viewState, bool reportStats);
+
+        // Applies the current quality level, or resets it when
+        // CloudscapeRenderSettings::m_enableDynamicQuality is disabled.
+        void UpdateDynamicQualitySettings(ViewState& viewState);
+        // Called each frame. Feeds the GPU time of the passes to ViewState::m_qualityController.
+        void UpdateDynamicQuality(ViewState& viewState);
+        // While VolumetricCloudsStatsCollector runs a benchmark, convergence and dynamic quality are suspended,
+        // so every frame does the full work at the highest quality and the results of two runs can be compared.
+        static bool IsBenchmarkRunning();
+        // Sends the current quality level of ViewState::m_qualityController to the passes.
+        void ApplyQualityLevel(ViewState& viewState);
+        uint32_t GetSkyViewSliceCount(const ViewState& viewState) const;
+
+        // Called each frame. Reconfigures the passes when r_volumetricCloudsRayMarchDebugView changes
+        // and, while the debug view is enabled, reads back the totals of the reduction pass.
+        // Only the totals of the view with @reportTotals are sent to VolumetricCloudsStatsCollector.
+        void UpdateRayMarchDebugView(ViewState& viewState, bool reportTotals);
+        // The counter value shown as the hottest color of the heatmap.
+        float GetRayMarchDebugMaxValue(RayMarchDebugView rayMarchDebugView) const;
+        // Called by the readback of the reduction pass, possibly from another thread.
+        static void OnRayMarchDebugTotalsReadback(ViewState& viewState, const AZ::RPI::AttachmentReadback::ReadbackResult& result);
+
+        // Called each frame. Sends the positions of SetSunVisibilityPositions() to the sun visibility pass
+        // of the default view and reads back its results. The pass is idle in all the other views.
+        void UpdateSunVisibility(ViewState& viewState, bool isDefaultView);
+        // Called by the readback of the sun visibility pass, possibly from another thread.
+        static void OnSunVisibilityReadback(ViewState& viewState, SunVisibilityState& sunVisibility,
+            const AZ::RPI::AttachmentReadback::ReadbackResult& result);
+
+        // Recreates ViewState::m_cloudShadowMap, and rebuilds the pass that renders it, when
+        // CloudscapeRenderSettings::m_enableCloudShadowMap or m_cloudShadowMapResolution change.
+        void UpdateCloudShadowMapAttachment(ViewState& viewState);
+        // Called each frame. Dispatches the shadow map pass of the default view only when the sun, the wind, the camera
+        // or the clouds moved enough since the last refresh, and publishes the result for the Scene SRG.
+        // The pass is idle in all the other views.
+        void UpdateCloudShadowMap(ViewState& viewState, bool isDefaultView);
+        // Only compares the parameters that change the cloud shadows. The sun direction is compared separately.
+        static bool AreCloudShadowMapInputsEqual(const CloudscapeShaderConstantData& lhs, const CloudscapeShaderConstantData& rhs);
+        // Called by @m_prepareSceneSrgHandler before the Scene SRG is compiled.
+        void UpdateSceneSrg(AZ::RPI::ShaderResourceGroup* sceneSrg);
+
         AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateCloudscapeOutputAttachment(const AZ::Name& attachmentName
+            , const AzFramework::WindowSize attachmentSize, bool isHdr) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateR8UnormAttachment(const AZ::Name& attachmentName
+            , const AzFramework::WindowSize attachmentSize) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateCloudDepthAttachment(const AZ::Name& attachmentName
+            , const AzFramework::WindowSize attachmentSize) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateSkyViewAttachment(const AZ::Name& attachmentName) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateCloudShadowMapAttachment(const AZ::Name& attachmentName
+            , uint32_t resolution) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> CreateRayMarchDebugStatsAttachment(const AZ::Name& attachmentName
             , const AzFramework::WindowSize attachmentSize) const;
 
-        // Call by the passes owned by this feature processor.
-        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetOutput0ImageAttachment() { return m_cloudOutput0; }
-        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetOutput1ImageAttachment() { return m_cloudOutput1; }
+        // Call by the passes owned by this feature processor. Each pass requests the attachments
+        // of its own render pipeline.
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetOutput0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetOutput1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetCloudAlpha0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetCloudAlpha1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetConfidence0ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetConfidence1ImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetSkyViewImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetCloudShadowMapImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetRayMarchDebugStatsImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> GetCloudDepthImageAttachment(const AZ::RPI::RenderPipeline* renderPipeline) const;
 
         //////////////////////////////////////////////////////////////////
         //! AZ::RPI::FeatureProcessor overrides START...
@@ -65,15 +392,38 @@ namespace VolumetricClouds
         //! AZ::RPI::FeatureProcessor overrides END ...
         ///////////////////////////////////////////////////////////////////
 
+        //////////////////////////////////////////////////////////////////
+        //! CloudQueryRequestBus overrides START...
+        bool IsCloudQueryReady() override;
+        CloudQueryStatus GetCloudQueryStatus() override;
+        bool QueryCloudDensity(AZStd::span<const AZ::Vector3> worldPositions, AZStd::span<float> densities) override;
+        bool QueryCloudTransmittance(AZStd::span<const AZ::Vector3> segmentStarts, AZStd::span<const AZ::Vector3> segmentEnds,
+            AZStd::span<CloudTransmittanceResult> results) override;
+        void SetSunVisibilityPositions(AZStd::span<const AZ::Vector3> worldPositions) override;
+        bool GetSunVisibility(AZStd::span<float> transmittances) override;
+        //! CloudQueryRequestBus overrides END ...
+        ///////////////////////////////////////////////////////////////////
+
+        //////////////////////////////////////////////////////////////////
+        //! AZ::RPI::SceneNotificationBus overrides START...
+        void OnRenderPipelineChanged(AZ::RPI::RenderPipeline* renderPipeline, AZ::RPI::SceneNotification::RenderPipelineChangeType changeType) override;
+        //! AZ::RPI::SceneNotificationBus overrides END ...
+        ///////////////////////////////////////////////////////////////////
+
         static constexpr const char* FeatureProcessorName = "CloudscapeFeatureProcessor";
 
-        // There are two fullscreen sized "render attachments" for the cloudscape.
-        // They are owned by this feature processor.
-        // Each frame one of the attachments is the current attachment and the other
-        // represents the previous frame. This means that for all the passes involved
-        // in cloudscape rendering these attachments become "Imported" attachments.
-        AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudOutput0;
-        AZ::Data::Instance<AZ::RPI::AttachmentImage> m_cloudOutput1;
+        // See CloudscapeSkyViewComputePass.
+        static constexpr uint32_t SkyViewWidth = 512;
+        static constexpr uint32_t SkyViewHeight = 256;
+
+        // See CloudscapeRenderSettings::m_cloudShadowMapResolution.
+        static constexpr uint32_t MinCloudShadowMapResolution = 64;
+        static constexpr uint32_t MaxCloudShadowMapResolution = 2048;
+        // The cloud shadow map is recentered when the camera is farther than this fraction of its size
+        // from the center, so there are always shadows around the camera.
+        static constexpr float CloudShadowMapRecenterFraction = 0.125f;
+        // The sky irradiance is recalculated when the sun moves more than this angle, e.g. during a day/night cycle.
+        static constexpr float SkyIrradianceSunAngleThresholdDegrees = 0.25f;
 
         // We need a copy of the previous frame depth buffer, because we reproject 15/16 pixels each frame.
         // This causes visible artifacts at the borders of moving objects. The solution is that if
@@ -81,23 +431,75 @@ namespace VolumetricClouds
         // in the previous frame then we can choose to ray march it, or interpolate it.
         AZ::Data::Instance<AZ::RPI::AttachmentImage> m_previousFrameDepthBuffer; 
 
-        // We keep track of the number of rendered frames so we can do the modulo 16 and pass
-        // the counter to the Cloudscape passes so they know who is the current frame and who is the
-        // previous frame.
-        uint32_t m_frameCounter = 0;
-
-        // The passes managed by this feature processor.
-        CloudscapeComputePass* m_cloudscapeComputePass = nullptr;
-        AZ::RPI::ComputePass* m_cloudscapeReprojectionPass = nullptr;
-        CloudscapeRasterPass* m_cloudscapeRenderPass = nullptr;
-
-        // Shader constants for m_cloudscapeReprojectionPass
+        // Shader constants for ViewState::m_cloudscapeReprojectionPass
         AZ::RHI::ShaderInputNameIndex m_pixelIndex4x4Index = "m_pixelIndex4x4";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionPlanetRadiusKmIndex = "m_planetRadiusKm";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionCloudSlabDistanceAboveSeaLevelKmIndex = "m_cloudSlabDistanceAboveSeaLevelKm";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionCloudSlabThicknessKmIndex = "m_cloudSlabThicknessKm";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionWindOffsetKmIndex = "m_windOffsetKm";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionCloudDepthEnabledIndex = "m_cloudDepthEnabled";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionCompactHistoryEnabledIndex = "m_compactHistoryEnabled";
+        AZ::RHI::ShaderInputNameIndex m_reprojectionHdrOutputEnabledIndex = "m_hdrOutputEnabled";
 
+        // Written by StageShaderConstantData() and StageParameterTracks(), and published once per frame in Simulate().
+        TripleBuffer<CloudscapeShaderConstantData> m_stagedShaderConstantData;
+        TripleBuffer<AZStd::vector<CloudParameterTrack>> m_stagedParameterTracks;
+        // The last published shader constant data, with the animated parameters applied on top.
+        // Only modified in Simulate(). @m_shaderConstantData points to it once the first data is published.
+        CloudscapeShaderConstantData m_animatedShaderConstantData;
+        CloudParameterAnimator m_parameterAnimator;
         const CloudscapeShaderConstantData* m_shaderConstantData = nullptr;
+        // How far the wind has moved the clouds, accumulated each frame from the wind velocity by UpdateWindOffset().
+        // The ray marching passes, the reprojection, the cloud shadow map and the density sampler queries all use it.
+        AZ::Vector3 m_windOffsetKm = AZ::Vector3::CreateZero();
+        AZ::Vector3 m_prevWindOffsetKm = AZ::Vector3::CreateZero();
+
+        // See CloudPhaseFunctionLut. None of the animated parameters changes the material, so the lookup table
+        // is only regenerated when the controller stages a new material.
+        AZ::Data::Instance<AZ::RPI::Image> m_phaseFunctionLut;
+        CloudMaterialProperties m_phaseFunctionLutMaterialProperties;
+
+        // See CloudSkyIrradiance, and the inputs it was calculated with.
+        CloudSkyIrradiance m_skyIrradiance;
+        bool m_isSkyIrradianceValid = false;
+        AZ::Vector3 m_skyIrradianceSunDirection = AZ::Vector3::CreateAxisZ();
+        float m_skyIrradiancePlanetRadiusKm = 0.0f;
+        float m_skyIrradianceCloudSlabTopKm = 0.0f;
+
+        // Used by the CloudQueryRequestBus functions, which can be called from any thread. The sampler is never modified,
+        // it is replaced each time the shader constant data that it reads changes.
+        mutable AZStd::mutex m_densitySamplerMutex;
+        AZStd::shared_ptr<const CloudDensitySampler> m_densitySampler;
+        CloudQueryStatus m_cloudQueryStatus = CloudQueryStatus::NotReady;
+        // The data @m_densitySampler was created from. Only accessed by UpdateDensitySampler().
+        CloudscapeShaderConstantData m_densitySamplerShaderData;
+        // A copy of @m_windOffsetKm for the queries.
+        AZ::Vector3 m_densitySamplerWindOffsetKm = AZ::Vector3::CreateZero();
+        // In the same order as the CloudDensitySampler constructor: low frequency noise, high frequency noise and weather map.
+        AZStd::array<const AZ::RPI::Image*, 3> m_densitySamplerImages = {};
+        // The resident mip of each image when its CPU copy was taken.
+        AZStd::array<uint32_t, 3> m_densitySamplerResidentMips = {};
+        AZStd::array<AZStd::shared_ptr<const CloudCpuTexture>, 3> m_cpuTextures;
+
+        // Shared with the sun visibility readback callback, which can outlive this feature processor.
+        AZStd::shared_ptr<SunVisibilityState> m_sunVisibility = AZStd::make_shared<SunVisibilityState>();
 
-        ////////////////////////////////////////////////////
+        // The cloud shadow map of the default view, published by UpdateCloudShadowMap() and bound to the Scene SRG
+        // by UpdateSceneSrg(). See CloudShadowMapSceneSrg.azsli. The Scene SRG inputs are looked up once, and stay
+        // invalid when the project's Scene SRG doesn't include them.
+        AZ::RPI::Scene::PrepareSceneSrgEvent::Handler m_prepareSceneSrgHandler;
+        bool m_areSceneSrgIndicesInitialized = false;
+        AZ::RHI::ShaderInputImageIndex m_sceneSrgCloudShadowMapIndex;
+        AZ::RHI::ShaderInputConstantIndex m_sceneSrgCloudShadowMapCenterAndSizeIndex;
+        AZ::RHI::ShaderInputConstantIndex m_sceneSrgCloudShadowMapWindOffsetIndex;
+        AZ::Data::Instance<AZ::RPI::AttachmentImage> m_sceneCloudShadowMap;
+        // In meters, see SceneSrg::m_cloudShadowMapCenterAndSize and SceneSrg::m_cloudShadowMapWindOffset.
+        AZ::Vector4 m_sceneCloudShadowMapCenterAndSize = AZ::Vector4::CreateZero();
+        AZ::Vector2 m_sceneCloudShadowMapWindOffset = AZ::Vector2::CreateZero();
+        CloudscapeRenderSettings m_renderSettings;
 
-        AzFramework::WindowSize m_viewportSize{0,0};
+        // Keyed by render pipeline. ViewState is not movable because of its atomics, and the readback
+        // callbacks hold weak references to it.
+        AZStd::unordered_map<const AZ::RPI::RenderPipeline*, AZStd::shared_ptr<ViewState>> m_viewStates;
     };
 } // namespace VolumetricClouds
@@ -0,0 +1,111 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/std/algorithm.h>
+
+#include "CloudscapeQualityController.h"
+
+namespace VolumetricClouds
+{
+    namespace
+    {
+        // From highest to lowest quality.
+        constexpr CloudscapeQualityController::QualityLevel QualityLevels[] = {
+            { 1.00f, 0.0f, 1 },
+            { 0.75f, 0.5f, 1 },
+            { 0.50f, 1.0f, 2 },
+            { 0.35f, 1.5f, 2 },
+            { 0.25f, 2.0f, 4 },
+        };
+        constexpr uint32_t QualityLevelCount = static_cast<uint32_t>(AZ_ARRAY_SIZE(QualityLevels));
+    }
+
+    void CloudscapeQualityController::Reset()
+    {
+        m_qualityLevelIndex = 0;
+        m_smoothedGpuTimeMs = 0.0f;
+        m_staleSampleCount = 0;
+        m_overBudgetFrameCount = 0;
+        m_underBudgetFrameCount = 0;
+        m_framesToIncreaseQuality = MinFramesToIncreaseQuality;
+        m_framesSinceQualityIncrease = MaxFramesToIncreaseQuality;
+    }
+
+    bool CloudscapeQualityController::Update(float gpuTimeMs, float gpuBudgetMs)
+    {
+        if (gpuTimeMs <= 0.0f || gpuBudgetMs <= 0.0f)
+        {
+            // No valid timestamp yet.
+            return false;
+        }
+
+        m_framesSinceQualityIncrease = AZStd::min(m_framesSinceQualityIncrease + 1, MaxFramesToIncreaseQuality);
+        if (m_staleSampleCount > 0)
+        {
+            m_staleSampleCount--;
+            return false;
+        }
+
+        m_smoothedGpuTimeMs = (m_smoothedGpuTimeMs <= 0.0f)
+            ? gpuTimeMs
+            : AZ::Lerp(m_smoothedGpuTimeMs, gpuTimeMs, SmoothingFactor);
+
+        if (m_smoothedGpuTimeMs > gpuBudgetMs)
+        {
+            m_underBudgetFrameCount = 0;
+            m_overBudgetFrameCount++;
+            if ((m_overBudgetFrameCount < FramesToDecreaseQuality) || (m_qualityLevelIndex + 1 >= QualityLevelCount))
+            {
+                return false;
+            }
+
+            if (m_framesSinceQualityIncrease < m_framesToIncreaseQuality)
+            {
+                // The last increase didn't fit in the budget. Wait longer before trying again.
+                m_framesToIncreaseQuality = AZStd::min(m_framesToIncreaseQuality * 2, MaxFramesToIncreaseQuality);
+            }
+            m_overBudgetFrameCount = 0;
+            m_qualityLevelIndex++;
+            RestartSmoothing();
+            return true;
+        }
+
+        m_overBudgetFrameCount = 0;
+        if (m_smoothedGpuTimeMs > (gpuBudgetMs * HeadroomFraction))
+        {
+            m_underBudgetFrameCount = 0;
+            return false;
+        }
+
+        m_underBudgetFrameCount++;
+        if ((m_underBudgetFrameCount < m_framesToIncreaseQuality) || (m_qualityLevelIndex == 0))
+        {
+            return false;
+        }
+
+        m_underBudgetFrameCount = 0;
+        m_framesSinceQualityIncrease = 0;
+        m_qualityLevelIndex--;
+        RestartSmoothing();
+        return true;
+    }
+
+    void CloudscapeQualityController::RestartSmoothing()
+    {
+        // Otherwise the old level would keep the smoothed time over budget for many frames,
+        // and a single spike would drop more than one level.
+        m_smoothedGpuTimeMs = 0.0f;
+        m_staleSampleCount = TimestampLatencyFrames;
+    }
+
+    const CloudscapeQualityController::QualityLevel& CloudscapeQualityController::GetQualityLevel() const
+    {
+        return QualityLevels[m_qualityLevelIndex];
+    }
+
+} // namespace VolumetricClouds
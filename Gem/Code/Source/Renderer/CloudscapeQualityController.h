@@ -0,0 +1,77 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/base.h>
+
+namespace VolumetricClouds
+{
+    //! Picks a cloud quality level so the GPU time of the Cloudscape passes stays
+    //! within a budget. The cost of the clouds changes a lot with the weather
+    //! (clear vs overcast skies), and with how much of the horizon is visible,
+    //! so fixed ray marching steps are either too slow or too ugly.
+    //! The controller only moves one level at a time, and uses hysteresis to avoid flickering:
+    //! - After a level change, the GPU times still in flight are ignored and the smoothed
+    //!   GPU time restarts from the first time measured at the new level.
+    //! - Quality is reduced quickly, after a few consecutive frames over budget.
+    //! - Quality is increased slowly, after many consecutive frames with enough headroom.
+    //!   If an increase has to be reverted shortly after, the wait before the next
+    //!   increase is doubled.
+    class CloudscapeQualityController final
+    {
+    public:
+        struct QualityLevel
+        {
+            // Scales CloudscapeShaderConstantData::m_minRayMarchingSteps and m_maxRayMarchingSteps.
+            float m_rayMarchingStepsScale;
+            // Added to the starting mip level of the noise textures.
+            float m_mipLevelBias;
+            // Multiplies CloudscapeRenderSettings::m_skyViewSliceCount.
+            uint32_t m_skyViewSliceCountMultiplier;
+        };
+
+        CloudscapeQualityController() = default;
+        ~CloudscapeQualityController() = default;
+
+        // Goes back to the highest quality level.
+        void Reset();
+
+        // @gpuTimeMs is the most recent measured GPU time of the Cloudscape passes.
+        // Returns true if the quality level changed.
+        bool Update(float gpuTimeMs, float gpuBudgetMs);
+
+        const QualityLevel& GetQualityLevel() const;
+        uint32_t GetQualityLevelIndex() const { return m_qualityLevelIndex; }
+        float GetSmoothedGpuTimeMs() const { return m_smoothedGpuTimeMs; }
+
+    private:
+        // Discards the smoothed GPU time of the previous level.
+        void RestartSmoothing();
+
+        // Weight of the newest sample in the exponential moving average of the GPU time.
+        static constexpr float SmoothingFactor = 0.1f;
+        // To increase quality the smoothed GPU time must be below this fraction of the budget.
+        static constexpr float HeadroomFraction = 0.75f;
+        static constexpr uint32_t FramesToDecreaseQuality = 8;
+        static constexpr uint32_t MinFramesToIncreaseQuality = 60;
+        static constexpr uint32_t MaxFramesToIncreaseQuality = 960;
+        // Frames between a pass being dispatched and its timestamps being read back.
+        static constexpr uint32_t TimestampLatencyFrames = 3;
+
+        uint32_t m_qualityLevelIndex = 0; // 0 is the highest quality.
+        float m_smoothedGpuTimeMs = 0.0f;
+        // GPU times measured before the last level change, that are yet to be read back.
+        uint32_t m_staleSampleCount = 0;
+        uint32_t m_overBudgetFrameCount = 0;
+        uint32_t m_underBudgetFrameCount = 0;
+        uint32_t m_framesToIncreaseQuality = MinFramesToIncreaseQuality;
+        // Frames since the quality was increased. Used to detect oscillations.
+        uint32_t m_framesSinceQualityIncrease = MaxFramesToIncreaseQuality;
+    };
+
+} // namespace VolumetricClouds
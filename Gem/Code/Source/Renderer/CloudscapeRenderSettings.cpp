@@ -0,0 +1,165 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzCore/Serialization/SerializeContext.h>
+#include <AzCore/Serialization/EditContext.h>
+
+#include <VolumetricClouds/VolumetricCloudsTypeIds.h>
+#include "CloudscapeRenderSettings.h"
+
+namespace VolumetricClouds
+{
+    AZ_CLASS_ALLOCATOR_IMPL(CloudscapeRenderSettings, AZ::SystemAllocator);
+    AZ_TYPE_INFO_WITH_NAME_IMPL(CloudscapeRenderSettings, "VolumetricClouds::CloudscapeRenderSettings", CloudscapeRenderSettingsTypeId);
+    AZ_RTTI_NO_TYPE_INFO_IMPL(CloudscapeRenderSettings);
+
+    void CloudscapeRenderSettings::Reflect(AZ::ReflectContext* context)
+    {
+        if (auto serializeContext = azrtti_cast<AZ::SerializeContext*>(context))
+        {
+            serializeContext->Class<CloudscapeRenderSettings>()
+                ->Version(1)
+                ->Field("EnableConvergence", &CloudscapeRenderSettings::m_enableConvergence)
+                ->Field("ConvergenceSampleCount", &CloudscapeRenderSettings::m_convergenceSampleCount)
+                ->Field("EnableSkyView", &CloudscapeRenderSettings::m_enableSkyView)
+                ->Field("SkyViewStartDistanceKm", &CloudscapeRenderSettings::m_skyViewStartDistanceKm)
+                ->Field("SkyViewSliceCount", &CloudscapeRenderSettings::m_skyViewSliceCount)
+                ->Field("EnableDynamicQuality", &CloudscapeRenderSettings::m_enableDynamicQuality)
+                ->Field("GpuBudgetMs", &CloudscapeRenderSettings::m_gpuBudgetMs)
+                ->Field("EnableStereoReprojection", &CloudscapeRenderSettings::m_enableStereoReprojection)
+                ->Field("EnableAsyncCompute", &CloudscapeRenderSettings::m_enableAsyncCompute)
+                ->Field("EnableCloudDepthOutput", &CloudscapeRenderSettings::m_enableCloudDepthOutput)
+                ->Field("EnableCompactHistory", &CloudscapeRenderSettings::m_enableCompactHistory)
+                ->Field("EnableHdrOutput", &CloudscapeRenderSettings::m_enableHdrOutput)
+                ->Field("EnableFusedComposite", &CloudscapeRenderSettings::m_enableFusedComposite)
+                ->Field("EnableCloudShadowMap", &CloudscapeRenderSettings::m_enableCloudShadowMap)
+                ->Field("CloudShadowMapResolution", &CloudscapeRenderSettings::m_cloudShadowMapResolution)
+                ->Field("CloudShadowMapSunAngleThresholdDegrees", &CloudscapeRenderSettings::m_cloudShadowMapSunAngleThresholdDegrees)
+                ->Field("CloudShadowMapWindThresholdMeters", &CloudscapeRenderSettings::m_cloudShadowMapWindThresholdMeters)
+                ;
+
+            if (auto editContext = serializeContext->GetEditContext())
+            {
+                editContext->Class<CloudscapeRenderSettings>(
+                    "Render Settings", "Controls how the Cloudscape passes are scheduled.")
+                    ->ClassElement(AZ::Edit::ClassElements::EditorData, "")
+                    ->Attribute(AZ::Edit::Attributes::AutoExpand, true)
+                    ->Attribute(AZ::Edit::Attributes::Visibility, AZ::Edit::PropertyVisibility::Show)
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableConvergence, "Enable Convergence",
+                        "When the view, the sun and the cloud parameters are static, and there's no wind, accumulate samples per pixel and then stop ray marching until something changes.")
+                        ->Attribute(AZ::Edit::Attributes::ChangeNotify, AZ::Edit::PropertyRefreshLevels::AttributesAndValues)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_convergenceSampleCount, "Convergence Samples",
+                        "Number of ray marched samples accumulated per pixel before the clouds are considered converged. Each sample takes 16 frames.")
+                        ->Attribute(AZ::Edit::Attributes::Min, 1)
+                        ->Attribute(AZ::Edit::Attributes::Max, 16)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsConvergenceDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableSkyView, "Enable Sky View",
+                        "Far away clouds are ray marched into a low resolution latitude/longitude texture, refreshed in slices across frames, instead of per pixel.")
+                        ->Attribute(AZ::Edit::Attributes::ChangeNotify, AZ::Edit::PropertyRefreshLevels::AttributesAndValues)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_skyViewStartDistanceKm, "Sky View Start Distance Km",
+                        "Clouds that start farther than this distance from the camera are read from the sky-view texture.")
+                        ->Attribute(AZ::Edit::Attributes::Min, 1.0)
+                        ->Attribute(AZ::Edit::Attributes::Max, 50.0)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsSkyViewDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_skyViewSliceCount, "Sky View Slices",
+                        "The sky-view texture is fully refreshed every this many frames. Dynamic quality can multiply this value, only while Sky View is enabled.")
+                        ->Attribute(AZ::Edit::Attributes::Min, 1)
+                        ->Attribute(AZ::Edit::Attributes::Max, 16)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsSkyViewDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableDynamicQuality, "Enable Dynamic Quality",
+                        "Measures the GPU time of the cloud passes and lowers or raises the ray marching quality to stay within the GPU budget. The number of frames used to refresh the sky-view texture is only adjusted when Sky View is enabled.")
+                        ->Attribute(AZ::Edit::Attributes::ChangeNotify, AZ::Edit::PropertyRefreshLevels::AttributesAndValues)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_gpuBudgetMs, "GPU Budget ms",
+                        "Target GPU time, in milliseconds, of the cloud ray marching passes, per pixel and sky-view, plus the history reprojection, including the fused composite pass when it is enabled.")
+                        ->Attribute(AZ::Edit::Attributes::Min, 0.1)
+                        ->Attribute(AZ::Edit::Attributes::Max, 16.0)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsDynamicQualityDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableStereoReprojection, "Enable Stereo Reprojection",
+                        "In XR, ray march the clouds for the left eye only and reproject them into the right eye.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableAsyncCompute, "Enable Async Compute",
+                        "Submit the cloud ray marching to the compute queue so it can overlap with graphics work. Runs on the graphics queue when the device has no separate compute queue.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableCloudDepthOutput, "Enable Cloud Depth Output",
+                        "Write the distance to the clouds per pixel. Improves reprojection when the camera moves fast.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableCompactHistory, "Enable Compact History",
+                        "Keep a single full resolution cloud history plus a quarter resolution buffer with the new samples. Uses less memory and bandwidth, but the clouds are noisier while the camera moves. The fused composite is not used while this is enabled.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableHdrOutput, "Enable HDR Output",
+                        "Store the cloud color in a floating point format, so very bright clouds are not clamped.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableFusedComposite, "Enable Fused Composite",
+                        "Reproject the clouds in the same full screen pass that blends them over the scene. Saves memory bandwidth. Ignored with compact history.")
+                    ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeRenderSettings::m_enableCloudShadowMap, "Enable Cloud Shadow Map",
+                        "Render a top-down map of the cloud shadows around the camera, that terrain, foliage and fog can sample instead of ray marching the clouds.")
+                        ->Attribute(AZ::Edit::Attributes::ChangeNotify, AZ::Edit::PropertyRefreshLevels::AttributesAndValues)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_cloudShadowMapResolution, "Cloud Shadow Map Resolution",
+                        "Texels per side of the cloud shadow map, which covers the area of the weather map.")
+                        ->Attribute(AZ::Edit::Attributes::Min, 64)
+                        ->Attribute(AZ::Edit::Attributes::Max, 2048)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsCloudShadowMapDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_cloudShadowMapSunAngleThresholdDegrees, "Cloud Shadow Sun Threshold",
+                        "The cloud shadow map is re-rendered when the sun rotates more than this angle.")
+                        ->Attribute(AZ::Edit::Attributes::Suffix, " deg")
+                        ->Attribute(AZ::Edit::Attributes::Min, 0.0)
+                        ->Attribute(AZ::Edit::Attributes::Max, 10.0)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsCloudShadowMapDisabled)
+                    ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeRenderSettings::m_cloudShadowMapWindThresholdMeters, "Cloud Shadow Wind Threshold",
+                        "The cloud shadow map is re-rendered when the wind moves the clouds farther than this distance. In between, the shadows are shifted with the wind.")
+                        ->Attribute(AZ::Edit::Attributes::Suffix, " m")
+                        ->Attribute(AZ::Edit::Attributes::Min, 0.0)
+                        ->Attribute(AZ::Edit::Attributes::Max, 5000.0)
+                        ->Attribute(AZ::Edit::Attributes::ReadOnly, &CloudscapeRenderSettings::IsCloudShadowMapDisabled)
+                    ;
+            }
+        }
+    }
+
+    bool CloudscapeRenderSettings::operator==(const CloudscapeRenderSettings& rhs) const
+    {
+        return (m_enableConvergence == rhs.m_enableConvergence) &&
+               (m_convergenceSampleCount == rhs.m_convergenceSampleCount) &&
+               (m_enableSkyView == rhs.m_enableSkyView) &&
+               (m_skyViewStartDistanceKm == rhs.m_skyViewStartDistanceKm) &&
+               (m_skyViewSliceCount == rhs.m_skyViewSliceCount) &&
+               (m_enableDynamicQuality == rhs.m_enableDynamicQuality) &&
+               (m_gpuBudgetMs == rhs.m_gpuBudgetMs) &&
+               (m_enableStereoReprojection == rhs.m_enableStereoReprojection) &&
+               (m_enableAsyncCompute == rhs.m_enableAsyncCompute) &&
+               (m_enableCloudDepthOutput == rhs.m_enableCloudDepthOutput) &&
+               (m_enableCompactHistory == rhs.m_enableCompactHistory) &&
+               (m_enableHdrOutput == rhs.m_enableHdrOutput) &&
+               (m_enableFusedComposite == rhs.m_enableFusedComposite) &&
+               (m_enableCloudShadowMap == rhs.m_enableCloudShadowMap) &&
+               (m_cloudShadowMapResolution == rhs.m_cloudShadowMapResolution) &&
+               (m_cloudShadowMapSunAngleThresholdDegrees == rhs.m_cloudShadowMapSunAngleThresholdDegrees) &&
+               (m_cloudShadowMapWindThresholdMeters == rhs.m_cloudShadowMapWindThresholdMeters)
+               ;
+    }
+
+    bool CloudscapeRenderSettings::operator!=(const CloudscapeRenderSettings& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    bool CloudscapeRenderSettings::IsConvergenceDisabled() const
+    {
+        return !m_enableConvergence;
+    }
+
+    bool CloudscapeRenderSettings::IsSkyViewDisabled() const
+    {
+        return !m_enableSkyView;
+    }
+
+    bool CloudscapeRenderSettings::IsDynamicQualityDisabled() const
+    {
+        return !m_enableDynamicQuality;
+    }
+
+    bool CloudscapeRenderSettings::IsCloudShadowMapDisabled() const
+    {
+        return !m_enableCloudShadowMap;
+    }
+
+} // namespace VolumetricClouds
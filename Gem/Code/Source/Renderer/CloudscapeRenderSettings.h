@@ -0,0 +1,115 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#pragma once
+
+#include <AzCore/RTTI/TypeInfoSimple.h>
+#include <AzCore/Memory/SystemAllocator.h>
+
+namespace VolumetricClouds
+{
+    // Settings that change how the Cloudscape passes are scheduled,
+    // as opposed to CloudscapeShaderConstantData which changes the look of the clouds.
+    struct CloudscapeRenderSettings
+    {
+        AZ_CLASS_ALLOCATOR_DECL;
+        AZ_TYPE_INFO_WITH_NAME_DECL(CloudscapeRenderSettings);
+        AZ_RTTI_NO_TYPE_INFO_DECL();
+
+        static void Reflect(AZ::ReflectContext* reflection);
+
+        bool operator==(const CloudscapeRenderSettings& rhs) const;
+        bool operator!=(const CloudscapeRenderSettings& rhs) const;
+
+        // Used by the Edit Context.
+        bool IsConvergenceDisabled() const;
+        bool IsSkyViewDisabled() const;
+        bool IsDynamicQualityDisabled() const;
+        bool IsCloudShadowMapDisabled() const;
+
+        // Each frame only 1 out of 16 pixels is ray marched. When the camera, the sun
+        // and all the shader constants remain static, and the wind speed is zero, the ray marched pixels
+        // are blended with the history, with a different jitter offset, until each pixel
+        // accumulates @m_convergenceSampleCount samples. After that the ray marching
+        // and reprojection passes stop being dispatched, and the last result is reused
+        // until something changes. Opt-in, because it changes the look of the accumulation
+        // and the GPU timings of a static view.
+        bool m_enableConvergence = false;
+        uint32_t m_convergenceSampleCount = 4;
+
+        // When enabled, clouds that start farther than @m_skyViewStartDistanceKm are
+        // ray marched into a low resolution latitude/longitude texture instead of per pixel.
+        // This texture is refreshed in @m_skyViewSliceCount vertical slices, one slice per frame.
+        // Horizon heavy views are the most expensive to ray march, and
+        // most of their pixels are far away clouds.
+        bool m_enableSkyView = false;
+        float m_skyViewStartDistanceKm = 8.0f;
+        uint32_t m_skyViewSliceCount = 8;
+
+        // When enabled, the GPU time of the Cloudscape compute passes is measured each frame
+        // and the ray marching steps, noise textures mip bias and sky-view amortization
+        // are adjusted to stay within @m_gpuBudgetMs. The ray marching steps in
+        // CloudscapeShaderConstantData become the highest quality.
+        // The sky-view amortization only applies when @m_enableSkyView is on, the per pixel
+        // ray march is always amortized over the same 16 frames.
+        // The budget covers the ray marching passes, per pixel and sky-view, plus the history reprojection,
+        // whether it runs in its own compute pass or in the fused composite pass. The plain composite pass
+        // is not included, its cost doesn't depend on the quality level.
+        bool m_enableDynamicQuality = false;
+        float m_gpuBudgetMs = 2.0f;
+
+        // Only affects stereo (XR) render pipeline pairs. The clouds are ray marched for the left eye
+        // only, and reprojected by view direction into the right eye. The clouds are kilometers away,
+        // so the disparity between the eyes is sub-pixel. The strip of the right eye that the left eye
+        // doesn't see is still ray marched. Only used when the render pipeline of the left eye
+        // was added to the scene before the one of the right eye, otherwise both eyes are ray marched.
+        bool m_enableStereoReprojection = false;
+
+        // When enabled, the ray marching passes are submitted to the compute hardware queue, so they can
+        // overlap with the graphics work that doesn't depend on their attachments. On devices without a separate
+        // compute queue the RHI runs them on the graphics queue, see CloudscapeComputePass::SetAsyncComputeEnabled().
+        bool m_enableAsyncCompute = false;
+
+        // When enabled, the transmittance weighted distance to the clouds is written per pixel
+        // to an R16F attachment, exposed by the "CloudDepth" slot of CloudscapeComputePass.
+        // The reprojection pass uses it instead of assuming the clouds are in the middle of the cloud slab.
+        bool m_enableCloudDepthOutput = false;
+
+        // When enabled, there's a single full resolution history attachment, updated in place by the
+        // reprojection pass, plus a quarter by quarter resolution attachment with the pixels ray marched
+        // in the current frame. Saves memory and bandwidth compared to the two full resolution
+        // ping-pong attachments. Because the history is updated in place, each thread group of the reprojection
+        // pass copies the history of its 16x16 tile before writing it, and a pixel whose reprojected history belongs to
+        // another tile starts over from the fresh samples, like a pixel that comes from outside of the screen.
+        // While the camera moves, pixels near the tile borders lose their history more often, so the clouds
+        // are noisier than with the ping-pong attachments. The fused composite is not used while this is enabled.
+        bool m_enableCompactHistory = false;
+
+        // When enabled, the cloud color is stored as R11G11B10_FLOAT, which doesn't clamp bright
+        // scattered sunlight, and the alpha goes to a separate R8 attachment. Same bandwidth as R8G8B8A8_UNORM.
+        bool m_enableHdrOutput = false;
+
+        // When enabled, the history is reprojected inside the full screen pass that composites the clouds,
+        // see CloudscapeFusedComposite.azsl, and the reprojection compute pass doesn't run. Saves one
+        // full screen read and write of the history and one depth read per frame. The pixel shader
+        // writes the history through UAVs, which some tile based GPUs handle poorly. Ignored while
+        // @m_enableCompactHistory is enabled.
+        bool m_enableFusedComposite = false;
+
+        // When enabled, a top-down map with the transmittance towards the sun through the clouds,
+        // @m_cloudShadowMapResolution texels per side, is rendered over the area of the weather map
+        // around the camera. It is exposed by the "CloudShadowMap" slot of CloudscapeShadowMapComputePass and
+        // bound to SceneSrg::m_cloudShadowMap, see CloudShadowMapSceneSrg.azsli. It is only re-rendered when the sun
+        // rotates more than @m_cloudShadowMapSunAngleThresholdDegrees, the wind moves the clouds more than
+        // @m_cloudShadowMapWindThresholdMeters, the camera leaves the center of the map or the clouds change.
+        bool m_enableCloudShadowMap = false;
+        uint32_t m_cloudShadowMapResolution = 512;
+        float m_cloudShadowMapSunAngleThresholdDegrees = 0.5f;
+        float m_cloudShadowMapWindThresholdMeters = 200.0f;
+    };
+
+} // namespace VolumetricClouds
@@ -18,6 +18,19 @@ namespace VolumetricClouds
     AZ_TYPE_INFO_WITH_NAME_IMPL(CloudscapeShaderConstantData, "VolumetricClouds::CloudscapeShaderConstantData", CloudscapeShaderConstantDataTypeId);
     AZ_RTTI_NO_TYPE_INFO_IMPL(CloudscapeShaderConstantData);
 
+    // Version 2 removed the ambient light color and intensity, the ambient light now comes
+    // from CloudSkyIrradiance. Their values are dropped.
+    static bool ConvertCloudscapeShaderConstantData(
+        [[maybe_unused]] AZ::SerializeContext& context, AZ::SerializeContext::DataElementNode& classElement)
+    {
+        if (classElement.GetVersion() < 2)
+        {
+            classElement.RemoveElementByName(AZ_CRC_CE("AmbientLightColor"));
+            classElement.RemoveElementByName(AZ_CRC_CE("AmbientLightIntensity"));
+        }
+        return true;
+    }
+
     void CloudscapeShaderConstantData::Reflect(AZ::ReflectContext* context)
     {
         CloudMaterialProperties::Reflect(context);
@@ -25,7 +38,7 @@ namespace VolumetricClouds
         if (auto serializeContext = azrtti_cast<AZ::SerializeContext*>(context))
         {
             serializeContext->Class<CloudscapeShaderConstantData>()
-                ->Version(1)
+                ->Version(2, &ConvertCloudscapeShaderConstantData)
                 ->Field("UVWScale", &CloudscapeShaderConstantData::m_uvwScale)
                 ->Field("MaxMipLevels", &CloudscapeShaderConstantData::m_maxMipLevels)
                 ->Field("MinRayMarchingSteps", &CloudscapeShaderConstantData::m_minRayMarchingSteps)
@@ -34,8 +47,6 @@ namespace VolumetricClouds
                 ->Field("CloudSlabDistanceAboveSeaLevelKm", &CloudscapeShaderConstantData::m_cloudSlabDistanceAboveSeaLevelKm)
                 ->Field("CloudSlabThicknessKm", &CloudscapeShaderConstantData::m_cloudSlabThicknessKm)
                 ->Field("SunLightIntensity", &CloudscapeShaderConstantData::m_sunLightIntensity)
-                ->Field("AmbientLightColor", &CloudscapeShaderConstantData::m_ambientLightColor)
-                ->Field("AmbientLightIntensity", &CloudscapeShaderConstantData::m_ambientLightIntensity)
                 ->Field("WeatherMapSizeKm", &CloudscapeShaderConstantData::m_weatherMapSizeKm)
                 ->Field("GlobalCloudCoverage", &CloudscapeShaderConstantData::m_globalCloudCoverage)
                 ->Field("GlobalCloudDensity", &CloudscapeShaderConstantData::m_globalCloudDensity)
@@ -81,10 +92,6 @@ namespace VolumetricClouds
                         ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeShaderConstantData::m_sunLightIntensity, "Sun Light Intensity", "A scaling factor to the color of the sun light.")
                             ->Attribute(AZ::Edit::Attributes::Min, 0.0)
                             ->Attribute(AZ::Edit::Attributes::Max, 100.0)
-                        ->DataElement(AZ::Edit::UIHandlers::Default, &CloudscapeShaderConstantData::m_ambientLightColor, "Ambient Light Color", "The ambient light color, which will be modulated by the Sun Light Color.")
-                        ->DataElement(AZ::Edit::UIHandlers::Slider, &CloudscapeShaderConstantData::m_ambientLightIntensity, "Ambient Light Intensity", "A scaling factor to the color of the ambient light. It will be modulated by the Sun Light Intensity.")
-                            ->Attribute(AZ::Edit::Attributes::Min, 0.0)
-                            ->Attribute(AZ::Edit::Attributes::Max, 10.0)
                     ->EndGroup()
                     ->ClassElement(AZ::Edit::ClassElements::Group, "Weather Data")
                     ->Attribute(AZ::Edit::Attributes::AutoExpand, true)
@@ -126,8 +133,6 @@ namespace VolumetricClouds
                AZ::IsClose(m_cloudSlabThicknessKm, rhs.m_cloudSlabThicknessKm) &&
                AZ::IsClose(m_weatherMapSizeKm, rhs.m_weatherMapSizeKm) &&
                AZ::IsClose(m_sunLightIntensity, rhs.m_sunLightIntensity) &&
-               m_ambientLightColor.IsClose(rhs.m_ambientLightColor) &&
-               AZ::IsClose(m_ambientLightIntensity, rhs.m_ambientLightIntensity) &&
                AZ::IsClose(m_globalCloudCoverage, rhs.m_globalCloudCoverage) &&
                AZ::IsClose(m_globalCloudDensity, rhs.m_globalCloudDensity) &&
                AZ::IsClose(m_windSpeedKmPerSec, rhs.m_windSpeedKmPerSec) &&
@@ -142,4 +147,17 @@ namespace VolumetricClouds
         return !(*this == rhs);
     }
 
+    AZ::Vector3 CloudscapeShaderConstantData::GetNormalizedWindDirection() const
+    {
+        const float windDirectionLength = m_windDirection.GetLength();
+        return AZ::IsClose(windDirectionLength, 0.0f, 0.01f)
+            ? AZ::Vector3::CreateZero()
+            : (m_windDirection / windDirectionLength);
+    }
+
+    AZ::Vector3 CloudscapeShaderConstantData::GetWindVelocityKmPerSec() const
+    {
+        return (GetNormalizedWindDirection() + AZ::Vector3(0.0f, 0.0f, 0.1f)) * m_windSpeedKmPerSec;
+    }
+
 } // namespace VolumetricClouds
@@ -14,6 +14,7 @@
 #include <Atom/RPI.Reflect/Image/Image.h>
 
 #include <Renderer/CloudMaterialProperties.h>
+#include <Renderer/CloudSkyIrradiance.h>
 
 namespace VolumetricClouds
 {
@@ -34,6 +35,11 @@ namespace VolumetricClouds
         bool operator==(const CloudscapeShaderConstantData& rhs) const;
         bool operator!=(const CloudscapeShaderConstantData& rhs) const;
 
+        // @m_windDirection normalized, or zero when it is too short to be normalized. This is what the shaders get.
+        AZ::Vector3 GetNormalizedWindDirection() const;
+        // How far the wind moves the clouds per second, with a small bias upwards.
+        AZ::Vector3 GetWindVelocityKmPerSec() const;
+
         // Used to scale world position XYZ when sampling
         // the Noise Textures during ray marching.
         float m_uvwScale = 0.25;
@@ -61,8 +67,8 @@ namespace VolumetricClouds
 
         AZ::Vector3 m_sunColor = { 1.0f, 1.0f, 1.0f }; // DO NOT REFLECT (comes from an entity)
         float m_sunLightIntensity = 1.0f;
-        AZ::Color m_ambientLightColor = { 1.0f, 1.0f, 1.0f, 1.0f };
-        float m_ambientLightIntensity = 1.0f;
+        // The ambient light comes from the sky and from the ground, and is scaled by the sun light color and intensity.
+        CloudSkyIrradiance m_skyIrradiance; // DO NOT REFLECT (calculated by CloudscapeFeatureProcessor)
         // The shader expects a normalized vector.
         AZ::Vector3 m_directionTowardsTheSun = {0.0f, 0.0f, 1.0f}; // DO NOT REFLECT (comes from an entity)
 
@@ -104,6 +110,9 @@ namespace VolumetricClouds
         // or from a file (StreamingImage)
 
         AZ::Data::Instance<AZ::RPI::Image> m_highFrequencyNoiseTexture; // DO NOT REFLECT (comes from an entity)
+
+        // Phase function of each multiple scattering octave, indexed by the angle towards the sun.
+        AZ::Data::Instance<AZ::RPI::Image> m_phaseFunctionLut; // DO NOT REFLECT (generated by CloudscapeFeatureProcessor, see CloudPhaseFunctionLut)
     };
 
 } // namespace VolumetricClouds
@@ -16,6 +16,7 @@
 #include <Atom/RPI.Public/View.h>
 #include <Atom/RPI.Reflect/Shader/ShaderAsset.h>
 
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 #include "CloudTextureComputePass.h"
 
 
@@ -90,19 +91,57 @@ namespace VolumetricClouds
 
     void CloudTextureComputePass::FrameBeginInternal(FramePrepareParams params)
     {
+        if (m_isFinished)
+        {
+            // Only waiting for the GPU queries. Without a scope nothing is dispatched again,
+            // but FrameEndInternal() keeps reading back the queries of the dispatch.
+            return;
+        }
         AZ::RPI::RenderPass::FrameBeginInternal(params);
     }
 
     void CloudTextureComputePass::FrameEndInternal()
     {
+        // Reads back the results of the queries from previous frames.
+        AZ::RPI::ComputePass::FrameEndInternal();
+
         if (!m_texture3DAttachment)
         {
             return;
         }
 
+        // The Texture3D is generated with a single dispatch.
         m_isFinished = true;
 
-        SetEnabled(false);
+        if (m_isWaitingForGpuQueries)
+        {
+            const bool isResolved = GetLatestTimestampResult().GetDurationInNanoseconds() > 0;
+            if (isResolved)
+            {
+                if (auto statsCollector = VolumetricCloudsStatsCollector::Get())
+                {
+                    statsCollector->AddGpuPassSample(StatsScope::CloudTextureComputeGpu, *this);
+                }
+            }
+            if (isResolved || (++m_gpuQueryWaitFrames >= MaxGpuQueryWaitFrames))
+            {
+                m_isWaitingForGpuQueries = false;
+            }
+        }
+
+        if (!m_isWaitingForGpuQueries)
+        {
+            // From now on IsEnabled() returns false, so this pass is skipped until the owning pipeline is removed.
+            SetEnabled(false);
+        }
+    }
+
+    void CloudTextureComputePass::SetGpuQueriesEnabled(bool enable)
+    {
+        SetTimestampQueryEnabled(enable);
+        SetPipelineStatisticsQueryEnabled(enable);
+        m_isWaitingForGpuQueries = enable;
+        m_gpuQueryWaitFrames = 0;
     }
 
     void CloudTextureComputePass::SetupFrameGraphDependencies(AZ::RHI::FrameGraphInterface frameGraph)
@@ -137,6 +176,7 @@ namespace VolumetricClouds
 
     void CloudTextureComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
     {
+        ScopedCpuStatsTimer statsTimer(StatsScope::CloudTextureComputeCompileCpu);
         if (m_texture3DAttachment)
         {
             const auto& computeData = m_computeData;
@@ -164,7 +204,7 @@ namespace VolumetricClouds
             return false;
         }
 
-        return !m_isFinished && m_texture3DAttachment;
+        return !IsFinished() && m_texture3DAttachment;
     }
 
     bool CloudTextureComputePass::SetRenderData(AZ::Data::Instance<AZ::RPI::AttachmentImage> texture3DAttachment,
@@ -44,7 +44,15 @@ namespace VolumetricClouds
         // Returns true (success) if the size of the texture3DAttachment is within the limits, etc.
         bool SetRenderData(AZ::Data::Instance<AZ::RPI::AttachmentImage> texture3DAttachment,
                            CloudTextureComputeData computeData);
-        bool IsFinished() { return m_isFinished; }
+        // The pipeline can be removed once the Texture3D is generated and the GPU queries,
+        // if enabled, have been read back.
+        bool IsFinished() const { return m_isFinished && !m_isWaitingForGpuQueries; }
+
+        // When enabled, the timestamp and pipeline statistics of the single dispatch are reported
+        // to VolumetricCloudsStatsCollector. The results are only available a few frames later,
+        // so after the dispatch the pass stays in the pipeline, without a scope, and polls them
+        // up to MaxGpuQueryWaitFrames.
+        void SetGpuQueriesEnabled(bool enable);
 
         //! Besides the standard enable flag,
         //! The pass is disabled .
@@ -81,6 +89,10 @@ namespace VolumetricClouds
         // This pass runs in one frame, and when done this becomes true.
         bool m_isFinished = false;
 
+        static constexpr uint32_t MaxGpuQueryWaitFrames = 8;
+        bool m_isWaitingForGpuQueries = false;
+        uint32_t m_gpuQueryWaitFrames = 0;
+
         AZ::Data::Instance<AZ::RPI::AttachmentImage> m_texture3DAttachment;
         CloudTextureComputeData m_computeData;
     };
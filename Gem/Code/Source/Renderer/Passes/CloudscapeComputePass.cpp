@@ -5,6 +5,9 @@
 *
 */
 
+#include <AzCore/Math/Vector4.h>
+#include <AzCore/std/algorithm.h>
+
 #include <Atom/RPI.Public/RenderPipeline.h>
 #include <Atom/RPI.Public/View.h>
 #include <Atom/RPI.Public/Scene.h>
@@ -12,10 +15,15 @@
 #include <Atom/RPI.Public/Pass/PassSystem.h>
 #include <Atom/RPI.Public/Image/AttachmentImagePool.h>
 #include <Atom/RPI.Public/Image/ImageSystemInterface.h>
+#include <Atom/RPI.Public/Pass/PassUtils.h>
+#include <Atom/RPI.Reflect/Asset/AssetUtils.h>
+#include <Atom/RPI.Reflect/Pass/ComputePassData.h>
 
 #include <Atom/RHI/FrameScheduler.h>
 #include <Atom/RHI/PipelineState.h>
 
+#include <VolumetricClouds_Traits_Platform.h>
+
 #include <Renderer/CloudscapeFeatureProcessor.h>
 #include "CloudscapeComputePass.h"
 
@@ -24,9 +32,37 @@ namespace VolumetricClouds
     
     AZ::RPI::Ptr<CloudscapeComputePass> CloudscapeComputePass::Create(const AZ::RPI::PassDescriptor& descriptor)
     {
+#if AZ_TRAIT_VOLUMETRICCLOUDS_USE_HALF_PRECISION_RAYMARCH
+        AZ::RPI::Ptr<CloudscapeComputePass> pass = aznew CloudscapeComputePass(CreateHalfPrecisionDescriptor(descriptor));
+#else
         AZ::RPI::Ptr<CloudscapeComputePass> pass = aznew CloudscapeComputePass(descriptor);
+#endif
         return pass;
     }
+
+    AZ::RPI::PassDescriptor CloudscapeComputePass::CreateHalfPrecisionDescriptor(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        auto passData = AZ::RPI::PassUtils::GetPassData<AZ::RPI::ComputePassData>(descriptor);
+        if (!passData)
+        {
+            AZ_Error(LogName, false, "%s Failed to find the ComputePassData. Will use the full precision shader.", __FUNCTION__);
+            return descriptor;
+        }
+
+        const auto shaderAssetId = AZ::RPI::AssetUtils::GetAssetIdForProductPath(HalfPrecisionShaderProductPath, AZ::RPI::AssetUtils::TraceLevel::Error);
+        if (!shaderAssetId.IsValid())
+        {
+            return descriptor;
+        }
+
+        auto halfPrecisionPassData = AZStd::make_shared<AZ::RPI::ComputePassData>(*passData);
+        halfPrecisionPassData->m_shaderReference.m_assetId = shaderAssetId;
+        halfPrecisionPassData->m_shaderReference.m_filePath = HalfPrecisionShaderFilePath;
+
+        AZ::RPI::PassDescriptor halfPrecisionDescriptor = descriptor;
+        halfPrecisionDescriptor.m_passData = halfPrecisionPassData;
+        return halfPrecisionDescriptor;
+    }
     
     CloudscapeComputePass::CloudscapeComputePass(const AZ::RPI::PassDescriptor& descriptor)
         : AZ::RPI::ComputePass(descriptor)
@@ -43,14 +79,20 @@ namespace VolumetricClouds
     {
         AZ::RPI::ComputePass::InitializeInternal();
 
-        m_srgNeedsUpdate = (m_shaderConstantData != nullptr);
+        // The shader resource group is new, nothing has been uploaded to it yet.
+        m_isConstantsLayoutValid = ValidateConstantsLayout();
+        m_shaderDataNeedsUpdate = true;
+        m_constantsNeedUpdate = true;
+        m_imagesNeedUpdate = true;
+        m_boundImages = {};
 
         //InitializeShaderVariant();
     }
 
-    void CloudscapeComputePass::SetImageAttachmentBinding(uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage)
+    void CloudscapeComputePass::SetImageAttachmentBinding(const char* slotNamePrefix, const char* shaderInputName,
+        uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage)
     {
-        const AZStd::string slotNameStr = AZStd::string::format("Output%u", attachmentIndex);
+        const AZStd::string slotNameStr = AZStd::string::format("%s%u", slotNamePrefix, attachmentIndex);
         const auto slotName = AZ::Name(slotNameStr);
         auto binding = FindAttachmentBinding(slotName);
         AZ_Assert(!!binding, "Failed to find attachment binding for slot %s", slotName.GetCStr());
@@ -63,7 +105,7 @@ namespace VolumetricClouds
         // harmless AZ::Errors related with the shaders m_cloudscapeOut[]
         // array binding. The bindings are actually known at runtime and not during
         // AZ::RPI::RenderPass::InitializeInternal().
-        binding->m_shaderInputName = AZ::Name("m_cloudscapeOut");
+        binding->m_shaderInputName = AZ::Name(shaderInputName);
 
         AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(attachmentImage->GetDescriptor().m_format,
             0, 0);
@@ -83,10 +125,64 @@ namespace VolumetricClouds
             return;
         }
 
-        const auto output0ImageAttachment = cloudscapeFeatureProcessor->GetOutput0ImageAttachment();
+        // Each render pipeline has its own attachments.
+        const auto output0ImageAttachment = cloudscapeFeatureProcessor->GetOutput0ImageAttachment(m_pipeline);
+        if (!output0ImageAttachment)
+        {
+            AZ_Error(LogName, false, "The cloudscape attachments of render pipeline %s don't exist", m_pipeline->GetId().GetCStr());
+            return;
+        }
         // Bind the first attachment
-        SetImageAttachmentBinding(0, output0ImageAttachment);
-        SetImageAttachmentBinding(1, cloudscapeFeatureProcessor->GetOutput1ImageAttachment());
+        SetImageAttachmentBinding("Output", "m_cloudscapeOut", 0, output0ImageAttachment);
+        SetImageAttachmentBinding("Output", "m_cloudscapeOut", 1, cloudscapeFeatureProcessor->GetOutput1ImageAttachment(m_pipeline));
+        // Only full size when the HDR output is enabled.
+        SetImageAttachmentBinding("CloudAlpha", "m_cloudscapeAlphaOut", 0, cloudscapeFeatureProcessor->GetCloudAlpha0ImageAttachment(m_pipeline));
+        SetImageAttachmentBinding("CloudAlpha", "m_cloudscapeAlphaOut", 1, cloudscapeFeatureProcessor->GetCloudAlpha1ImageAttachment(m_pipeline));
+
+        // Same as the outputs, the *.pass asset uses "NoBind". This one is only full size while
+        // the ray marching debug view is enabled.
+        {
+            const auto debugStatsImageAttachment = cloudscapeFeatureProcessor->GetRayMarchDebugStatsImageAttachment(m_pipeline);
+            const auto slotName = AZ::Name("RayMarchDebugStats");
+            auto binding = FindAttachmentBinding(slotName);
+            AZ_Assert(!!binding, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+            binding->m_shaderInputName = AZ::Name("m_rayMarchDebugStatsOut");
+            AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(debugStatsImageAttachment->GetDescriptor().m_format,
+                0, 0);
+            binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+            AttachImageToSlot(slotName, debugStatsImageAttachment);
+        }
+
+        // Same as the debug stats, only full size while the cloud depth is enabled.
+        {
+            const auto cloudDepthImageAttachment = cloudscapeFeatureProcessor->GetCloudDepthImageAttachment(m_pipeline);
+            const auto slotName = AZ::Name("CloudDepth");
+            auto binding = FindAttachmentBinding(slotName);
+            AZ_Assert(!!binding, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+            binding->m_shaderInputName = AZ::Name("m_cloudDepthOut");
+            AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(cloudDepthImageAttachment->GetDescriptor().m_format,
+                0, 0);
+            binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+            AttachImageToSlot(slotName, cloudDepthImageAttachment);
+        }
+
+        // The confidence attachments are not read by the ray marching shader, they stay "NoBind".
+        // The pass only owns them for CloudscapeReprojectionComputePass, which connects to these slots.
+        const AZ::Data::Instance<AZ::RPI::AttachmentImage> confidenceImageAttachments[] = {
+            cloudscapeFeatureProcessor->GetConfidence0ImageAttachment(m_pipeline),
+            cloudscapeFeatureProcessor->GetConfidence1ImageAttachment(m_pipeline)
+        };
+        for (uint32_t confidenceIndex = 0; confidenceIndex < 2; ++confidenceIndex)
+        {
+            const auto& confidenceImageAttachment = confidenceImageAttachments[confidenceIndex];
+            const auto slotName = AZ::Name(AZStd::string::format("Confidence%u", confidenceIndex));
+            auto binding = FindAttachmentBinding(slotName);
+            AZ_Assert(!!binding, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+            AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(confidenceImageAttachment->GetDescriptor().m_format,
+                0, 0);
+            binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+            AttachImageToSlot(slotName, confidenceImageAttachment);
+        }
 
         const auto attachmentSize = output0ImageAttachment->GetDescriptor().m_size;
 
@@ -118,65 +214,157 @@ namespace VolumetricClouds
     // }
 
     
+    bool CloudscapeComputePass::ValidateConstantsLayout() const
+    {
+        if (!m_shaderResourceGroup)
+        {
+            return false;
+        }
+
+        struct ConstantLayout
+        {
+            const char* m_name;
+            size_t m_byteOffset;
+        };
+        #define CLOUDSCAPE_CONSTANT_LAYOUT(member) { #member, offsetof(CloudscapeComputeConstants, member) }
+        static constexpr ConstantLayout ConstantLayouts[] = {
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_pixelIndex4x4),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_accumulatedSampleCount),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_uvwScale),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_maxMipLevels),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_minRayMarchingSteps),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_maxRayMarchingSteps),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_planetRadiusKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_cloudSlabDistanceAboveSeaLevelKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_cloudSlabThicknessKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_sunColorAndIntensity),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_ambientLuminanceTop),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_ambientLuminanceBottom),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_directionTowardsTheSun),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_aCoef),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_sCoef),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_henyeyGreensteinG),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_multipleScatteringABC),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_weatherMapSizeKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_globalCloudCoverage),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_globalCloudDensity),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_cloudTopOffsetKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_windDirection),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_skyViewStartDistanceKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_windOffsetKm),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_mipLevelBias),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_rayMarchDebugStatsEnabled),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_cloudDepthEnabled),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_compactHistoryEnabled),
+            CLOUDSCAPE_CONSTANT_LAYOUT(m_hdrOutputEnabled),
+        };
+        #undef CLOUDSCAPE_CONSTANT_LAYOUT
+
+        const auto* srgLayout = m_shaderResourceGroup->GetLayout();
+        for (const auto& constantLayout : ConstantLayouts)
+        {
+            const auto constantIndex = srgLayout->FindShaderInputConstantIndex(AZ::Name(constantLayout.m_name));
+            if (!constantIndex.IsValid())
+            {
+                AZ_Error(LogName, false, "%s: The PassSrg of %s doesn't have the constant %s.", __FUNCTION__,
+                    GetPathName().GetCStr(), constantLayout.m_name);
+                return false;
+            }
+            const auto& constantDescriptor = srgLayout->GetShaderInput(constantIndex);
+            if (constantDescriptor.m_constantByteOffset != constantLayout.m_byteOffset)
+            {
+                AZ_Error(LogName, false, "%s: The constant %s of %s is at byte %u in the shader, but at byte %zu in CloudscapeComputeConstants.",
+                    __FUNCTION__, constantLayout.m_name, GetPathName().GetCStr(), constantDescriptor.m_constantByteOffset,
+                    constantLayout.m_byteOffset);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CloudscapeComputePass::UpdateShaderDataConstants()
+    {
+        m_constants.m_uvwScale = m_shaderConstantData->m_uvwScale;
+        m_constants.m_maxMipLevels = m_shaderConstantData->m_clampedMipLevels;
+
+        const auto scaleSteps = [this](uint32_t steps) -> uint32_t
+        {
+            return AZStd::max(1u, static_cast<uint32_t>(AZStd::round(static_cast<float>(steps) * m_rayMarchingStepsScale)));
+        };
+        m_constants.m_minRayMarchingSteps = scaleSteps(AZStd::min<uint32_t>(m_shaderConstantData->m_minRayMarchingSteps, m_shaderConstantData->m_maxRayMarchingSteps));
+        m_constants.m_maxRayMarchingSteps = scaleSteps(AZStd::max<uint32_t>(m_shaderConstantData->m_minRayMarchingSteps, m_shaderConstantData->m_maxRayMarchingSteps));
+
+        m_constants.m_planetRadiusKm = m_shaderConstantData->m_planetRadiusKm;
+        m_constants.m_cloudSlabDistanceAboveSeaLevelKm = m_shaderConstantData->m_cloudSlabDistanceAboveSeaLevelKm;
+        m_constants.m_cloudSlabThicknessKm = m_shaderConstantData->m_cloudSlabThicknessKm;
+
+        const AZ::Color sunColorAndIntensity = AZ::Color::CreateFromVector3AndFloat(m_shaderConstantData->m_sunColor, m_shaderConstantData->m_sunLightIntensity);
+        sunColorAndIntensity.StoreToFloat4(m_constants.m_sunColorAndIntensity);
+
+        m_constants.m_directionTowardsTheSun = AZ::PackedVector3f(m_shaderConstantData->m_directionTowardsTheSun);
+
+        // The user inputs the data in [m-1], but the shader assumes all the data is computed in Km.
+        m_constants.m_aCoef = m_shaderConstantData->m_cloudMaterialProperties.m_absorptionCoefficient * (1000.0f);
+        m_constants.m_sCoef = m_shaderConstantData->m_cloudMaterialProperties.m_scatteringCoefficient * (1000.0f);
+
+        // Isotropic in-scattering of the light that comes from a uniformly lit hemisphere with irradiance E:
+        // sCoef / (4 * PI) * (2 * E).
+        const AZ::Vector3 sunIlluminance = m_shaderConstantData->m_sunColor * m_shaderConstantData->m_sunLightIntensity;
+        const float ambientScale = m_constants.m_sCoef / AZ::Constants::TwoPi;
+        const CloudSkyIrradiance& skyIrradiance = m_shaderConstantData->m_skyIrradiance;
+        // The top of the slab sees the sky above and the ground below (through the clouds), the bottom
+        // is mostly shadowed from the sky by the clouds above it.
+        const AZ::Vector3 ambientTop = sunIlluminance * (skyIrradiance.m_skyIrradiance + skyIrradiance.m_groundIrradiance) * ambientScale;
+        const AZ::Vector3 ambientBottom = sunIlluminance * skyIrradiance.m_groundIrradiance * ambientScale;
+        AZ::Vector4(ambientTop, 0.0f).StoreToFloat4(m_constants.m_ambientLuminanceTop);
+        AZ::Vector4(ambientBottom, 0.0f).StoreToFloat4(m_constants.m_ambientLuminanceBottom);
+        m_constants.m_henyeyGreensteinG = m_shaderConstantData->m_cloudMaterialProperties.m_henyeyGreensteinG;
+        m_constants.m_multipleScatteringABC = AZ::PackedVector3f(m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringA,
+            m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringB,
+            m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringC);
+
+        m_constants.m_weatherMapSizeKm = m_shaderConstantData->m_weatherMapSizeKm;
+        m_constants.m_globalCloudCoverage = m_shaderConstantData->m_globalCloudCoverage;
+        m_constants.m_globalCloudDensity = m_shaderConstantData->m_globalCloudDensity;
+
+        m_constants.m_windDirection = AZ::PackedVector3f(m_shaderConstantData->GetNormalizedWindDirection());
+        m_constants.m_cloudTopOffsetKm = m_shaderConstantData->m_cloudTopOffsetKm;
+    }
+    
     void CloudscapeComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
     {
+       ScopedCpuStatsTimer statsTimer(m_compileStatsScope);
        AZ_Assert(m_shaderResourceGroup != nullptr, "CloudscapeComputePass %s has a null shader resource group when calling Compile.", GetPathName().GetCStr());
 
-       m_shaderResourceGroup->SetConstant(m_pixelIndex4x4Index, m_pixelIndex4x4);
+       if (m_shaderDataNeedsUpdate && m_shaderConstantData)
+       {
+           // While a parameter is animated this runs every frame, but only some of the constants change.
+           const CloudscapeComputeConstants prevConstants = m_constants;
+           UpdateShaderDataConstants();
+           m_constantsNeedUpdate |= (memcmp(&prevConstants, &m_constants, sizeof(m_constants)) != 0);
+           m_shaderDataNeedsUpdate = false;
+       }
+
+       if (m_imagesNeedUpdate && m_shaderConstantData)
+       {
+           const AZ::Data::Instance<AZ::RPI::Image> images[] = {
+               m_shaderConstantData->m_lowFrequencyNoiseTexture,
+               m_shaderConstantData->m_highFrequencyNoiseTexture,
+               m_shaderConstantData->m_weatherMap,
+               m_shaderConstantData->m_phaseFunctionLut
+           };
+           for (size_t imageIndex = 0; imageIndex < m_imageIndices.size(); ++imageIndex)
+           {
+               m_shaderResourceGroup->SetImage(m_imageIndices[imageIndex], images[imageIndex]);
+               m_boundImages[imageIndex] = images[imageIndex].get();
+           }
+           m_imagesNeedUpdate = false;
+       }
 
-       if (m_srgNeedsUpdate && m_shaderConstantData)
+       if (m_constantsNeedUpdate && m_isConstantsLayoutValid)
        {
-           m_shaderResourceGroup->SetConstant(m_uvwScaleIndex, m_shaderConstantData->m_uvwScale);
-           m_shaderResourceGroup->SetConstant(m_maxMipLevelsIndex, m_shaderConstantData->m_clampedMipLevels);
-
-           const auto minSteps = AZStd::min<uint32_t>(m_shaderConstantData->m_minRayMarchingSteps, m_shaderConstantData->m_maxRayMarchingSteps);
-           const auto maxSteps = AZStd::max<uint32_t>(m_shaderConstantData->m_minRayMarchingSteps, m_shaderConstantData->m_maxRayMarchingSteps);
-           m_shaderResourceGroup->SetConstant(m_minRayMarchingStepsIndex, minSteps);
-           m_shaderResourceGroup->SetConstant(m_maxRayMarchingStepsIndex, maxSteps);
-
-
-           m_shaderResourceGroup->SetConstant(m_planetRadiusKmIndex, static_cast<float>(m_shaderConstantData->m_planetRadiusKm));
-           m_shaderResourceGroup->SetConstant(m_cloudSlabDistanceAboveSeaLevelKmIndex,  m_shaderConstantData->m_cloudSlabDistanceAboveSeaLevelKm);
-           m_shaderResourceGroup->SetConstant(m_cloudSlabThicknessKmIndex, m_shaderConstantData->m_cloudSlabThicknessKm);
-
-           AZ::Color sunColorAndIntensity = AZ::Color::CreateFromVector3AndFloat(m_shaderConstantData->m_sunColor, m_shaderConstantData->m_sunLightIntensity);
-           m_shaderResourceGroup->SetConstant(m_sunColorAndIntensityIndex, sunColorAndIntensity);
-
-           AZ::Color ambientLightColorAndIntensity = m_shaderConstantData->m_ambientLightColor;
-           ambientLightColorAndIntensity.SetA(m_shaderConstantData->m_ambientLightIntensity);
-           m_shaderResourceGroup->SetConstant(m_ambientLightColorAndIntensityIndex, ambientLightColorAndIntensity);
-           
-           m_shaderResourceGroup->SetConstant(m_directionTowardsTheSunIndex, m_shaderConstantData->m_directionTowardsTheSun);
-
-           // The user inputs the data in [m-1], but the shader assumes all the data is computed in Km.
-           const float absorptionCoefficient = m_shaderConstantData->m_cloudMaterialProperties.m_absorptionCoefficient * (1000.0f); //* 10.0f);
-           const float scatteringCoefficient = m_shaderConstantData->m_cloudMaterialProperties.m_scatteringCoefficient * (1000.0f);// *10.0f);
-           m_shaderResourceGroup->SetConstant(m_aCoefIndex, absorptionCoefficient);
-           m_shaderResourceGroup->SetConstant(m_sCoefIndex, scatteringCoefficient);
-           m_shaderResourceGroup->SetConstant(m_henyeyGreensteinGIndex, m_shaderConstantData->m_cloudMaterialProperties.m_henyeyGreensteinG);
-           AZ::Vector3 abc(m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringA,
-               m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringB,
-               m_shaderConstantData->m_cloudMaterialProperties.m_multiScatteringC);
-           m_shaderResourceGroup->SetConstant(m_multipleScatteringABCIndex,  abc);
-
-           m_shaderResourceGroup->SetConstant(m_weatherMapSizeKmIndex, m_shaderConstantData->m_weatherMapSizeKm);
-           m_shaderResourceGroup->SetConstant(m_globalCloudCoverageIndex, m_shaderConstantData->m_globalCloudCoverage);
-           m_shaderResourceGroup->SetConstant(m_globalCloudDensityIndex, m_shaderConstantData->m_globalCloudDensity);
-
-           AZ::Vector3 windDirection = m_shaderConstantData->m_windDirection;
-           const float windDirectionLength = windDirection.GetLength();
-           windDirection = AZ::IsClose(windDirectionLength, 0.0f, 0.01f)
-               ? AZ::Vector3::CreateZero()
-               : (windDirection / windDirectionLength);
-           m_shaderResourceGroup->SetConstant(m_windSpeedKmPerSecIndex, m_shaderConstantData->m_windSpeedKmPerSec);
-           m_shaderResourceGroup->SetConstant(m_windDirectionIndex, windDirection);
-           m_shaderResourceGroup->SetConstant(m_cloudTopOffsetKmIndex, m_shaderConstantData->m_cloudTopOffsetKm);
-
-           m_shaderResourceGroup->SetImage(m_lowFreqNoiseTextureImageIndex, m_shaderConstantData->m_lowFrequencyNoiseTexture);
-           m_shaderResourceGroup->SetImage(m_highFreqNoiseTextureImageIndex, m_shaderConstantData->m_highFrequencyNoiseTexture);
-           m_shaderResourceGroup->SetImage(m_weatherMapImageIndex, m_shaderConstantData->m_weatherMap);
-
-           m_srgNeedsUpdate = false;
+           m_shaderResourceGroup->SetConstantRaw(&m_constants, 0, sizeof(m_constants));
+           m_constantsNeedUpdate = false;
        }
 
        AZ::RPI::ComputePass::CompileResources(context);
@@ -194,7 +382,8 @@ namespace VolumetricClouds
         // If any of the textures is nullptr we disable this pass.
         if (!shaderData.m_lowFrequencyNoiseTexture ||
             !shaderData.m_highFrequencyNoiseTexture ||
-            !shaderData.m_weatherMap)
+            !shaderData.m_weatherMap ||
+            !shaderData.m_phaseFunctionLut)
         {
             m_shaderConstantData = nullptr;
             SetEnabled(false);
@@ -202,7 +391,13 @@ namespace VolumetricClouds
         else
         {
             m_shaderConstantData = &shaderData;
-            m_srgNeedsUpdate = true;
+            m_shaderDataNeedsUpdate = true;
+            // Most updates only change constants, e.g. the sun direction during a day/night cycle.
+            const AZ::RPI::Image* images[] = {
+                shaderData.m_lowFrequencyNoiseTexture.get(), shaderData.m_highFrequencyNoiseTexture.get(), shaderData.m_weatherMap.get(),
+                shaderData.m_phaseFunctionLut.get()
+            };
+            m_imagesNeedUpdate = m_imagesNeedUpdate || !AZStd::equal(AZStd::begin(images), AZStd::end(images), m_boundImages.begin());
             if (!IsEnabled())
             {
                 SetEnabled(true);
@@ -211,15 +406,104 @@ namespace VolumetricClouds
     }
 
 
+    template<typename T>
+    static bool UpdateConstant(T& constant, T value)
+    {
+        if (constant == value)
+        {
+            return false;
+        }
+        constant = value;
+        return true;
+    }
+
     void CloudscapeComputePass::UpdateFrameCounter(uint32_t frameCounter)
     {
-        m_pixelIndex4x4 = frameCounter % 16;
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_pixelIndex4x4, frameCounter % 16);
+    }
+
+    void CloudscapeComputePass::UpdateWindOffsetKm(const AZ::Vector3& windOffsetKm)
+    {
+        const AZ::PackedVector3f& currentWindOffsetKm = m_constants.m_windOffsetKm;
+        if (AZ::Vector3(currentWindOffsetKm.GetX(), currentWindOffsetKm.GetY(), currentWindOffsetKm.GetZ()) == windOffsetKm)
+        {
+            return;
+        }
+        m_constants.m_windOffsetKm = AZ::PackedVector3f(windOffsetKm);
+        m_constantsNeedUpdate = true;
+    }
+
+    void CloudscapeComputePass::UpdateAccumulatedSampleCount(uint32_t accumulatedSampleCount)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_accumulatedSampleCount, accumulatedSampleCount);
+    }
+
+    void CloudscapeComputePass::SetIdle(bool isIdle)
+    {
+        m_isIdle = isIdle;
+    }
+
+    void CloudscapeComputePass::SetSkyViewStartDistanceKm(float skyViewStartDistanceKm)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_skyViewStartDistanceKm, skyViewStartDistanceKm);
+    }
+
+    void CloudscapeComputePass::SetRayMarchDebugStatsEnabled(bool enable)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_rayMarchDebugStatsEnabled, static_cast<uint32_t>(enable));
+    }
+
+    void CloudscapeComputePass::SetCloudDepthEnabled(bool enable)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_cloudDepthEnabled, static_cast<uint32_t>(enable));
+    }
+
+    void CloudscapeComputePass::SetCompactHistoryEnabled(bool enable)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_compactHistoryEnabled, static_cast<uint32_t>(enable));
+    }
+
+    void CloudscapeComputePass::SetHdrOutputEnabled(bool enable)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_hdrOutputEnabled, static_cast<uint32_t>(enable));
+    }
+
+    void CloudscapeComputePass::SetAsyncComputeEnabled(bool enable)
+    {
+        // The RHI submits the compute scopes to the graphics queue on devices without a separate compute queue.
+        const auto hardwareQueueClass = enable ? AZ::RHI::HardwareQueueClass::Compute : AZ::RHI::HardwareQueueClass::Graphics;
+        if (m_hardwareQueueClass == hardwareQueueClass)
+        {
+            return;
+        }
+        m_hardwareQueueClass = hardwareQueueClass;
+        // The scope is created with the hardware queue class during initialization.
+        QueueForBuildAndInitialization();
+    }
+
+    void CloudscapeComputePass::SetQualityParameters(float rayMarchingStepsScale, float mipLevelBias)
+    {
+        m_constantsNeedUpdate |= UpdateConstant(m_constants.m_mipLevelBias, mipLevelBias);
+        if (m_rayMarchingStepsScale != rayMarchingStepsScale)
+        {
+            // The steps are scaled from the shader constant data.
+            m_rayMarchingStepsScale = rayMarchingStepsScale;
+            m_shaderDataNeedsUpdate = true;
+        }
+    }
+
+    bool CloudscapeComputePass::IsEnabled() const
+    {
+        return !m_isIdle && AZ::RPI::ComputePass::IsEnabled();
     }
 
     // ComputePass overrides...
     void CloudscapeComputePass::OnShaderReloadedInternal()
     {
-        m_srgNeedsUpdate = true;
+        // The layout may have changed together with the shader.
+        m_isConstantsLayoutValid = ValidateConstantsLayout();
+        m_constantsNeedUpdate = true;
+        m_imagesNeedUpdate = true;
     }
 
 }   // VolumetricClouds AZ
@@ -6,7 +6,11 @@
 */
 #pragma once
 
+#include <cstddef>
+
 #include <AzCore/Memory/SystemAllocator.h>
+#include <AzCore/Math/PackedVector3.h>
+#include <AzCore/std/containers/array.h>
 
 #include <Atom/RHI/CommandList.h>
 #include <Atom/RHI/DrawItem.h>
@@ -18,9 +22,66 @@
 #include <Atom/RPI.Public/Image/StreamingImage.h>
 
 #include <Renderer/CloudscapeShaderConstantData.h>
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 
 namespace VolumetricClouds
 {
+    // CPU mirror of the constants of the PassSrg in CloudscapeCS.azsl, in declaration order and
+    // with the same packing rules, including the [[pad_to(16)]] attributes. Uploaded with a single
+    // SetConstantRaw(). The sky-view variant declares two more constants after these.
+    // If you change the PassSrg, change this struct and the static_asserts below. The offsets are also
+    // validated against the reflected shader layout when the pass is initialized.
+    struct CloudscapeComputeConstants
+    {
+        uint32_t m_pixelIndex4x4 = 0;
+        uint32_t m_accumulatedSampleCount = 0;
+        float m_uvwScale = 0.0f;
+        uint32_t m_maxMipLevels = 0;
+        uint32_t m_minRayMarchingSteps = 0;
+        uint32_t m_maxRayMarchingSteps = 0;
+        uint32_t m_pad0[2] = {};
+
+        float m_planetRadiusKm = 0.0f;
+        float m_cloudSlabDistanceAboveSeaLevelKm = 0.0f;
+        float m_cloudSlabThicknessKm = 0.0f;
+        uint32_t m_pad1 = 0;
+
+        float m_sunColorAndIntensity[4] = {};
+        float m_ambientLuminanceTop[4] = {};
+        float m_ambientLuminanceBottom[4] = {};
+        AZ::PackedVector3f m_directionTowardsTheSun = AZ::PackedVector3f(0.0f, 0.0f, 0.0f);
+        uint32_t m_pad2 = 0;
+
+        float m_aCoef = 0.0f;
+        float m_sCoef = 0.0f;
+        float m_henyeyGreensteinG = 0.0f;
+        uint32_t m_pad3 = 0;
+
+        AZ::PackedVector3f m_multipleScatteringABC = AZ::PackedVector3f(0.0f, 0.0f, 0.0f);
+        uint32_t m_pad4 = 0;
+
+        float m_weatherMapSizeKm = 0.0f;
+        float m_globalCloudCoverage = 0.0f;
+        float m_globalCloudDensity = 0.0f;
+        float m_cloudTopOffsetKm = 0.0f;
+        AZ::PackedVector3f m_windDirection = AZ::PackedVector3f(0.0f, 0.0f, 0.0f);
+        float m_skyViewStartDistanceKm = 0.0f;
+        AZ::PackedVector3f m_windOffsetKm = AZ::PackedVector3f(0.0f, 0.0f, 0.0f);
+        float m_mipLevelBias = 0.0f;
+        uint32_t m_rayMarchDebugStatsEnabled = 0;
+        uint32_t m_cloudDepthEnabled = 0;
+        uint32_t m_compactHistoryEnabled = 0;
+        uint32_t m_hdrOutputEnabled = 0;
+    };
+    static_assert(offsetof(CloudscapeComputeConstants, m_planetRadiusKm) == 32, "Must match [[pad_to(16)]] in CloudscapeCS.azsl");
+    static_assert(offsetof(CloudscapeComputeConstants, m_sunColorAndIntensity) == 48, "Must match [[pad_to(16)]] in CloudscapeCS.azsl");
+    static_assert(offsetof(CloudscapeComputeConstants, m_aCoef) == 112, "Must match [[pad_to(16)]] in CloudscapeCS.azsl");
+    static_assert(offsetof(CloudscapeComputeConstants, m_multipleScatteringABC) == 128, "Must match [[pad_to(16)]] in CloudscapeCS.azsl");
+    static_assert(offsetof(CloudscapeComputeConstants, m_weatherMapSizeKm) == 144, "Must match [[pad_to(16)]] in CloudscapeCS.azsl");
+    static_assert(offsetof(CloudscapeComputeConstants, m_windDirection) == 160, "A float3 can't straddle a 16 bytes boundary");
+    static_assert(offsetof(CloudscapeComputeConstants, m_windOffsetKm) == 176, "A float3 can't straddle a 16 bytes boundary");
+    static_assert(sizeof(CloudscapeComputeConstants) == 208, "Must match the PassSrg constants in CloudscapeCS.azsl");
+
     /**
      *  This compute pass does all the heavy work to paint clouds. This is the pass that runs the expensive
      *  raymarching required to draw volumetric clouds.
@@ -30,8 +91,13 @@ namespace VolumetricClouds
      *  while the other is the one we are going to write to in the current frame.
      *  When we are rendering to the current frame we only render to 1 of 16 pixels
      *  in a 4x4 block.
+     *  On platforms where AZ_TRAIT_VOLUMETRICCLOUDS_USE_HALF_PRECISION_RAYMARCH is 1
+     *  this pass replaces the shader defined in the pass template with
+     *  the half precision variant: CloudscapeHalfPrecisionCS.shader.
+     *  CloudscapeSkyViewComputePass derives from this class because it
+     *  needs the exact same shader constants.
      */
-    class CloudscapeComputePass final
+    class CloudscapeComputePass
         : public AZ::RPI::ComputePass
     {
         AZ_RPI_PASS(CloudscapeComputePass);
@@ -48,60 +114,114 @@ namespace VolumetricClouds
         void UpdateShaderConstantData(const CloudscapeShaderConstantData& shaderData);
 
         void UpdateFrameCounter(uint32_t frameCounter);
+
+        // How far the wind has moved the clouds. Called each frame by the feature processor,
+        // see CloudscapeFeatureProcessor::UpdateWindOffset().
+        void UpdateWindOffsetKm(const AZ::Vector3& windOffsetKm);
+
+        // Number of samples, per pixel, that have been accumulated while the view
+        // has been static. Zero means there's no history to blend with.
+        void UpdateAccumulatedSampleCount(uint32_t accumulatedSampleCount);
+
+        // When idle the pass is not dispatched and the attachments keep
+        // the last converged result. Unlike SetEnabled(), this doesn't conflict
+        // with the enable/disable logic of UpdateShaderConstantData().
+        void SetIdle(bool isIdle);
+
+        // Clouds farther than this distance are not ray marched per pixel because
+        // they are read from the sky-view texture. 0 disables the sky-view texture.
+        void SetSkyViewStartDistanceKm(float skyViewStartDistanceKm);
+
+        // Set by the dynamic quality controller. @rayMarchingStepsScale scales the min and max
+        // ray marching steps from the shader constant data, and @mipLevelBias is added to the starting
+        // mip level of the noise textures.
+        void SetQualityParameters(float rayMarchingStepsScale, float mipLevelBias);
+
+        // When enabled, the ray marching counters of each pixel are written to
+        // CloudscapeFeatureProcessor::GetRayMarchDebugStatsImageAttachment().
+        void SetRayMarchDebugStatsEnabled(bool enable);
+
+        // When enabled, the distance to the clouds of each ray marched pixel is written to
+        // CloudscapeFeatureProcessor::GetCloudDepthImageAttachment().
+        void SetCloudDepthEnabled(bool enable);
+
+        // See CloudscapeRenderSettings::m_enableCompactHistory. The feature processor
+        // sizes the Output1 attachment accordingly.
+        void SetCompactHistoryEnabled(bool enable);
+
+        // See CloudscapeRenderSettings::m_enableHdrOutput. The feature processor
+        // creates the attachments with the matching formats.
+        void SetHdrOutputEnabled(bool enable);
+
+        // When enabled, the scope of this pass is created with HardwareQueueClass::Compute instead of
+        // HardwareQueueClass::Graphics. The RHI runs it on the graphics queue when the device has no separate
+        // compute queue. The synchronization with the other queues is left to the frame graph, based on the
+        // attachments of the pass. The pass is reinitialized when the queue changes.
+        void SetAsyncComputeEnabled(bool enable);
+
+        //! Pass overrides
+        bool IsEnabled() const override;
     
-    private:
+    protected:
         CloudscapeComputePass(const AZ::RPI::PassDescriptor& descriptor);
 
         //! Pass behavior overrides
         void InitializeInternal() override;
         void BuildInternal() override;
-        // void FrameBeginInternal(FramePrepareParams params) override;
 
         // Scope producer functions...
-        // void SetupFrameGraphDependencies(AZ::RHI::FrameGraphInterface frameGraph) override;
         void CompileResources(const AZ::RHI::FrameGraphCompileContext& context) override;
+
+        // The CPU time of CompileResources() is added to this scope.
+        StatsScope m_compileStatsScope = StatsScope::CloudscapeComputeCompileCpu;
+
+    private:
+        static constexpr char LogName[] = "CloudscapeComputePass";
+        static constexpr char HalfPrecisionShaderFilePath[] = "Shaders/Cloudscape/CloudscapeHalfPrecisionCS.shader";
+        static constexpr char HalfPrecisionShaderProductPath[] = "Shaders/Cloudscape/CloudscapeHalfPrecisionCS.azshader";
+
+        // Returns a copy of @descriptor whose ComputePassData references the half precision
+        // version of the cloudscape shader.
+        static AZ::RPI::PassDescriptor CreateHalfPrecisionDescriptor(const AZ::RPI::PassDescriptor& descriptor);
+
+        // void FrameBeginInternal(FramePrepareParams params) override;
+        // void SetupFrameGraphDependencies(AZ::RHI::FrameGraphInterface frameGraph) override;
         // void BuildCommandListInternal(const AZ::RHI::FrameGraphExecuteContext& context) override;
 
         // ComputePass overrides...
         void OnShaderReloadedInternal() override;
 
-        // A helper function
-        void SetImageAttachmentBinding(uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage);
+        // Fills the constants that come from @m_shaderConstantData and the quality parameters.
+        void UpdateShaderDataConstants();
+
+        // Compares the offsets of m_constants with the reflected layout of the PassSrg.
+        // Returns false, and reports an error, when they don't match.
+        bool ValidateConstantsLayout() const;
+
+        // A helper function. Binds @attachmentImage to the slot @slotNamePrefix<attachmentIndex>,
+        // and to the element @attachmentIndex of the shader array @shaderInputName.
+        void SetImageAttachmentBinding(const char* slotNamePrefix, const char* shaderInputName,
+            uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage);
     
-        bool m_srgNeedsUpdate = true;
+        // Dirty bits. The shader constant data is read again, m_constants is uploaded, and the images are bound again.
+        // Most frames only the pixel index changes, which only requires the upload.
+        bool m_shaderDataNeedsUpdate = true;
+        bool m_constantsNeedUpdate = true;
+        bool m_imagesNeedUpdate = true;
+        // False when m_constants doesn't match the shader. Nothing is uploaded then.
+        bool m_isConstantsLayoutValid = false;
+
         const CloudscapeShaderConstantData* m_shaderConstantData = nullptr;
-        uint32_t m_pixelIndex4x4 = 0; // Frame Counter % 16.
-
-        AZ::RHI::ShaderInputNameIndex m_pixelIndex4x4Index = "m_pixelIndex4x4";
-
-        AZ::RHI::ShaderInputNameIndex m_uvwScaleIndex = "m_uvwScale";
-        AZ::RHI::ShaderInputNameIndex m_maxMipLevelsIndex = "m_maxMipLevels";
-        AZ::RHI::ShaderInputNameIndex m_minRayMarchingStepsIndex = "m_minRayMarchingSteps";
-        AZ::RHI::ShaderInputNameIndex m_maxRayMarchingStepsIndex = "m_maxRayMarchingSteps";
-
-        AZ::RHI::ShaderInputNameIndex m_planetRadiusKmIndex = "m_planetRadiusKm";
-        AZ::RHI::ShaderInputNameIndex m_cloudSlabDistanceAboveSeaLevelKmIndex = "m_cloudSlabDistanceAboveSeaLevelKm";
-        AZ::RHI::ShaderInputNameIndex m_cloudSlabThicknessKmIndex = "m_cloudSlabThicknessKm";
-
-        AZ::RHI::ShaderInputNameIndex m_sunColorAndIntensityIndex = "m_sunColorAndIntensity";
-        AZ::RHI::ShaderInputNameIndex m_ambientLightColorAndIntensityIndex = "m_ambientLightColorAndIntensity";
-        AZ::RHI::ShaderInputNameIndex m_directionTowardsTheSunIndex = "m_directionTowardsTheSun";
-
-        AZ::RHI::ShaderInputNameIndex m_weatherMapSizeKmIndex = "m_weatherMapSizeKm";
-        AZ::RHI::ShaderInputNameIndex m_globalCloudCoverageIndex = "m_globalCloudCoverage";
-        AZ::RHI::ShaderInputNameIndex m_globalCloudDensityIndex = "m_globalCloudDensity";
-        AZ::RHI::ShaderInputNameIndex m_windSpeedKmPerSecIndex = "m_windSpeedKmPerSec";
-        AZ::RHI::ShaderInputNameIndex m_windDirectionIndex = "m_windDirection";
-        AZ::RHI::ShaderInputNameIndex m_cloudTopOffsetKmIndex = "m_cloudTopOffsetKm";
-
-        AZ::RHI::ShaderInputNameIndex m_aCoefIndex = "m_aCoef";
-        AZ::RHI::ShaderInputNameIndex m_sCoefIndex = "m_sCoef";
-        AZ::RHI::ShaderInputNameIndex m_henyeyGreensteinGIndex = "m_henyeyGreensteinG";
-        AZ::RHI::ShaderInputNameIndex m_multipleScatteringABCIndex = "m_multipleScatteringABC";
-
-        AZ::RHI::ShaderInputNameIndex m_lowFreqNoiseTextureImageIndex = "m_lowFreqNoiseTexture";
-        AZ::RHI::ShaderInputNameIndex m_highFreqNoiseTextureImageIndex = "m_highFreqNoiseTexture";
-        AZ::RHI::ShaderInputNameIndex m_weatherMapImageIndex = "m_weatherMap";
+        CloudscapeComputeConstants m_constants;
+        bool m_isIdle = false;
+        float m_rayMarchingStepsScale = 1.0f;
+
+        // The images bound to the current shader resource group, in the same order as m_imageIndices.
+        AZStd::array<const AZ::RPI::Image*, 4> m_boundImages = {};
+
+        AZStd::array<AZ::RHI::ShaderInputNameIndex, 4> m_imageIndices = {
+            "m_lowFreqNoiseTexture", "m_highFreqNoiseTexture", "m_weatherMap", "m_phaseFunctionLut"
+        };
 
     };
 
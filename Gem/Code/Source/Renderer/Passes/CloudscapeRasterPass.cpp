@@ -17,6 +17,7 @@
 #include <Atom/RHI/PipelineState.h>
 
 #include <Renderer/CloudscapeFeatureProcessor.h>
+#include <Renderer/VolumetricCloudsStatsCollector.h>
 #include "CloudscapeRasterPass.h"
 
 namespace VolumetricClouds
@@ -40,6 +41,10 @@ namespace VolumetricClouds
         m_cloudscapeTextureIndex = 0;
         m_srgNeedsUpdate = true;
 
+        // The same pass class runs Cloudscape.shader and CloudscapeFusedComposite.shader.
+        m_hasReprojection = m_shaderResourceGroup &&
+            m_shaderResourceGroup->GetLayout()->FindShaderInputConstantIndex(AZ::Name("m_reprojectionEnabled")).IsValid();
+
         //InitializeShaderVariant();
     }
 
@@ -58,11 +63,27 @@ namespace VolumetricClouds
     
     void CloudscapeRasterPass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
     {
+       ScopedCpuStatsTimer statsTimer(StatsScope::CloudscapeRasterCompileCpu);
        AZ_Assert(m_shaderResourceGroup != nullptr, "CloudscapeRasterPass %s has a null shader resource group when calling Compile.", GetPathName().GetCStr());
 
        if (m_srgNeedsUpdate)
        {
            m_shaderResourceGroup->SetConstant(m_cloudscapeTextureIndexIndex, m_cloudscapeTextureIndex);
+           m_shaderResourceGroup->SetConstant(m_skyViewStartDistanceKmIndex, m_skyViewStartDistanceKm);
+           m_shaderResourceGroup->SetConstant(m_planetRadiusKmIndex, m_planetRadiusKm);
+           m_shaderResourceGroup->SetConstant(m_cloudSlabDistanceAboveSeaLevelKmIndex, m_cloudSlabDistanceAboveSeaLevelKm);
+           m_shaderResourceGroup->SetConstant(m_rayMarchDebugViewIndex, m_rayMarchDebugView);
+           m_shaderResourceGroup->SetConstant(m_rayMarchDebugMaxValueIndex, m_rayMarchDebugMaxValue);
+           m_shaderResourceGroup->SetConstant(m_hdrOutputEnabledIndex, static_cast<uint32_t>(m_isHdrOutputEnabled));
+           if (m_hasReprojection)
+           {
+               m_shaderResourceGroup->SetConstant(m_reprojectionEnabledIndex, static_cast<uint32_t>(m_isReprojectionEnabled));
+               m_shaderResourceGroup->SetConstant(m_pixelIndex4x4Index, m_pixelIndex4x4);
+               m_shaderResourceGroup->SetConstant(m_windOffsetKmIndex, m_windOffsetKm);
+               m_shaderResourceGroup->SetConstant(m_cloudSlabThicknessKmIndex, m_cloudSlabThicknessKm);
+               m_shaderResourceGroup->SetConstant(m_cloudDepthEnabledIndex, static_cast<uint32_t>(m_isCloudDepthEnabled));
+               m_shaderResourceGroup->SetConstant(m_compactHistoryEnabledIndex, static_cast<uint32_t>(m_isCompactHistoryEnabled));
+           }
            m_srgNeedsUpdate = false;
        }
 
@@ -88,9 +109,47 @@ namespace VolumetricClouds
     }
 
 
-    void CloudscapeRasterPass::UpdateFrameCounter(uint32_t frameCounter)
+    void CloudscapeRasterPass::UpdateOutputTextureIndex(uint32_t outputTextureIndex)
+    {
+        m_cloudscapeTextureIndex = outputTextureIndex;
+        m_srgNeedsUpdate = true;
+    }
+
+    void CloudscapeRasterPass::UpdateSkyViewParameters(float skyViewStartDistanceKm, float planetRadiusKm, float cloudSlabDistanceAboveSeaLevelKm)
+    {
+        m_skyViewStartDistanceKm = skyViewStartDistanceKm;
+        m_planetRadiusKm = planetRadiusKm;
+        m_cloudSlabDistanceAboveSeaLevelKm = cloudSlabDistanceAboveSeaLevelKm;
+        m_srgNeedsUpdate = true;
+    }
+
+    void CloudscapeRasterPass::SetHdrOutputEnabled(bool enable)
+    {
+        m_isHdrOutputEnabled = enable;
+        m_srgNeedsUpdate = true;
+    }
+
+    void CloudscapeRasterPass::SetRayMarchDebugView(uint32_t rayMarchDebugView, float maxValue)
+    {
+        m_rayMarchDebugView = rayMarchDebugView;
+        m_rayMarchDebugMaxValue = maxValue;
+        m_srgNeedsUpdate = true;
+    }
+
+    void CloudscapeRasterPass::SetReprojectionEnabled(bool enable)
+    {
+        m_isReprojectionEnabled = enable;
+        m_srgNeedsUpdate = true;
+    }
+
+    void CloudscapeRasterPass::SetReprojectionParameters(uint32_t pixelIndex4x4, const AZ::Vector3& windOffsetKm,
+        float cloudSlabThicknessKm, bool isCloudDepthEnabled, bool isCompactHistoryEnabled)
     {
-        m_cloudscapeTextureIndex = frameCounter % 2;
+        m_pixelIndex4x4 = pixelIndex4x4;
+        m_windOffsetKm = windOffsetKm;
+        m_cloudSlabThicknessKm = cloudSlabThicknessKm;
+        m_isCloudDepthEnabled = isCloudDepthEnabled;
+        m_isCompactHistoryEnabled = isCompactHistoryEnabled;
         m_srgNeedsUpdate = true;
     }
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AzCore/Memory/SystemAllocator.h>
+#include <AzCore/Math/Vector3.h>
 
 #include <Atom/RHI/CommandList.h>
 #include <Atom/RHI/DrawItem.h>
@@ -37,7 +38,28 @@ namespace VolumetricClouds
         //! Creates a LookModificationPass
         static AZ::RPI::Ptr<CloudscapeRasterPass> Create(const AZ::RPI::PassDescriptor& descriptor);
 
-        void UpdateFrameCounter(uint32_t frameCounter);
+        // The cloudscape attachment, 0 or 1, to read in the current frame.
+        void UpdateOutputTextureIndex(uint32_t outputTextureIndex);
+
+        // When enabled, the alpha of the clouds is read from the CloudAlpha attachments.
+        // See CloudscapeRenderSettings::m_enableHdrOutput.
+        void SetHdrOutputEnabled(bool enable);
+
+        // The raster pass needs to know where the cloud slab is to decide, per pixel, if the clouds
+        // come from the ray marched attachments or from the sky-view texture.
+        // @skyViewStartDistanceKm is 0 when the sky-view texture is disabled.
+        void UpdateSkyViewParameters(float skyViewStartDistanceKm, float planetRadiusKm, float cloudSlabDistanceAboveSeaLevelKm);
+
+        // @rayMarchDebugView is a CloudscapeFeatureProcessor::RayMarchDebugView value, 0 displays the clouds.
+        // The selected counter is divided by @maxValue before being mapped to the heatmap.
+        void SetRayMarchDebugView(uint32_t rayMarchDebugView, float maxValue);
+
+        // Only used when the shader of this pass also reprojects the history, see CloudscapeFusedComposite.azsl.
+        // When disabled the history is only composited.
+        void SetReprojectionEnabled(bool enable);
+        // Same parameters as the reprojection compute pass. See CloudscapeReprojectionCS.azsl.
+        void SetReprojectionParameters(uint32_t pixelIndex4x4, const AZ::Vector3& windOffsetKm,
+            float cloudSlabThicknessKm, bool isCloudDepthEnabled, bool isCompactHistoryEnabled);
     
     protected:
         CloudscapeRasterPass(const AZ::RPI::PassDescriptor& descriptor);
@@ -55,8 +77,36 @@ namespace VolumetricClouds
         bool m_srgNeedsUpdate = true;
 
         AZ::RHI::ShaderInputNameIndex m_cloudscapeTextureIndexIndex = "m_cloudscapeTextureIndex";
+        AZ::RHI::ShaderInputNameIndex m_skyViewStartDistanceKmIndex = "m_skyViewStartDistanceKm";
+        AZ::RHI::ShaderInputNameIndex m_planetRadiusKmIndex = "m_planetRadiusKm";
+        AZ::RHI::ShaderInputNameIndex m_cloudSlabDistanceAboveSeaLevelKmIndex = "m_cloudSlabDistanceAboveSeaLevelKm";
+        AZ::RHI::ShaderInputNameIndex m_rayMarchDebugViewIndex = "m_rayMarchDebugView";
+        AZ::RHI::ShaderInputNameIndex m_rayMarchDebugMaxValueIndex = "m_rayMarchDebugMaxValue";
+        AZ::RHI::ShaderInputNameIndex m_hdrOutputEnabledIndex = "m_hdrOutputEnabled";
+
+        // Only used when m_hasReprojection is true.
+        AZ::RHI::ShaderInputNameIndex m_reprojectionEnabledIndex = "m_reprojectionEnabled";
+        AZ::RHI::ShaderInputNameIndex m_pixelIndex4x4Index = "m_pixelIndex4x4";
+        AZ::RHI::ShaderInputNameIndex m_windOffsetKmIndex = "m_windOffsetKm";
+        AZ::RHI::ShaderInputNameIndex m_cloudSlabThicknessKmIndex = "m_cloudSlabThicknessKm";
+        AZ::RHI::ShaderInputNameIndex m_cloudDepthEnabledIndex = "m_cloudDepthEnabled";
+        AZ::RHI::ShaderInputNameIndex m_compactHistoryEnabledIndex = "m_compactHistoryEnabled";
 
         uint32_t m_cloudscapeTextureIndex = 0;
+        float m_skyViewStartDistanceKm = 0.0f;
+        float m_planetRadiusKm = 0.0f;
+        float m_cloudSlabDistanceAboveSeaLevelKm = 0.0f;
+        uint32_t m_rayMarchDebugView = 0;
+        float m_rayMarchDebugMaxValue = 1.0f;
+        bool m_isHdrOutputEnabled = false;
+
+        bool m_hasReprojection = false;
+        bool m_isReprojectionEnabled = false;
+        uint32_t m_pixelIndex4x4 = 0;
+        AZ::Vector3 m_windOffsetKm = AZ::Vector3::CreateZero();
+        float m_cloudSlabThicknessKm = 0.0f;
+        bool m_isCloudDepthEnabled = false;
+        bool m_isCompactHistoryEnabled = false;
     };
 
 }   // namespace VolumetricClouds
@@ -0,0 +1,54 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <Atom/RPI.Public/RenderPipeline.h>
+#include <Atom/RPI.Public/Scene.h>
+
+#include <Renderer/CloudscapeFeatureProcessor.h>
+#include "CloudscapeShadowMapBarrierPass.h"
+
+namespace VolumetricClouds
+{
+
+    AZ::RPI::Ptr<CloudscapeShadowMapBarrierPass> CloudscapeShadowMapBarrierPass::Create(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        AZ::RPI::Ptr<CloudscapeShadowMapBarrierPass> pass = aznew CloudscapeShadowMapBarrierPass(descriptor);
+        return pass;
+    }
+
+    CloudscapeShadowMapBarrierPass::CloudscapeShadowMapBarrierPass(const AZ::RPI::PassDescriptor& descriptor)
+        : AZ::RPI::RenderPass(descriptor)
+    {
+    }
+
+    void CloudscapeShadowMapBarrierPass::BuildInternal()
+    {
+        AZ::RPI::Scene* scene = m_pipeline->GetScene();
+        auto* cloudscapeFeatureProcessor = scene->GetFeatureProcessor<CloudscapeFeatureProcessor>();
+        if (!cloudscapeFeatureProcessor)
+        {
+            // This can happen when the feature processor is being destroyed.
+            return;
+        }
+
+        // Same attachment as CloudscapeShadowMapComputePass. It is attached here instead of connected
+        // to its slot because the feature processor recreates it when the resolution changes.
+        const auto shadowMapImageAttachment = cloudscapeFeatureProcessor->GetCloudShadowMapImageAttachment(m_pipeline);
+        if (!shadowMapImageAttachment)
+        {
+            AZ_Error(LogName, false, "The cloud shadow map attachment of render pipeline %s doesn't exist", m_pipeline->GetId().GetCStr());
+            return;
+        }
+        AttachImageToSlot(AZ::Name("CloudShadowMap"), shadowMapImageAttachment);
+    }
+
+    void CloudscapeShadowMapBarrierPass::BuildCommandListInternal([[maybe_unused]] const AZ::RHI::FrameGraphExecuteContext& context)
+    {
+        // Nothing to record, the frame graph does the work when it compiles the scope.
+    }
+
+}   // namespace VolumetricClouds
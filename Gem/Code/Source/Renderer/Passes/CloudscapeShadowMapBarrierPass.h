@@ -0,0 +1,47 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/Memory/SystemAllocator.h>
+
+#include <Atom/RPI.Public/Pass/RenderPass.h>
+
+namespace VolumetricClouds
+{
+    /**
+     *  Doesn't record any command. Its scope declares the cloud shadow map, written by
+     *  CloudscapeShadowMapComputePass as a UAV, as a shader read attachment every frame.
+     *  SceneSrg::m_cloudShadowMap is not an attachment of the passes that read it, so without this
+     *  scope the frame graph wouldn't add a barrier, nor a layout transition, between the dispatch
+     *  and those passes. The passes that read SceneSrg::m_cloudShadowMap must run after this one.
+     */
+    class CloudscapeShadowMapBarrierPass final
+        : public AZ::RPI::RenderPass
+    {
+        AZ_RPI_PASS(CloudscapeShadowMapBarrierPass);
+
+    public:
+        AZ_RTTI(CloudscapeShadowMapBarrierPass, "{6E1B3F84-2D7C-4A95-B0E6-93C5A1F7D248}", AZ::RPI::RenderPass);
+        AZ_CLASS_ALLOCATOR(CloudscapeShadowMapBarrierPass, AZ::SystemAllocator);
+
+        virtual ~CloudscapeShadowMapBarrierPass() = default;
+
+        static AZ::RPI::Ptr<CloudscapeShadowMapBarrierPass> Create(const AZ::RPI::PassDescriptor& descriptor);
+
+    private:
+        CloudscapeShadowMapBarrierPass(const AZ::RPI::PassDescriptor& descriptor);
+
+        static constexpr char LogName[] = "CloudscapeShadowMapBarrierPass";
+
+        //! Pass behavior overrides
+        void BuildInternal() override;
+
+        //! RenderPass overrides
+        void BuildCommandListInternal(const AZ::RHI::FrameGraphExecuteContext& context) override;
+    };
+
+}   // namespace VolumetricClouds
@@ -0,0 +1,81 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <Atom/RPI.Public/RenderPipeline.h>
+#include <Atom/RPI.Public/Scene.h>
+
+#include <Renderer/CloudscapeFeatureProcessor.h>
+#include "CloudscapeShadowMapComputePass.h"
+
+namespace VolumetricClouds
+{
+
+    AZ::RPI::Ptr<CloudscapeShadowMapComputePass> CloudscapeShadowMapComputePass::Create(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        AZ::RPI::Ptr<CloudscapeShadowMapComputePass> pass = aznew CloudscapeShadowMapComputePass(descriptor);
+        return pass;
+    }
+
+    CloudscapeShadowMapComputePass::CloudscapeShadowMapComputePass(const AZ::RPI::PassDescriptor& descriptor)
+        : CloudscapeComputePass(descriptor)
+    {
+        m_compileStatsScope = StatsScope::CloudscapeShadowMapCompileCpu;
+        // The feature processor decides when the shadow map needs to be refreshed.
+        SetIdle(true);
+    }
+
+    void CloudscapeShadowMapComputePass::BuildInternal()
+    {
+        AZ::RPI::Scene* scene = m_pipeline->GetScene();
+        auto* cloudscapeFeatureProcessor = scene->GetFeatureProcessor<CloudscapeFeatureProcessor>();
+        if (!cloudscapeFeatureProcessor)
+        {
+            // This can happen when the feature processor is being destroyed.
+            return;
+        }
+
+        const auto shadowMapImageAttachment = cloudscapeFeatureProcessor->GetCloudShadowMapImageAttachment(m_pipeline);
+        if (!shadowMapImageAttachment)
+        {
+            AZ_Error(LogName, false, "The cloud shadow map attachment of render pipeline %s doesn't exist", m_pipeline->GetId().GetCStr());
+            return;
+        }
+        const auto slotName = AZ::Name("CloudShadowMap");
+        auto binding = FindAttachmentBinding(slotName);
+        if (!binding)
+        {
+            AZ_Error(LogName, false, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+            return;
+        }
+
+        // Same as CloudscapeComputePass, the *.pass asset uses "NoBind" because the attachment
+        // is created at runtime by the CloudscapeFeatureProcessor.
+        binding->m_shaderInputName = AZ::Name("m_cloudShadowMapOut");
+        AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(shadowMapImageAttachment->GetDescriptor().m_format,
+            0, 0);
+        binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+        AttachImageToSlot(slotName, shadowMapImageAttachment);
+
+        const AZ::RHI::Size shadowMapSize = shadowMapImageAttachment->GetDescriptor().m_size;
+        SetTargetThreadCounts(shadowMapSize.m_width, shadowMapSize.m_height, 1);
+    }
+
+    void CloudscapeShadowMapComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
+    {
+        m_shaderResourceGroup->SetConstant(m_cloudShadowMapCenterKmIndex, m_centerKm);
+        m_shaderResourceGroup->SetConstant(m_cloudShadowMapSizeKmIndex, m_sizeKm);
+
+        CloudscapeComputePass::CompileResources(context);
+    }
+
+    void CloudscapeShadowMapComputePass::UpdateRegion(const AZ::Vector2& centerKm, float sizeKm)
+    {
+        m_centerKm = centerKm;
+        m_sizeKm = sizeKm;
+    }
+
+}   // namespace VolumetricClouds
@@ -0,0 +1,59 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/Math/Vector2.h>
+
+#include <Renderer/Passes/CloudscapeComputePass.h>
+
+namespace VolumetricClouds
+{
+    /**
+     *  Renders the top-down cloud shadow map, owned by the CloudscapeFeatureProcessor: for each texel
+     *  of a square area around the camera, the transmittance towards the sun from the ground.
+     *  Terrain, foliage, fog, etc. read it through the "CloudShadowMap" slot or through
+     *  SceneSrg::m_cloudShadowMap instead of ray marching the clouds. The frame graph only knows about the
+     *  SceneSrg readers through CloudscapeShadowMapBarrierPass.
+     *  The map only changes when the sun or the wind move enough, so the feature processor
+     *  keeps this pass idle most of the frames.
+     */
+    class CloudscapeShadowMapComputePass final
+        : public CloudscapeComputePass
+    {
+        AZ_RPI_PASS(CloudscapeShadowMapComputePass);
+
+    public:
+        AZ_RTTI(CloudscapeShadowMapComputePass, "{C51D7E2A-94B6-4F3C-8E07-2A6B1F9D54E3}", CloudscapeComputePass);
+        AZ_CLASS_ALLOCATOR(CloudscapeShadowMapComputePass, AZ::SystemAllocator);
+
+        virtual ~CloudscapeShadowMapComputePass() = default;
+
+        static AZ::RPI::Ptr<CloudscapeShadowMapComputePass> Create(const AZ::RPI::PassDescriptor& descriptor);
+
+        // The area covered by the next dispatch. @centerKm is the world XY position, in kilometers,
+        // of the center of the shadow map.
+        void UpdateRegion(const AZ::Vector2& centerKm, float sizeKm);
+
+    private:
+        CloudscapeShadowMapComputePass(const AZ::RPI::PassDescriptor& descriptor);
+
+        static constexpr char LogName[] = "CloudscapeShadowMapComputePass";
+
+        //! Pass behavior overrides
+        void BuildInternal() override;
+
+        // Scope producer functions...
+        void CompileResources(const AZ::RHI::FrameGraphCompileContext& context) override;
+
+        AZ::Vector2 m_centerKm = AZ::Vector2::CreateZero();
+        float m_sizeKm = 0.0f;
+
+        AZ::RHI::ShaderInputNameIndex m_cloudShadowMapCenterKmIndex = "m_cloudShadowMapCenterKm";
+        AZ::RHI::ShaderInputNameIndex m_cloudShadowMapSizeKmIndex = "m_cloudShadowMapSizeKm";
+    };
+
+}   // namespace VolumetricClouds
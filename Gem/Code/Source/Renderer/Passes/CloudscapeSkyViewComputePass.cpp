@@ -0,0 +1,90 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <Atom/RPI.Public/RenderPipeline.h>
+#include <Atom/RPI.Public/Scene.h>
+
+#include <Renderer/CloudscapeFeatureProcessor.h>
+#include "CloudscapeSkyViewComputePass.h"
+
+namespace VolumetricClouds
+{
+
+    AZ::RPI::Ptr<CloudscapeSkyViewComputePass> CloudscapeSkyViewComputePass::Create(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        AZ::RPI::Ptr<CloudscapeSkyViewComputePass> pass = aznew CloudscapeSkyViewComputePass(descriptor);
+        return pass;
+    }
+
+    CloudscapeSkyViewComputePass::CloudscapeSkyViewComputePass(const AZ::RPI::PassDescriptor& descriptor)
+        : CloudscapeComputePass(descriptor)
+    {
+        m_compileStatsScope = StatsScope::CloudscapeSkyViewCompileCpu;
+    }
+
+    void CloudscapeSkyViewComputePass::BuildInternal()
+    {
+        AZ::RPI::Scene* scene = m_pipeline->GetScene();
+        auto* cloudscapeFeatureProcessor = scene->GetFeatureProcessor<CloudscapeFeatureProcessor>();
+        if (!cloudscapeFeatureProcessor)
+        {
+            // This can happen when the feature processor is being destroyed.
+            return;
+        }
+
+        const auto skyViewImageAttachment = cloudscapeFeatureProcessor->GetSkyViewImageAttachment(m_pipeline);
+        if (!skyViewImageAttachment)
+        {
+            AZ_Error(LogName, false, "The sky-view attachment of render pipeline %s doesn't exist", m_pipeline->GetId().GetCStr());
+            return;
+        }
+        const auto slotName = AZ::Name("SkyViewOutput");
+        auto binding = FindAttachmentBinding(slotName);
+        if (!binding)
+        {
+            AZ_Error(LogName, false, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+            return;
+        }
+
+        // Same as CloudscapeComputePass, the *.pass asset uses "NoBind" because the attachment
+        // is created at runtime by the CloudscapeFeatureProcessor.
+        binding->m_shaderInputName = AZ::Name("m_skyViewOut");
+        AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(skyViewImageAttachment->GetDescriptor().m_format,
+            0, 0);
+        binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+        AttachImageToSlot(slotName, skyViewImageAttachment);
+
+        m_skyViewSize = skyViewImageAttachment->GetDescriptor().m_size;
+        UpdateTargetThreadCounts();
+    }
+
+    void CloudscapeSkyViewComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
+    {
+        m_shaderResourceGroup->SetConstant(m_skyViewSliceIndexIndex, m_sliceIndex);
+        m_shaderResourceGroup->SetConstant(m_skyViewSliceCountIndex, m_sliceCount);
+
+        CloudscapeComputePass::CompileResources(context);
+    }
+
+    void CloudscapeSkyViewComputePass::UpdateSlice(uint32_t sliceIndex, uint32_t sliceCount)
+    {
+        sliceCount = AZStd::max(sliceCount, 1u);
+        m_sliceIndex = sliceIndex % sliceCount;
+        if (m_sliceCount != sliceCount)
+        {
+            m_sliceCount = sliceCount;
+            UpdateTargetThreadCounts();
+        }
+    }
+
+    void CloudscapeSkyViewComputePass::UpdateTargetThreadCounts()
+    {
+        const uint32_t sliceWidth = (m_skyViewSize.m_width + m_sliceCount - 1) / m_sliceCount;
+        SetTargetThreadCounts(sliceWidth, m_skyViewSize.m_height, 1);
+    }
+
+}   // namespace VolumetricClouds
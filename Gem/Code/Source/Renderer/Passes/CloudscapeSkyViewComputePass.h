@@ -0,0 +1,59 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <Renderer/Passes/CloudscapeComputePass.h>
+
+namespace VolumetricClouds
+{
+    /**
+     *  Ray marches the far away clouds into a low resolution latitude/longitude
+     *  texture (the sky-view texture) owned by the CloudscapeFeatureProcessor.
+     *  The texture is refreshed in vertical slices, only one slice per frame, and
+     *  CloudscapeRasterPass samples it for all the pixels where the clouds are farther than
+     *  CloudscapeRenderSettings::m_skyViewStartDistanceKm. This way only the near
+     *  clouds are ray marched per pixel by CloudscapeComputePass.
+     */
+    class CloudscapeSkyViewComputePass final
+        : public CloudscapeComputePass
+    {
+        AZ_RPI_PASS(CloudscapeSkyViewComputePass);
+
+    public:
+        AZ_RTTI(CloudscapeSkyViewComputePass, "{6F0E9B3C-8A41-4D27-B5E2-91C3D7A40F18}", CloudscapeComputePass);
+        AZ_CLASS_ALLOCATOR(CloudscapeSkyViewComputePass, AZ::SystemAllocator);
+
+        virtual ~CloudscapeSkyViewComputePass() = default;
+
+        static AZ::RPI::Ptr<CloudscapeSkyViewComputePass> Create(const AZ::RPI::PassDescriptor& descriptor);
+
+        // Defines which vertical slice of the sky-view texture is refreshed in the current frame.
+        void UpdateSlice(uint32_t sliceIndex, uint32_t sliceCount);
+
+    private:
+        CloudscapeSkyViewComputePass(const AZ::RPI::PassDescriptor& descriptor);
+
+        static constexpr char LogName[] = "CloudscapeSkyViewComputePass";
+
+        //! Pass behavior overrides
+        void BuildInternal() override;
+
+        // Scope producer functions...
+        void CompileResources(const AZ::RHI::FrameGraphCompileContext& context) override;
+
+        // Dispatches one thread per texel of the current slice.
+        void UpdateTargetThreadCounts();
+
+        uint32_t m_sliceIndex = 0;
+        uint32_t m_sliceCount = 1;
+        AZ::RHI::Size m_skyViewSize;
+
+        AZ::RHI::ShaderInputNameIndex m_skyViewSliceIndexIndex = "m_skyViewSliceIndex";
+        AZ::RHI::ShaderInputNameIndex m_skyViewSliceCountIndex = "m_skyViewSliceCount";
+    };
+
+}   // namespace VolumetricClouds
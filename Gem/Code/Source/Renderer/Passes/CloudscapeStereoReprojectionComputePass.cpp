@@ -0,0 +1,133 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <Atom/RHI/FrameGraphInterface.h>
+
+#include <Atom/RPI.Public/Pass/PassFilter.h>
+#include <Atom/RPI.Public/Pass/PassSystemInterface.h>
+#include <Atom/RPI.Public/RenderPipeline.h>
+#include <Atom/RPI.Public/Scene.h>
+
+#include <Renderer/CloudscapeFeatureProcessor.h>
+#include "CloudscapeStereoReprojectionComputePass.h"
+
+namespace VolumetricClouds
+{
+
+    AZ::RPI::Ptr<CloudscapeStereoReprojectionComputePass> CloudscapeStereoReprojectionComputePass::Create(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        AZ::RPI::Ptr<CloudscapeStereoReprojectionComputePass> pass = aznew CloudscapeStereoReprojectionComputePass(descriptor);
+        return pass;
+    }
+
+    CloudscapeStereoReprojectionComputePass::CloudscapeStereoReprojectionComputePass(const AZ::RPI::PassDescriptor& descriptor)
+        : CloudscapeComputePass(descriptor)
+    {
+        // The feature processor enables it once the left eye exists.
+        SetIdle(true);
+    }
+
+    void CloudscapeStereoReprojectionComputePass::SetSourceImageAttachmentBinding(const char* slotNamePrefix, const char* shaderInputName,
+        uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage)
+    {
+        const auto slotName = AZ::Name(AZStd::string::format("%s%u", slotNamePrefix, attachmentIndex));
+        auto binding = FindAttachmentBinding(slotName);
+        AZ_Assert(!!binding, "Failed to find attachment binding for slot %s", slotName.GetCStr());
+
+        // Same as CloudscapeComputePass, the *.pass asset uses "NoBind" because the attachments
+        // are created at runtime by the CloudscapeFeatureProcessor.
+        binding->m_shaderInputName = AZ::Name(shaderInputName);
+        binding->m_shaderInputArrayIndex = static_cast<uint16_t>(attachmentIndex);
+        AZ::RHI::ImageViewDescriptor viewDesc = AZ::RHI::ImageViewDescriptor::Create(attachmentImage->GetDescriptor().m_format,
+            0, 0);
+        binding->m_unifiedScopeDesc.SetAsImage(viewDesc);
+
+        AttachImageToSlot(slotName, attachmentImage);
+    }
+
+    void CloudscapeStereoReprojectionComputePass::BuildInternal()
+    {
+        AZ::RPI::Scene* scene = m_pipeline->GetScene();
+        auto* cloudscapeFeatureProcessor = scene->GetFeatureProcessor<CloudscapeFeatureProcessor>();
+        if (!cloudscapeFeatureProcessor)
+        {
+            // This can happen when the feature processor is being destroyed.
+            return;
+        }
+
+        const AZ::RPI::RenderPipeline* sourceRenderPipeline = cloudscapeFeatureProcessor->GetStereoSourceRenderPipeline(m_pipeline);
+        const auto sourceOutput0 = cloudscapeFeatureProcessor->GetOutput0ImageAttachment(sourceRenderPipeline);
+        const auto sourceOutput1 = cloudscapeFeatureProcessor->GetOutput1ImageAttachment(sourceRenderPipeline);
+        const auto sourceCloudAlpha0 = cloudscapeFeatureProcessor->GetCloudAlpha0ImageAttachment(sourceRenderPipeline);
+        const auto sourceCloudAlpha1 = cloudscapeFeatureProcessor->GetCloudAlpha1ImageAttachment(sourceRenderPipeline);
+        if (!sourceOutput0 || !sourceOutput1 || !sourceCloudAlpha0 || !sourceCloudAlpha1)
+        {
+            AZ_Error(LogName, false, "The first eye of render pipeline %s doesn't have cloudscape attachments", m_pipeline->GetId().GetCStr());
+            return;
+        }
+        SetSourceImageAttachmentBinding("SourceCloudscape", "m_sourceCloudscapeTexture", 0, sourceOutput0);
+        SetSourceImageAttachmentBinding("SourceCloudscape", "m_sourceCloudscapeTexture", 1, sourceOutput1);
+        SetSourceImageAttachmentBinding("SourceCloudAlpha", "m_sourceCloudscapeAlphaTexture", 0, sourceCloudAlpha0);
+        SetSourceImageAttachmentBinding("SourceCloudAlpha", "m_sourceCloudscapeAlphaTexture", 1, sourceCloudAlpha1);
+
+        // One thread per pixel of this eye.
+        const auto targetOutput0 = cloudscapeFeatureProcessor->GetOutput0ImageAttachment(m_pipeline);
+        if (targetOutput0)
+        {
+            const auto attachmentSize = targetOutput0->GetDescriptor().m_size;
+            SetTargetThreadCounts(attachmentSize.m_width, attachmentSize.m_height, 1);
+        }
+    }
+
+    void CloudscapeStereoReprojectionComputePass::SetupFrameGraphDependencies(AZ::RHI::FrameGraphInterface frameGraph)
+    {
+        CloudscapeComputePass::SetupFrameGraphDependencies(frameGraph);
+
+        AZ::RPI::Scene* scene = m_pipeline->GetScene();
+        auto* cloudscapeFeatureProcessor = scene ? scene->GetFeatureProcessor<CloudscapeFeatureProcessor>() : nullptr;
+        const AZ::RPI::RenderPipeline* sourceRenderPipeline = cloudscapeFeatureProcessor
+            ? cloudscapeFeatureProcessor->GetStereoSourceRenderPipeline(m_pipeline)
+            : nullptr;
+        if (!sourceRenderPipeline)
+        {
+            return;
+        }
+
+        // The source attachments belong to another render pipeline, so the frame graph doesn't see them as
+        // outputs of a previous pass of this pipeline. Explicitly run after all the passes of the first eye
+        // that write them in the current frame. The feature processor only pairs the eyes when the
+        // render pipeline of the first eye comes first, so those scopes are already in the frame graph.
+        const char* sourcePassNames[] = { "CloudscapeComputePass", "CloudscapeReprojectionComputePass", "CloudscapeFusedRasterPass" };
+        for (const char* sourcePassName : sourcePassNames)
+        {
+            AZ::RPI::PassFilter passFilter = AZ::RPI::PassFilter::CreateWithPassName(AZ::Name(sourcePassName), sourceRenderPipeline);
+            const AZ::RPI::RenderPass* sourcePass = azrtti_cast<AZ::RPI::RenderPass*>(AZ::RPI::PassSystemInterface::Get()->FindFirstPass(passFilter));
+            if (sourcePass && sourcePass->IsEnabled())
+            {
+                frameGraph.ExecuteAfter(sourcePass->GetScopeId());
+            }
+        }
+    }
+
+    void CloudscapeStereoReprojectionComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
+    {
+        m_shaderResourceGroup->SetConstant(m_sourceWorldToClipMatrixIndex, m_sourceWorldToClipMatrix);
+        m_shaderResourceGroup->SetConstant(m_sourceTextureIndexIndex, m_sourceTextureIndex);
+        m_shaderResourceGroup->SetConstant(m_targetTextureIndexIndex, m_targetTextureIndex);
+
+        CloudscapeComputePass::CompileResources(context);
+    }
+
+    void CloudscapeStereoReprojectionComputePass::UpdateSourceEye(const AZ::Matrix4x4& sourceWorldToClipMatrix,
+        uint32_t sourceTextureIndex, uint32_t targetTextureIndex)
+    {
+        m_sourceWorldToClipMatrix = sourceWorldToClipMatrix;
+        m_sourceTextureIndex = sourceTextureIndex;
+        m_targetTextureIndex = targetTextureIndex;
+    }
+
+}   // namespace VolumetricClouds
@@ -0,0 +1,72 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/Math/Matrix4x4.h>
+
+#include <Atom/RPI.Public/Image/AttachmentImage.h>
+
+#include <Renderer/Passes/CloudscapeComputePass.h>
+
+namespace VolumetricClouds
+{
+    /**
+     *  Only added to the render pipeline of the second eye of a stereo (XR) pair.
+     *  Instead of ray marching the clouds again, it reprojects the cloudscape texture
+     *  that CloudscapeComputePass produced for the first eye into the cloudscape texture
+     *  of the second eye. The clouds are so far away that the disparity between the eyes
+     *  is sub-pixel, so each pixel is reprojected by its view direction only.
+     *  The pixels that fall outside the frustum of the first eye are ray marched, that's why
+     *  this class derives from CloudscapeComputePass, it needs the exact same shader constants.
+     *  The cloudscape textures of the first eye are bound at runtime because they belong
+     *  to another render pipeline.
+     */
+    class CloudscapeStereoReprojectionComputePass final
+        : public CloudscapeComputePass
+    {
+        AZ_RPI_PASS(CloudscapeStereoReprojectionComputePass);
+
+    public:
+        AZ_RTTI(CloudscapeStereoReprojectionComputePass, "{0C5B7E92-3D1A-4F6E-A8B4-E27D91C65F30}", CloudscapeComputePass);
+        AZ_CLASS_ALLOCATOR(CloudscapeStereoReprojectionComputePass, AZ::SystemAllocator);
+
+        virtual ~CloudscapeStereoReprojectionComputePass() = default;
+
+        static AZ::RPI::Ptr<CloudscapeStereoReprojectionComputePass> Create(const AZ::RPI::PassDescriptor& descriptor);
+
+        // @sourceWorldToClipMatrix is the world to clip matrix of the first eye in the current frame.
+        // @sourceTextureIndex is the cloudscape texture of the first eye written in the current frame, and
+        // @targetTextureIndex is the cloudscape texture of this eye that CloudscapeRasterPass reads in the current frame.
+        void UpdateSourceEye(const AZ::Matrix4x4& sourceWorldToClipMatrix, uint32_t sourceTextureIndex, uint32_t targetTextureIndex);
+
+    private:
+        CloudscapeStereoReprojectionComputePass(const AZ::RPI::PassDescriptor& descriptor);
+
+        static constexpr char LogName[] = "CloudscapeStereoReprojectionComputePass";
+
+        //! Pass behavior overrides
+        void BuildInternal() override;
+
+        // Scope producer functions...
+        void SetupFrameGraphDependencies(AZ::RHI::FrameGraphInterface frameGraph) override;
+        void CompileResources(const AZ::RHI::FrameGraphCompileContext& context) override;
+
+        // A helper function. Binds @attachmentImage to the slot @slotNamePrefix<attachmentIndex>,
+        // and to the element @attachmentIndex of the shader array @shaderInputName.
+        void SetSourceImageAttachmentBinding(const char* slotNamePrefix, const char* shaderInputName,
+            uint32_t attachmentIndex, AZ::Data::Instance<AZ::RPI::AttachmentImage> attachmentImage);
+
+        AZ::Matrix4x4 m_sourceWorldToClipMatrix = AZ::Matrix4x4::CreateIdentity();
+        uint32_t m_sourceTextureIndex = 0;
+        uint32_t m_targetTextureIndex = 0;
+
+        AZ::RHI::ShaderInputNameIndex m_sourceWorldToClipMatrixIndex = "m_sourceWorldToClipMatrix";
+        AZ::RHI::ShaderInputNameIndex m_sourceTextureIndexIndex = "m_sourceTextureIndex";
+        AZ::RHI::ShaderInputNameIndex m_targetTextureIndexIndex = "m_targetTextureIndex";
+    };
+
+}   // namespace VolumetricClouds
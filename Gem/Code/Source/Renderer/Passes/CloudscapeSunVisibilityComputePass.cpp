@@ -0,0 +1,65 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include "CloudscapeSunVisibilityComputePass.h"
+
+namespace VolumetricClouds
+{
+
+    AZ::RPI::Ptr<CloudscapeSunVisibilityComputePass> CloudscapeSunVisibilityComputePass::Create(const AZ::RPI::PassDescriptor& descriptor)
+    {
+        AZ::RPI::Ptr<CloudscapeSunVisibilityComputePass> pass = aznew CloudscapeSunVisibilityComputePass(descriptor);
+        return pass;
+    }
+
+    CloudscapeSunVisibilityComputePass::CloudscapeSunVisibilityComputePass(const AZ::RPI::PassDescriptor& descriptor)
+        : CloudscapeComputePass(descriptor)
+    {
+        m_compileStatsScope = StatsScope::CloudscapeSunVisibilityCompileCpu;
+        m_positions.resize(MaxPositions, AZ::Vector4::CreateZero());
+        SetIdle(true);
+    }
+
+    void CloudscapeSunVisibilityComputePass::BuildInternal()
+    {
+        // Unlike CloudscapeComputePass, the only attachment is the transient buffer declared in the *.pass asset.
+        SetTargetThreadCounts(AZStd::max(m_positionCount, 1u), 1, 1);
+        // The shader resource group may be new.
+        m_positionsNeedUpdate = true;
+    }
+
+    void CloudscapeSunVisibilityComputePass::CompileResources(const AZ::RHI::FrameGraphCompileContext& context)
+    {
+        if (m_positionsNeedUpdate)
+        {
+            m_shaderResourceGroup->SetConstant(m_positionCountIndex, m_positionCount);
+            m_shaderResourceGroup->SetConstantArray(m_positionsIndex, AZStd::span<const AZ::Vector4>(m_positions.data(), m_positions.size()));
+            m_positionsNeedUpdate = false;
+        }
+
+        CloudscapeComputePass::CompileResources(context);
+    }
+
+    void CloudscapeSunVisibilityComputePass::SetPositions(AZStd::span<const AZ::Vector3> worldPositions)
+    {
+        AZ_Warning(LogName, worldPositions.size() <= MaxPositions, "Only the first %u of %zu sun visibility positions are evaluated.",
+            MaxPositions, worldPositions.size());
+        const uint32_t positionCount = static_cast<uint32_t>(AZStd::min<size_t>(worldPositions.size(), MaxPositions));
+        for (uint32_t positionIndex = 0; positionIndex < positionCount; ++positionIndex)
+        {
+            m_positions[positionIndex] = AZ::Vector4::CreateFromVector3(worldPositions[positionIndex]);
+        }
+        if (m_positionCount != positionCount)
+        {
+            m_positionCount = positionCount;
+            SetTargetThreadCounts(AZStd::max(m_positionCount, 1u), 1, 1);
+        }
+        m_positionsNeedUpdate = true;
+        SetIdle(m_positionCount == 0);
+    }
+
+}   // namespace VolumetricClouds
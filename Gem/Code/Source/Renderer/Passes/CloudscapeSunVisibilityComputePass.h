@@ -0,0 +1,67 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/Math/Vector3.h>
+#include <AzCore/Math/Vector4.h>
+#include <AzCore/std/containers/span.h>
+#include <AzCore/std/containers/vector.h>
+
+#include <Renderer/Passes/CloudscapeComputePass.h>
+
+namespace VolumetricClouds
+{
+    /**
+     *  Marches from a short list of world positions towards the sun through the cloud slab, and writes
+     *  the transmittance of each position to the "SunTransmittance" buffer, which is read back by
+     *  the CloudscapeFeatureProcessor. This way gameplay can know how much the clouds dim the sun
+     *  at, for example, the player position, without a CPU model of the clouds.
+     *  Derives from CloudscapeComputePass because it needs the exact same shader constants.
+     */
+    class CloudscapeSunVisibilityComputePass final
+        : public CloudscapeComputePass
+    {
+        AZ_RPI_PASS(CloudscapeSunVisibilityComputePass);
+
+    public:
+        AZ_RTTI(CloudscapeSunVisibilityComputePass, "{3B7A95E1-2C64-4F08-A1D3-8E56F0B2C497}", CloudscapeComputePass);
+        AZ_CLASS_ALLOCATOR(CloudscapeSunVisibilityComputePass, AZ::SystemAllocator);
+
+        // Must match SUN_VISIBILITY_MAX_POSITIONS in CloudscapeSunVisibilityCS.azsl
+        // and the size of the buffer in CloudscapeSunVisibilityComputePass.pass.
+        static constexpr uint32_t MaxPositions = 256;
+
+        virtual ~CloudscapeSunVisibilityComputePass() = default;
+
+        static AZ::RPI::Ptr<CloudscapeSunVisibilityComputePass> Create(const AZ::RPI::PassDescriptor& descriptor);
+
+        // World positions, in meters, evaluated by the next dispatches. Only the first MaxPositions are used.
+        // The pass is idle while there are no positions.
+        void SetPositions(AZStd::span<const AZ::Vector3> worldPositions);
+        uint32_t GetPositionCount() const { return m_positionCount; }
+
+    private:
+        CloudscapeSunVisibilityComputePass(const AZ::RPI::PassDescriptor& descriptor);
+
+        static constexpr char LogName[] = "CloudscapeSunVisibilityComputePass";
+
+        //! Pass behavior overrides
+        void BuildInternal() override;
+
+        // Scope producer functions...
+        void CompileResources(const AZ::RHI::FrameGraphCompileContext& context) override;
+
+        // The positions are stored as float4, like the shader array.
+        AZStd::vector<AZ::Vector4> m_positions;
+        uint32_t m_positionCount = 0;
+        bool m_positionsNeedUpdate = true;
+
+        AZ::RHI::ShaderInputNameIndex m_positionCountIndex = "m_sunVisibilityPositionCount";
+        AZ::RHI::ShaderInputNameIndex m_positionsIndex = "m_sunVisibilityPositions";
+    };
+
+}   // namespace VolumetricClouds
@@ -0,0 +1,101 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/std/containers/array.h>
+#include <AzCore/std/parallel/atomic.h>
+#include <AzCore/std/parallel/thread.h>
+
+namespace VolumetricClouds
+{
+    // Multiple producers, single consumer. Lock-free hand off of the latest value from any thread to one consumer thread.
+    // Each producer claims a free slot, writes into it and then swaps it with the "ready" slot, the slot it gets back
+    // is returned to the free slots. When several producers stage at the same time, the last one to swap wins.
+    // The consumer, once per frame, swaps the ready slot with its own slot if a producer wrote something since
+    // the last time. The consumer never waits, and the slot returned by GetPublished() is never touched by the
+    // producers, so the consumer can keep pointers into it until the next Publish().
+    // With @MaxProducers == 1 this is the classic triple buffer. Stage() only waits for a free slot, yielding
+    // the thread, while more than @MaxProducers producers are staging at the same time.
+    template<typename T, uint32_t MaxProducers = 4>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+
+        // Producer side. Can be called from any thread.
+        void Stage(const T& value)
+        {
+            const uint32_t stagingIndex = ClaimFreeSlot();
+            m_slots[stagingIndex] = value;
+            const uint32_t previousReady = m_readyState.exchange(stagingIndex | NewDataBit, AZStd::memory_order_acq_rel);
+            // Either a value that was never published, or the slot the consumer released in its last Publish().
+            m_freeSlots.fetch_or(1u << (previousReady & IndexMask), AZStd::memory_order_release);
+        }
+
+        // Consumer side. Returns true if GetPublished() changed.
+        bool Publish()
+        {
+            if ((m_readyState.load(AZStd::memory_order_relaxed) & NewDataBit) == 0)
+            {
+                return false;
+            }
+            const uint32_t previousReady = m_readyState.exchange(m_publishedIndex, AZStd::memory_order_acq_rel);
+            m_publishedIndex = previousReady & IndexMask;
+            return true;
+        }
+
+        const T& GetPublished() const
+        {
+            return m_slots[m_publishedIndex];
+        }
+
+    private:
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // One slot being written per producer, plus the ready and the published slots.
+        static constexpr uint32_t SlotCount = MaxProducers + 2;
+        static_assert(MaxProducers >= 1 && SlotCount < 32, "TripleBuffer: the free slots must fit in a 32 bits mask");
+        static constexpr uint32_t IndexMask = 0x1F;
+        static constexpr uint32_t NewDataBit = 0x20;
+
+        uint32_t ClaimFreeSlot()
+        {
+            uint32_t freeSlots = m_freeSlots.load(AZStd::memory_order_relaxed);
+            while (true)
+            {
+                if (freeSlots == 0)
+                {
+                    // More than MaxProducers producers are staging, let one of them finish.
+                    AZStd::this_thread::yield();
+                    freeSlots = m_freeSlots.load(AZStd::memory_order_relaxed);
+                    continue;
+                }
+                const uint32_t slotBit = freeSlots & (~freeSlots + 1);
+                // Acquire, so the writes to the slot happen after whoever used it last released it.
+                if (m_freeSlots.compare_exchange_weak(freeSlots, freeSlots & ~slotBit, AZStd::memory_order_acquire, AZStd::memory_order_relaxed))
+                {
+                    uint32_t slotIndex = 0;
+                    while ((slotBit >> slotIndex) != 1)
+                    {
+                        ++slotIndex;
+                    }
+                    return slotIndex;
+                }
+            }
+        }
+
+        AZStd::array<T, SlotCount> m_slots;
+        // Bit i is set when slot i is not the ready slot, the published slot or being written by a producer.
+        AZStd::atomic<uint32_t> m_freeSlots{ ((1u << SlotCount) - 1) & ~0x3u };
+        // Index of the slot between the producers and the consumer, plus NewDataBit.
+        AZStd::atomic<uint32_t> m_readyState{ 0 };
+        // Only accessed by the consumer.
+        uint32_t m_publishedIndex = 1;
+    };
+
+} // namespace VolumetricClouds
@@ -0,0 +1,508 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <cinttypes>
+
+#include <AzCore/Console/IConsole.h>
+#include <AzCore/StringFunc/StringFunc.h>
+#include <AzCore/std/sort.h>
+
+#include <Atom/RPI.Public/Pass/Pass.h>
+
+#include "VolumetricCloudsStatsCollector.h"
+
+namespace VolumetricClouds
+{
+    AZ_CVAR(bool, r_volumetricCloudsCollectStats, false, nullptr, AZ::ConsoleFunctorFlags::Null,
+        "Enables the GPU timestamp and pipeline statistics queries of the volumetric clouds passes, and the CPU timing of their resource compilation.");
+
+    static void r_volumetricCloudsPrintStats([[maybe_unused]] const AZ::ConsoleCommandContainer& arguments)
+    {
+        if (auto collector = VolumetricCloudsStatsCollector::Get())
+        {
+            collector->PrintStats();
+        }
+    }
+    AZ_CONSOLEFREEFUNC(r_volumetricCloudsPrintStats, AZ::ConsoleFunctorFlags::Null,
+        "Prints the rolling averages and percentiles of the volumetric clouds passes. Requires r_volumetricCloudsCollectStats.");
+
+    static void r_volumetricCloudsResetStats([[maybe_unused]] const AZ::ConsoleCommandContainer& arguments)
+    {
+        if (auto collector = VolumetricCloudsStatsCollector::Get())
+        {
+            collector->ResetStats();
+        }
+    }
+    AZ_CONSOLEFREEFUNC(r_volumetricCloudsResetStats, AZ::ConsoleFunctorFlags::Null,
+        "Discards all the samples collected for the volumetric clouds passes.");
+
+    static void r_volumetricCloudsStartCsvLog(const AZ::ConsoleCommandContainer& arguments)
+    {
+        if (arguments.empty())
+        {
+            AZ_Warning("VolumetricCloudsStats", false, "Usage: r_volumetricCloudsStartCsvLog <file path>");
+            return;
+        }
+        if (auto collector = VolumetricCloudsStatsCollector::Get())
+        {
+            collector->StartCsvFrameLog(AZStd::string(arguments[0]));
+        }
+    }
+    AZ_CONSOLEFREEFUNC(r_volumetricCloudsStartCsvLog, AZ::ConsoleFunctorFlags::Null,
+        "Writes the per frame timings of the volumetric clouds passes to the given CSV file. Enables r_volumetricCloudsCollectStats until "
+        "r_volumetricCloudsStopCsvLog is called.");
+
+    static void r_volumetricCloudsStopCsvLog([[maybe_unused]] const AZ::ConsoleCommandContainer& arguments)
+    {
+        if (auto collector = VolumetricCloudsStatsCollector::Get())
+        {
+            collector->StopCsvFrameLog();
+        }
+    }
+    AZ_CONSOLEFREEFUNC(r_volumetricCloudsStopCsvLog, AZ::ConsoleFunctorFlags::Null,
+        "Closes the CSV file opened with r_volumetricCloudsStartCsvLog.");
+
+    static void r_volumetricCloudsBenchmark(const AZ::ConsoleCommandContainer& arguments)
+    {
+        int frameCount = 0;
+        if ((arguments.size() < 3) || !AZ::StringFunc::LooksLikeInt(AZStd::string(arguments[1]).c_str(), &frameCount) || (frameCount <= 0))
+        {
+            AZ_Warning("VolumetricCloudsStats", false, "Usage: r_volumetricCloudsBenchmark <label> <frame count> <summary file path>");
+            return;
+        }
+        if (auto collector = VolumetricCloudsStatsCollector::Get())
+        {
+            collector->StartBenchmark(AZStd::string(arguments[0]), static_cast<uint32_t>(frameCount), AZStd::string(arguments[2]));
+        }
+    }
+    AZ_CONSOLEFREEFUNC(r_volumetricCloudsBenchmark, AZ::ConsoleFunctorFlags::Null,
+        "Measures the volumetric clouds passes during the given number of frames and appends the results, tagged with the label, "
+        "to the given CSV file. Run it before and after a change to compare them. Enables r_volumetricCloudsCollectStats while it runs. "
+        "The cloud convergence and dynamic quality are suspended while it runs, so every frame is measured at the highest quality.");
+
+
+    VolumetricCloudsStatsCollector::VolumetricCloudsStatsCollector()
+    {
+        VolumetricCloudsStatsInterface::Register(this);
+        VolumetricCloudsStatsRequestBus::Handler::BusConnect();
+    }
+
+    VolumetricCloudsStatsCollector::~VolumetricCloudsStatsCollector()
+    {
+        if (IsBenchmarkRunning())
+        {
+            m_benchmarkFramesLeft = 0;
+            RestoreCollectingStats();
+        }
+        StopCsvFrameLog();
+        VolumetricCloudsStatsRequestBus::Handler::BusDisconnect();
+        VolumetricCloudsStatsInterface::Unregister(this);
+    }
+
+    VolumetricCloudsStatsCollector* VolumetricCloudsStatsCollector::Get()
+    {
+        return azrtti_cast<VolumetricCloudsStatsCollector*>(VolumetricCloudsStatsInterface::Get());
+    }
+
+    bool VolumetricCloudsStatsCollector::IsCollecting()
+    {
+        return r_volumetricCloudsCollectStats;
+    }
+
+    const char* VolumetricCloudsStatsCollector::GetScopeName(StatsScope scope)
+    {
+        switch (scope)
+        {
+        case StatsScope::CloudscapeComputeGpu: return "GPU/CloudscapeComputePass";
+        case StatsScope::CloudscapeSkyViewGpu: return "GPU/CloudscapeSkyViewComputePass";
+        case StatsScope::CloudscapeReprojectionGpu: return "GPU/CloudscapeReprojectionComputePass";
+        case StatsScope::CloudscapeRasterGpu: return "GPU/CloudscapeRasterPass";
+        case StatsScope::CloudscapeFusedRasterGpu: return "GPU/CloudscapeFusedRasterPass";
+        case StatsScope::CloudTextureComputeGpu: return "GPU/CloudTextureComputePass";
+        case StatsScope::SubmitShaderConstantDataCpu: return "CPU/SubmitShaderConstantData";
+        case StatsScope::CloudscapeComputeCompileCpu: return "CPU/CloudscapeComputePass.CompileResources";
+        case StatsScope::CloudscapeSkyViewCompileCpu: return "CPU/CloudscapeSkyViewComputePass.CompileResources";
+        case StatsScope::CloudscapeSunVisibilityCompileCpu: return "CPU/CloudscapeSunVisibilityComputePass.CompileResources";
+        case StatsScope::CloudscapeShadowMapCompileCpu: return "CPU/CloudscapeShadowMapComputePass.CompileResources";
+        case StatsScope::CloudscapeRasterCompileCpu: return "CPU/CloudscapeRasterPass.CompileResources";
+        case StatsScope::CloudTextureComputeCompileCpu: return "CPU/CloudTextureComputePass.CompileResources";
+        default: return "Unknown";
+        }
+    }
+
+    void VolumetricCloudsStatsCollector::AddSample(StatsScope scope, float milliseconds)
+    {
+        AZStd::scoped_lock lock(m_mutex);
+        auto& scopeSamples = m_scopes[static_cast<uint32_t>(scope)];
+        scopeSamples.m_samplesMs[scopeSamples.m_nextSampleIndex] = milliseconds;
+        scopeSamples.m_nextSampleIndex = (scopeSamples.m_nextSampleIndex + 1) % MaxSamplesPerScope;
+        scopeSamples.m_sampleCount = AZStd::min(scopeSamples.m_sampleCount + 1, MaxSamplesPerScope);
+        scopeSamples.m_frameMs += milliseconds;
+        scopeSamples.m_hasFrameSample = true;
+    }
+
+    void VolumetricCloudsStatsCollector::AddGpuPassSample(StatsScope scope, const AZ::RPI::Pass& pass)
+    {
+        const uint64_t durationNs = pass.GetLatestTimestampResult().GetDurationInNanoseconds();
+        if (!durationNs)
+        {
+            return;
+        }
+        AddSample(scope, static_cast<float>(durationNs) * 1.0e-6f);
+
+        const auto pipelineStatistics = pass.GetLatestPipelineStatisticsResult();
+        AZStd::scoped_lock lock(m_mutex);
+        auto& scopeSamples = m_scopes[static_cast<uint32_t>(scope)];
+        scopeSamples.m_computeShaderInvocations = pipelineStatistics.m_computeShaderInvocationCount;
+        scopeSamples.m_fragmentShaderInvocations = pipelineStatistics.m_fragmentShaderInvocationCount;
+    }
+
+    void VolumetricCloudsStatsCollector::SetRayMarchTotals(const VolumetricCloudsRayMarchTotals* totals)
+    {
+        AZStd::scoped_lock lock(m_mutex);
+        m_hasRayMarchTotals = (totals != nullptr);
+        m_rayMarchTotals = totals ? *totals : VolumetricCloudsRayMarchTotals{};
+    }
+
+    VolumetricCloudsScopeStats VolumetricCloudsStatsCollector::CalculateScopeStats(uint32_t scopeIndex) const
+    {
+        const auto& scopeSamples = m_scopes[scopeIndex];
+        VolumetricCloudsScopeStats stats;
+        stats.m_sampleCount = scopeSamples.m_sampleCount;
+        stats.m_computeShaderInvocations = scopeSamples.m_computeShaderInvocations;
+        stats.m_fragmentShaderInvocations = scopeSamples.m_fragmentShaderInvocations;
+        if (!scopeSamples.m_sampleCount)
+        {
+            return stats;
+        }
+
+        // The order of the samples in the ring buffer doesn't matter for the stats.
+        AZStd::array<float, MaxSamplesPerScope> sortedSamples = scopeSamples.m_samplesMs;
+        const auto samplesEnd = sortedSamples.begin() + scopeSamples.m_sampleCount;
+        AZStd::sort(sortedSamples.begin(), samplesEnd);
+
+        float sumMs = 0.0f;
+        for (auto it = sortedSamples.begin(); it != samplesEnd; ++it)
+        {
+            sumMs += *it;
+        }
+
+        // Nearest rank percentiles.
+        auto getPercentile = [&](float percentile) -> float
+        {
+            const uint32_t rank = static_cast<uint32_t>(ceilf(percentile * scopeSamples.m_sampleCount));
+            return sortedSamples[AZStd::clamp(rank, 1u, scopeSamples.m_sampleCount) - 1];
+        };
+
+        stats.m_averageMs = sumMs / scopeSamples.m_sampleCount;
+        stats.m_p50Ms = getPercentile(0.50f);
+        stats.m_p95Ms = getPercentile(0.95f);
+        stats.m_p99Ms = getPercentile(0.99f);
+        stats.m_maxMs = sortedSamples[scopeSamples.m_sampleCount - 1];
+        return stats;
+    }
+
+    void VolumetricCloudsStatsCollector::PrintStats() const
+    {
+        if (!IsCollecting())
+        {
+            AZ_Info(LogName, "Stats are not being collected. Set r_volumetricCloudsCollectStats to true.\n");
+        }
+
+        AZStd::scoped_lock lock(m_mutex);
+        for (uint32_t scopeIndex = 0; scopeIndex < ScopeCount; ++scopeIndex)
+        {
+            const auto stats = CalculateScopeStats(scopeIndex);
+            if (!stats.m_sampleCount)
+            {
+                continue;
+            }
+            AZ_Info(LogName, "%s: avg=%.3fms p50=%.3fms p95=%.3fms p99=%.3fms max=%.3fms samples=%u cs=%" PRIu64 " ps=%" PRIu64 "\n",
+                GetScopeName(static_cast<StatsScope>(scopeIndex)), stats.m_averageMs, stats.m_p50Ms, stats.m_p95Ms, stats.m_p99Ms,
+                stats.m_maxMs, stats.m_sampleCount, stats.m_computeShaderInvocations, stats.m_fragmentShaderInvocations);
+        }
+
+        if (m_hasRayMarchTotals && m_rayMarchTotals.m_pixelCount)
+        {
+            const auto& totals = m_rayMarchTotals;
+            const double invPixelCount = 1.0 / static_cast<double>(totals.m_pixelCount);
+            AZ_Info(LogName, "Ray march totals: pixels=%" PRIu64 " primarySteps=%" PRIu64 " (%.2f/px) lightSamples=%" PRIu64 " (%.2f/px) expensiveDensity=%" PRIu64 " (%.2f/px) cheapDensity=%" PRIu64 " (%.2f/px)\n",
+                totals.m_pixelCount, totals.m_primarySteps, totals.m_primarySteps * invPixelCount, totals.m_lightSamples, totals.m_lightSamples * invPixelCount,
+                totals.m_expensiveDensityCalls, totals.m_expensiveDensityCalls * invPixelCount, totals.m_cheapDensityCalls, totals.m_cheapDensityCalls * invPixelCount);
+            AZ_Info(LogName, "Ray march exit reasons: notMarched=%" PRIu64 " endOfSlab=%" PRIu64 " earlyExit=%" PRIu64 "\n",
+                totals.m_notRayMarchedPixels, totals.m_endOfSlabPixels, totals.m_earlyExitPixels);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////
+    //! VolumetricCloudsStatsRequestBus overrides START...
+    bool VolumetricCloudsStatsCollector::IsCollectingStats() const
+    {
+        return IsCollecting();
+    }
+
+    void VolumetricCloudsStatsCollector::SetCollectingStats(bool enable)
+    {
+        r_volumetricCloudsCollectStats = enable;
+    }
+
+    AZStd::vector<AZStd::string> VolumetricCloudsStatsCollector::GetScopeNames() const
+    {
+        AZStd::vector<AZStd::string> scopeNames;
+        scopeNames.reserve(ScopeCount);
+        for (uint32_t scopeIndex = 0; scopeIndex < ScopeCount; ++scopeIndex)
+        {
+            scopeNames.emplace_back(GetScopeName(static_cast<StatsScope>(scopeIndex)));
+        }
+        return scopeNames;
+    }
+
+    bool VolumetricCloudsStatsCollector::GetScopeStats(const AZStd::string& scopeName, VolumetricCloudsScopeStats& stats) const
+    {
+        for (uint32_t scopeIndex = 0; scopeIndex < ScopeCount; ++scopeIndex)
+        {
+            if (scopeName == GetScopeName(static_cast<StatsScope>(scopeIndex)))
+            {
+                AZStd::scoped_lock lock(m_mutex);
+                stats = CalculateScopeStats(scopeIndex);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void VolumetricCloudsStatsCollector::ResetStats()
+    {
+        AZStd::scoped_lock lock(m_mutex);
+        m_scopes = {};
+    }
+
+    bool VolumetricCloudsStatsCollector::GetRayMarchTotals(VolumetricCloudsRayMarchTotals& totals) const
+    {
+        AZStd::scoped_lock lock(m_mutex);
+        totals = m_rayMarchTotals;
+        return m_hasRayMarchTotals;
+    }
+
+    bool VolumetricCloudsStatsCollector::StartCsvFrameLog(const AZStd::string& filePath)
+    {
+        StopCsvFrameLog();
+
+        constexpr int openMode = AZ::IO::SystemFile::SF_OPEN_CREATE | AZ::IO::SystemFile::SF_OPEN_CREATE_PATH | AZ::IO::SystemFile::SF_OPEN_WRITE_ONLY;
+        if (!m_csvFile.Open(filePath.c_str(), openMode))
+        {
+            AZ_Error(LogName, false, "Failed to open the CSV frame log %s", filePath.c_str());
+            return false;
+        }
+
+        AZStd::string header = "Frame";
+        for (uint32_t scopeIndex = 0; scopeIndex < ScopeCount; ++scopeIndex)
+        {
+            header += AZStd::string::format(",%s ms", GetScopeName(static_cast<StatsScope>(scopeIndex)));
+        }
+        header += "\n";
+        m_csvFile.Write(header.c_str(), header.size());
+
+        m_csvFrameIndex = 0;
+        {
+            AZStd::scoped_lock lock(m_mutex);
+            for (auto& scopeSamples : m_scopes)
+            {
+                scopeSamples.m_frameMs = 0.0f;
+                scopeSamples.m_hasFrameSample = false;
+            }
+        }
+        ForceCollectingStats();
+        UpdateTickBusConnection();
+        AZ_Info(LogName, "Started the CSV frame log %s\n", filePath.c_str());
+        return true;
+    }
+
+    void VolumetricCloudsStatsCollector::StopCsvFrameLog()
+    {
+        if (m_csvFile.IsOpen())
+        {
+            AZ_Info(LogName, "Stopped the CSV frame log %s after %" PRIu64 " frames\n", m_csvFile.Name(), m_csvFrameIndex);
+            m_csvFile.Close();
+            RestoreCollectingStats();
+        }
+        UpdateTickBusConnection();
+    }
+
+    bool VolumetricCloudsStatsCollector::StartBenchmark(const AZStd::string& label, uint32_t frameCount, const AZStd::string& summaryFilePath)
+    {
+        if (IsBenchmarkRunning())
+        {
+            AZ_Warning(LogName, false, "The benchmark %s is still running, %u frames left", m_benchmarkLabel.c_str(), m_benchmarkFramesLeft);
+            return false;
+        }
+        if (!frameCount || summaryFilePath.empty())
+        {
+            AZ_Error(LogName, false, "A benchmark needs at least one frame and a summary file path");
+            return false;
+        }
+        // Older samples would be overwritten by the ring buffers anyway.
+        AZ_Warning(LogName, frameCount <= MaxSamplesPerScope, "The benchmark will only keep the samples of the last %u frames", MaxSamplesPerScope);
+
+        ResetStats();
+        ForceCollectingStats();
+        m_benchmarkLabel = label;
+        m_benchmarkSummaryFilePath = summaryFilePath;
+        m_benchmarkFrameCount = frameCount;
+        m_benchmarkFramesLeft = frameCount;
+        UpdateTickBusConnection();
+        AZ_Info(LogName, "Started the benchmark %s for %u frames\n", label.c_str(), frameCount);
+        return true;
+    }
+
+    bool VolumetricCloudsStatsCollector::IsBenchmarkRunning() const
+    {
+        return m_benchmarkFramesLeft > 0;
+    }
+    //! VolumetricCloudsStatsRequestBus overrides END...
+    //////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////
+    //! AZ::TickBus::Handler overrides START...
+    void VolumetricCloudsStatsCollector::OnTick([[maybe_unused]] float deltaTime, [[maybe_unused]] AZ::ScriptTimePoint time)
+    {
+        if (m_csvFile.IsOpen())
+        {
+            WriteCsvFrameRow();
+        }
+        if (IsBenchmarkRunning())
+        {
+            --m_benchmarkFramesLeft;
+            if (!m_benchmarkFramesLeft)
+            {
+                FinishBenchmark();
+                UpdateTickBusConnection();
+            }
+        }
+    }
+    //! AZ::TickBus::Handler overrides END...
+    //////////////////////////////////////////////////////////////////
+
+    void VolumetricCloudsStatsCollector::WriteCsvFrameRow()
+    {
+        AZStd::string row = AZStd::string::format("%" PRIu64, m_csvFrameIndex++);
+        {
+            AZStd::scoped_lock lock(m_mutex);
+            for (auto& scopeSamples : m_scopes)
+            {
+                if (scopeSamples.m_hasFrameSample)
+                {
+                    row += AZStd::string::format(",%.4f", scopeSamples.m_frameMs);
+                }
+                else
+                {
+                    row += ",";
+                }
+                scopeSamples.m_frameMs = 0.0f;
+                scopeSamples.m_hasFrameSample = false;
+            }
+        }
+        row += "\n";
+        m_csvFile.Write(row.c_str(), row.size());
+    }
+
+    void VolumetricCloudsStatsCollector::FinishBenchmark()
+    {
+        PrintStats();
+        RestoreCollectingStats();
+
+        const bool isNewFile = !AZ::IO::SystemFile::Exists(m_benchmarkSummaryFilePath.c_str());
+        constexpr int openMode = AZ::IO::SystemFile::SF_OPEN_CREATE | AZ::IO::SystemFile::SF_OPEN_CREATE_PATH |
+            AZ::IO::SystemFile::SF_OPEN_WRITE_ONLY | AZ::IO::SystemFile::SF_OPEN_APPEND;
+        AZ::IO::SystemFile summaryFile;
+        if (!summaryFile.Open(m_benchmarkSummaryFilePath.c_str(), openMode))
+        {
+            AZ_Error(LogName, false, "Failed to open the benchmark summary file %s", m_benchmarkSummaryFilePath.c_str());
+            return;
+        }
+
+        AZStd::string rows;
+        if (isNewFile)
+        {
+            rows = "Label,Scope,Frames,Samples,Average ms,P50 ms,P95 ms,P99 ms,Max ms\n";
+        }
+        {
+            AZStd::scoped_lock lock(m_mutex);
+            for (uint32_t scopeIndex = 0; scopeIndex < ScopeCount; ++scopeIndex)
+            {
+                const auto stats = CalculateScopeStats(scopeIndex);
+                if (!stats.m_sampleCount)
+                {
+                    continue;
+                }
+                // Fewer samples than frames, below MaxSamplesPerScope, means the scope was not measured every frame.
+                rows += AZStd::string::format("%s,%s,%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", m_benchmarkLabel.c_str(),
+                    GetScopeName(static_cast<StatsScope>(scopeIndex)), m_benchmarkFrameCount, stats.m_sampleCount, stats.m_averageMs,
+                    stats.m_p50Ms, stats.m_p95Ms, stats.m_p99Ms, stats.m_maxMs);
+            }
+        }
+        summaryFile.Write(rows.c_str(), rows.size());
+        AZ_Info(LogName, "Finished the benchmark %s, the results were appended to %s\n", m_benchmarkLabel.c_str(),
+            m_benchmarkSummaryFilePath.c_str());
+    }
+
+    void VolumetricCloudsStatsCollector::ForceCollectingStats()
+    {
+        // Only the first of the CSV frame log and the benchmark to start sees the state set by the user.
+        if (!m_isForcingCollectingStats)
+        {
+            m_wasCollectingStatsBeforeForcing = IsCollecting();
+            m_isForcingCollectingStats = true;
+        }
+        SetCollectingStats(true);
+    }
+
+    void VolumetricCloudsStatsCollector::RestoreCollectingStats()
+    {
+        // The other one may still be running.
+        if (!m_isForcingCollectingStats || m_csvFile.IsOpen() || IsBenchmarkRunning())
+        {
+            return;
+        }
+        m_isForcingCollectingStats = false;
+        SetCollectingStats(m_wasCollectingStatsBeforeForcing);
+    }
+
+    void VolumetricCloudsStatsCollector::UpdateTickBusConnection()
+    {
+        const bool needsTick = m_csvFile.IsOpen() || IsBenchmarkRunning();
+        if (needsTick && !AZ::TickBus::Handler::BusIsConnected())
+        {
+            AZ::TickBus::Handler::BusConnect();
+        }
+        else if (!needsTick)
+        {
+            AZ::TickBus::Handler::BusDisconnect();
+        }
+    }
+
+
+    ScopedCpuStatsTimer::ScopedCpuStatsTimer(StatsScope scope)
+        : m_scope(scope)
+    {
+        if (VolumetricCloudsStatsCollector::IsCollecting())
+        {
+            m_collector = VolumetricCloudsStatsCollector::Get();
+            m_startTime = AZStd::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedCpuStatsTimer::~ScopedCpuStatsTimer()
+    {
+        if (m_collector)
+        {
+            const AZStd::chrono::duration<float, AZStd::milli> elapsed = AZStd::chrono::steady_clock::now() - m_startTime;
+            m_collector->AddSample(m_scope, elapsed.count());
+        }
+    }
+
+} // namespace VolumetricClouds
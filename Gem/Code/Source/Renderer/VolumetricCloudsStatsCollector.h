@@ -0,0 +1,164 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+#pragma once
+
+#include <AzCore/Component/TickBus.h>
+#include <AzCore/IO/SystemFile.h>
+#include <AzCore/std/chrono/chrono.h>
+#include <AzCore/std/containers/array.h>
+#include <AzCore/std/parallel/mutex.h>
+
+#include <VolumetricClouds/VolumetricCloudsStatsBus.h>
+#include <VolumetricClouds/VolumetricCloudsTypeIds.h>
+
+namespace AZ::RPI
+{
+    class Pass;
+}
+
+namespace VolumetricClouds
+{
+    // The scopes measured by VolumetricCloudsStatsCollector.
+    enum class StatsScope : uint32_t
+    {
+        CloudscapeComputeGpu,
+        CloudscapeSkyViewGpu,
+        CloudscapeReprojectionGpu,
+        CloudscapeRasterGpu,
+        CloudscapeFusedRasterGpu,
+        CloudTextureComputeGpu,
+        SubmitShaderConstantDataCpu,
+        CloudscapeComputeCompileCpu,
+        CloudscapeSkyViewCompileCpu,
+        CloudscapeSunVisibilityCompileCpu,
+        CloudscapeShadowMapCompileCpu,
+        CloudscapeRasterCompileCpu,
+        CloudTextureComputeCompileCpu,
+        Count
+    };
+
+    // Owned by VolumetricCloudsSystemComponent. Keeps a ring buffer with the latest samples
+    // of each StatsScope and answers the VolumetricCloudsStatsRequestBus.
+    // Samples can be added from any thread because the SRGs are compiled by the frame graph jobs.
+    class VolumetricCloudsStatsCollector final
+        : public VolumetricCloudsStatsRequestBus::Handler
+        , private AZ::TickBus::Handler
+    {
+    public:
+        AZ_RTTI(VolumetricCloudsStatsCollector, VolumetricCloudsStatsCollectorTypeId, VolumetricCloudsStatsRequests);
+        AZ_CLASS_ALLOCATOR(VolumetricCloudsStatsCollector, AZ::SystemAllocator);
+
+        VolumetricCloudsStatsCollector();
+        ~VolumetricCloudsStatsCollector();
+
+        // Returns null if the VolumetricCloudsSystemComponent is not active.
+        static VolumetricCloudsStatsCollector* Get();
+
+        // Cheap enough to be called before each measurement.
+        static bool IsCollecting();
+
+        void AddSample(StatsScope scope, float milliseconds);
+        // Reads the latest timestamp and pipeline statistics results of @pass.
+        // Does nothing if the queries have not been resolved yet.
+        void AddGpuPassSample(StatsScope scope, const AZ::RPI::Pass& pass);
+
+        // Called by CloudscapeFeatureProcessor when the ray marching debug totals are read back.
+        // Pass null when the debug view is disabled.
+        void SetRayMarchTotals(const VolumetricCloudsRayMarchTotals* totals);
+
+        //////////////////////////////////////////////////////////////////
+        //! VolumetricCloudsStatsRequestBus overrides START...
+        bool IsCollectingStats() const override;
+        void SetCollectingStats(bool enable) override;
+        AZStd::vector<AZStd::string> GetScopeNames() const override;
+        bool GetScopeStats(const AZStd::string& scopeName, VolumetricCloudsScopeStats& stats) const override;
+        void ResetStats() override;
+        bool GetRayMarchTotals(VolumetricCloudsRayMarchTotals& totals) const override;
+        bool StartCsvFrameLog(const AZStd::string& filePath) override;
+        void StopCsvFrameLog() override;
+        bool StartBenchmark(const AZStd::string& label, uint32_t frameCount, const AZStd::string& summaryFilePath) override;
+        bool IsBenchmarkRunning() const override;
+        //! VolumetricCloudsStatsRequestBus overrides END...
+        //////////////////////////////////////////////////////////////////
+
+        // Prints the stats of all the scopes that have samples.
+        void PrintStats() const;
+
+    private:
+        static constexpr char LogName[] = "VolumetricCloudsStats";
+        static constexpr uint32_t MaxSamplesPerScope = 256;
+        static constexpr uint32_t ScopeCount = static_cast<uint32_t>(StatsScope::Count);
+
+        static const char* GetScopeName(StatsScope scope);
+
+        //////////////////////////////////////////////////////////////////
+        //! AZ::TickBus::Handler overrides START...
+        // Writes one row to the CSV frame log, and counts down the benchmark frames.
+        void OnTick(float deltaTime, AZ::ScriptTimePoint time) override;
+        //! AZ::TickBus::Handler overrides END...
+        //////////////////////////////////////////////////////////////////
+
+        VolumetricCloudsScopeStats CalculateScopeStats(uint32_t scopeIndex) const;
+
+        void WriteCsvFrameRow();
+        // Appends the stats of the benchmark to its summary file.
+        void FinishBenchmark();
+        // Enables r_volumetricCloudsCollectStats while the CSV frame log or the benchmark are running,
+        // and then sets it back to its value before the first of them started.
+        void ForceCollectingStats();
+        void RestoreCollectingStats();
+        // The tick is shared by the CSV frame log and the benchmark.
+        void UpdateTickBusConnection();
+
+        struct ScopeSamples
+        {
+            AZStd::array<float, MaxSamplesPerScope> m_samplesMs;
+            uint32_t m_sampleCount = 0;
+            uint32_t m_nextSampleIndex = 0;
+            uint64_t m_computeShaderInvocations = 0;
+            uint64_t m_fragmentShaderInvocations = 0;
+            // The accumulated time since the last row of the CSV frame log.
+            float m_frameMs = 0.0f;
+            bool m_hasFrameSample = false;
+        };
+
+        mutable AZStd::mutex m_mutex;
+        AZStd::array<ScopeSamples, ScopeCount> m_scopes;
+
+        VolumetricCloudsRayMarchTotals m_rayMarchTotals;
+        bool m_hasRayMarchTotals = false;
+
+        AZ::IO::SystemFile m_csvFile;
+        uint64_t m_csvFrameIndex = 0;
+
+        AZStd::string m_benchmarkLabel;
+        AZStd::string m_benchmarkSummaryFilePath;
+        uint32_t m_benchmarkFrameCount = 0;
+        // 0 when no benchmark is running.
+        uint32_t m_benchmarkFramesLeft = 0;
+
+        bool m_isForcingCollectingStats = false;
+        bool m_wasCollectingStatsBeforeForcing = false;
+    };
+
+    // Adds the elapsed CPU time between construction and destruction to a StatsScope.
+    // Does nothing when the stats are not being collected.
+    class ScopedCpuStatsTimer final
+    {
+    public:
+        explicit ScopedCpuStatsTimer(StatsScope scope);
+        ~ScopedCpuStatsTimer();
+
+    private:
+        AZ_DISABLE_COPY_MOVE(ScopedCpuStatsTimer);
+
+        StatsScope m_scope;
+        VolumetricCloudsStatsCollector* m_collector = nullptr;
+        AZStd::chrono::steady_clock::time_point m_startTime;
+    };
+
+} // namespace VolumetricClouds
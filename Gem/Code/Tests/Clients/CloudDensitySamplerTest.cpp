@@ -0,0 +1,377 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+#include <AzCore/Math/MathUtils.h>
+#include <AzCore/std/algorithm.h>
+#include <AzCore/std/containers/array.h>
+#include <AzCore/std/containers/vector.h>
+
+#include <Renderer/CloudDensitySampler.h>
+#include <Renderer/CloudscapeShaderConstantData.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    // The noise textures have a single texel, so the densities only depend on the height in the cloud slab
+    // and on the weather map, and can be compared with a scalar version of SampleCloudDensity() in CloudscapeCS.azsl.
+    class CloudDensitySamplerTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        static constexpr uint8_t LowFrequencyTexel[4] = { 220, 128, 96, 64 };
+        static constexpr uint8_t HighFrequencyTexel[4] = { 0, 160, 128, 32 };
+        // Full low coverage, no high coverage, clouds up to the top of the slab and full density.
+        static constexpr uint8_t WeatherTexel[4] = { 255, 0, 255, 255 };
+
+        static AZStd::shared_ptr<const CloudCpuTexture> CreateTexture(const uint8_t texel[4])
+        {
+            auto texture = AZStd::make_shared<CloudCpuTexture>();
+            texture->m_texels.assign(texel, texel + 4);
+            texture->m_width = 1;
+            texture->m_height = 1;
+            texture->m_depth = 1;
+            texture->m_bytesPerRow = 4;
+            texture->m_bytesPerSlice = 4;
+            return texture;
+        }
+
+        static CloudDensitySampler CreateSampler(const CloudscapeShaderConstantData& shaderData)
+        {
+            return CloudDensitySampler(shaderData, CreateTexture(LowFrequencyTexel), CreateTexture(HighFrequencyTexel),
+                CreateTexture(WeatherTexel));
+        }
+
+        static float Remap(float value, float oldMin, float oldMax, float newMin, float newMax)
+        {
+            return (((value - oldMin) / (oldMax - oldMin)) * (newMax - newMin)) + newMin;
+        }
+
+        static float Saturate(float value)
+        {
+            return AZ::GetClamp(value, 0.0f, 1.0f);
+        }
+
+        static float GetFBM(const uint8_t texel[4])
+        {
+            return (texel[1] * 0.625f + texel[2] * 0.25f + texel[3] * 0.125f) / 255.0f;
+        }
+
+        // Scalar SampleCloudDensity(), for the noise textures above and the weather map texel @weather.
+        static float GetReferenceDensity(const CloudscapeShaderConstantData& shaderData, float heightFraction, bool useHighFrequencyNoise,
+            const float weather[4])
+        {
+            const float shapeNoise = Remap(LowFrequencyTexel[0] / 255.0f, GetFBM(LowFrequencyTexel) - 1.0f, 1.0f, 0.0f, 1.0f);
+            const float cloudMaxHeight = weather[2];
+            const float shapeAltering = Saturate(Remap(heightFraction, 0.0f, 0.07f, 0.0f, 1.0f)) *
+                Saturate(Remap(heightFraction, cloudMaxHeight * 0.2f, cloudMaxHeight, 1.0f, 0.0f));
+            const float densityAltering = shaderData.m_globalCloudDensity * 2.0f *
+                heightFraction * Saturate(Remap(heightFraction, 0.0f, 0.15f, 0.0f, 0.1f)) *
+                Saturate(Remap(heightFraction, 0.9f, 1.0f, 1.0f, 0.0f)) * weather[3];
+
+            const float coverage = shaderData.m_globalCloudCoverage;
+            const float weatherMapCoverage = AZStd::max(weather[0],
+                weather[1] * AZ::GetClamp(coverage - 0.5f, 0.0f, 1.0f) * 2.0f);
+            float density = Saturate(Remap(shapeNoise * shapeAltering, 1.0f - coverage * weatherMapCoverage, 1.0f, 0.0f, 1.0f));
+            if (useHighFrequencyNoise)
+            {
+                const float highFrequencyFBM = GetFBM(HighFrequencyTexel);
+                const float highFrequencyNoise = 0.35f * expf(-coverage * 0.75f) *
+                    AZ::Lerp(highFrequencyFBM, 1.0f - highFrequencyFBM, Saturate(heightFraction));
+                density = Saturate(Remap(density, highFrequencyNoise, 1.0f, 0.0f, 1.0f));
+            }
+            return density * densityAltering;
+        }
+
+        static float GetReferenceDensity(const CloudscapeShaderConstantData& shaderData, float heightFraction, bool useHighFrequencyNoise)
+        {
+            const float weather[4] = { WeatherTexel[0] / 255.0f, WeatherTexel[1] / 255.0f, WeatherTexel[2] / 255.0f, WeatherTexel[3] / 255.0f };
+            return GetReferenceDensity(shaderData, heightFraction, useHighFrequencyNoise, weather);
+        }
+
+        // A weather map that only changes along the X axis, one texel per entry of @texels.
+        using WeatherRow = AZStd::vector<AZStd::array<uint8_t, 4>>;
+
+        static AZStd::shared_ptr<const CloudCpuTexture> CreateWeatherRowTexture(const WeatherRow& texels)
+        {
+            auto texture = AZStd::make_shared<CloudCpuTexture>();
+            for (const auto& texel : texels)
+            {
+                texture->m_texels.insert(texture->m_texels.end(), texel.begin(), texel.end());
+            }
+            texture->m_width = aznumeric_cast<uint32_t>(texels.size());
+            texture->m_height = 1;
+            texture->m_depth = 1;
+            texture->m_bytesPerRow = texture->m_width * 4;
+            texture->m_bytesPerSlice = texture->m_bytesPerRow;
+            return texture;
+        }
+
+        // Scalar GetWeatherData(), a bilinear sample with wrapping of @texels. The default
+        // CloudscapeShaderConstantData::m_cloudTopOffsetKm is 0, so the position is not skewed by the wind.
+        static void GetReferenceWeather(const CloudscapeShaderConstantData& shaderData, const WeatherRow& texels, double positionXKm,
+            float weatherOut[4])
+        {
+            const double u = 1.0 + (positionXKm - shaderData.m_weatherMapSizeKm * 0.5) / shaderData.m_weatherMapSizeKm;
+            const double x = u * texels.size() - 0.5;
+            const double x0 = floor(x);
+            const float fraction = static_cast<float>(x - x0);
+            const int64_t width = static_cast<int64_t>(texels.size());
+            const size_t index0 = static_cast<size_t>(((static_cast<int64_t>(x0) % width) + width) % width);
+            const size_t index1 = (index0 + 1) % texels.size();
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                weatherOut[channel] = AZ::Lerp(texels[index0][channel] / 255.0f, texels[index1][channel] / 255.0f, fraction);
+            }
+        }
+
+        // Scalar fine-step reference of SampleTransmittance(): the midpoint rule with @stepCount steps over the
+        // whole segment, the density is 0 outside the cloud slab. @cloudCountOut is the number of separate
+        // stretches of the segment with clouds.
+        static double GetReferenceOpticalDepth(const CloudscapeShaderConstantData& shaderData, const WeatherRow& texels,
+            const AZ::Vector3& start, const AZ::Vector3& end, uint32_t stepCount, uint32_t& cloudCountOut)
+        {
+            const double extinctionPerKm = (shaderData.m_cloudMaterialProperties.m_absorptionCoefficient +
+                shaderData.m_cloudMaterialProperties.m_scatteringCoefficient) * 1000.0;
+            const double stepKm = (end - start).GetLength() * 0.001 / stepCount;
+            const double innerSphereRadiusKm = shaderData.m_planetRadiusKm + shaderData.m_cloudSlabDistanceAboveSeaLevelKm;
+            double opticalDepth = 0.0;
+            bool wasInCloud = false;
+            cloudCountOut = 0;
+            for (uint32_t stepIndex = 0; stepIndex < stepCount; ++stepIndex)
+            {
+                const double t = (stepIndex + 0.5) / stepCount;
+                const double xKm = (start.GetX() + (end.GetX() - start.GetX()) * t) * 0.001;
+                const double yKm = (start.GetY() + (end.GetY() - start.GetY()) * t) * 0.001;
+                const double zKm = (start.GetZ() + (end.GetZ() - start.GetZ()) * t) * 0.001 + shaderData.m_planetRadiusKm;
+                const double distanceToCenterKm = sqrt(xKm * xKm + yKm * yKm + zKm * zKm);
+                const float heightFraction = static_cast<float>((distanceToCenterKm - innerSphereRadiusKm) / shaderData.m_cloudSlabThicknessKm);
+                float weather[4];
+                GetReferenceWeather(shaderData, texels, xKm, weather);
+                const float density = GetReferenceDensity(shaderData, heightFraction, true, weather);
+                opticalDepth += density * extinctionPerKm * stepKm;
+                const bool isInCloud = density > 0.0f;
+                cloudCountOut += (isInCloud && !wasInCloud) ? 1 : 0;
+                wasInCloud = isInCloud;
+            }
+            return opticalDepth;
+        }
+
+        // Same math as CloudDensitySampler::GetHeightFraction(), for a point right above the planet center.
+        static float GetHeightFraction(const CloudscapeShaderConstantData& shaderData, float altitudeMeters)
+        {
+            const float distanceToCenterKm = altitudeMeters * 0.001f + shaderData.m_planetRadiusKm;
+            const float innerSphereRadiusKm = shaderData.m_planetRadiusKm + shaderData.m_cloudSlabDistanceAboveSeaLevelKm;
+            const float outerSphereRadiusKm = innerSphereRadiusKm + shaderData.m_cloudSlabThicknessKm;
+            return (distanceToCenterKm - innerSphereRadiusKm) / (outerSphereRadiusKm - innerSphereRadiusKm);
+        }
+
+        // The positions are relative to the planet center in single precision, so the height fraction is off by ~1e-4.
+        static constexpr float DensityTolerance = 1.0e-3f;
+    };
+
+    TEST_F(CloudDensitySamplerTest, IsReady_MissingTexture_ReturnsZeroDensity)
+    {
+        CloudscapeShaderConstantData shaderData;
+        const CloudDensitySampler sampler(shaderData, CreateTexture(LowFrequencyTexel), nullptr, CreateTexture(WeatherTexel));
+        EXPECT_FALSE(sampler.IsReady());
+
+        const AZ::Vector3 position(0.0f, 0.0f, 3000.0f);
+        float density = 1.0f;
+        sampler.SampleDensity({ &position, 1 }, { &density, 1 }, AZ::Vector3::CreateZero());
+        EXPECT_FLOAT_EQ(density, 0.0f);
+    }
+
+    TEST_F(CloudDensitySamplerTest, CanBeCreatedFromImage_NotAStreamingImage_ReturnsFalse)
+    {
+        // Same as the noise textures generated on the GPU, which are attachment images.
+        EXPECT_FALSE(CloudCpuTexture::CanBeCreatedFromImage(nullptr));
+        EXPECT_EQ(CloudCpuTexture::CreateFromImage(nullptr), nullptr);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleDensity_MatchesScalarReference)
+    {
+        CloudscapeShaderConstantData shaderData;
+        const CloudDensitySampler sampler = CreateSampler(shaderData);
+        ASSERT_TRUE(sampler.IsReady());
+
+        // Below, inside and above the slab. 7 points, so the last group of 4 is padded.
+        const float slabBottomMeters = shaderData.m_cloudSlabDistanceAboveSeaLevelKm * 1000.0f;
+        const float slabThicknessMeters = shaderData.m_cloudSlabThicknessKm * 1000.0f;
+        const float slabFractions[] = { -0.1f, 0.05f, 0.3f, 0.5f, 0.8f, 0.95f, 1.1f };
+        AZStd::vector<AZ::Vector3> positions;
+        for (float slabFraction : slabFractions)
+        {
+            positions.push_back(AZ::Vector3(0.0f, 0.0f, slabBottomMeters + slabFraction * slabThicknessMeters));
+        }
+        AZStd::vector<float> densities(positions.size(), -1.0f);
+        sampler.SampleDensity(positions, densities, AZ::Vector3::CreateZero());
+
+        bool hasClouds = false;
+        for (size_t pointIndex = 0; pointIndex < positions.size(); ++pointIndex)
+        {
+            const float heightFraction = GetHeightFraction(shaderData, positions[pointIndex].GetZ());
+            const float expectedDensity = GetReferenceDensity(shaderData, heightFraction, true);
+            EXPECT_NEAR(densities[pointIndex], expectedDensity, DensityTolerance) << "Point " << pointIndex;
+            hasClouds = hasClouds || (expectedDensity > 0.0f);
+        }
+        EXPECT_TRUE(hasClouds);
+        EXPECT_FLOAT_EQ(densities.front(), 0.0f);
+        EXPECT_FLOAT_EQ(densities.back(), 0.0f);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleDensity_ScalesWithGlobalDensity)
+    {
+        CloudscapeShaderConstantData shaderData;
+        const AZ::Vector3 position(0.0f, 0.0f, (shaderData.m_cloudSlabDistanceAboveSeaLevelKm + shaderData.m_cloudSlabThicknessKm * 0.5f) * 1000.0f);
+        float density = 0.0f;
+        CreateSampler(shaderData).SampleDensity({ &position, 1 }, { &density, 1 }, AZ::Vector3::CreateZero());
+
+        shaderData.m_globalCloudDensity *= 0.5f;
+        float halfDensity = 0.0f;
+        CreateSampler(shaderData).SampleDensity({ &position, 1 }, { &halfDensity, 1 }, AZ::Vector3::CreateZero());
+        EXPECT_GT(density, 0.0f);
+        EXPECT_NEAR(halfDensity, density * 0.5f, 1.0e-6f);
+    }
+
+    TEST_F(CloudDensitySamplerTest, AreInputsEqual_IgnoresTheSun)
+    {
+        CloudscapeShaderConstantData shaderData;
+        CloudscapeShaderConstantData otherShaderData = shaderData;
+        otherShaderData.m_sunLightIntensity *= 2.0f;
+        otherShaderData.m_directionTowardsTheSun = AZ::Vector3::CreateAxisX();
+        EXPECT_TRUE(CloudDensitySampler::AreInputsEqual(shaderData, otherShaderData));
+        otherShaderData.m_globalCloudCoverage *= 0.5f;
+        EXPECT_FALSE(CloudDensitySampler::AreInputsEqual(shaderData, otherShaderData));
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleDensityKm_HighFrequencyNoiseLaneMask_OnlyErodesMaskedLanes)
+    {
+        CloudscapeShaderConstantData shaderData;
+        const CloudDensitySampler sampler = CreateSampler(shaderData);
+        const float altitudeMeters = (shaderData.m_cloudSlabDistanceAboveSeaLevelKm + shaderData.m_cloudSlabThicknessKm * 0.5f) * 1000.0f;
+        const auto posZ = AZ::Simd::Vec4::Splat(altitudeMeters * 0.001f + shaderData.m_planetRadiusKm);
+        alignas(16) float densities[4];
+        AZ::Simd::Vec4::StoreAligned(densities, sampler.SampleDensityKm(AZ::Simd::Vec4::ZeroFloat(), AZ::Simd::Vec4::ZeroFloat(), posZ,
+            AZ::Vector3::CreateZero(), 0x5));
+
+        const float heightFraction = GetHeightFraction(shaderData, altitudeMeters);
+        const float erodedDensity = GetReferenceDensity(shaderData, heightFraction, true);
+        const float densityWithoutErosion = GetReferenceDensity(shaderData, heightFraction, false);
+        ASSERT_LT(erodedDensity, densityWithoutErosion);
+        EXPECT_NEAR(densities[0], erodedDensity, DensityTolerance);
+        EXPECT_NEAR(densities[1], densityWithoutErosion, DensityTolerance);
+        EXPECT_NEAR(densities[2], erodedDensity, DensityTolerance);
+        EXPECT_NEAR(densities[3], densityWithoutErosion, DensityTolerance);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleTransmittance_OutsideTheSlab_IsClear)
+    {
+        CloudscapeShaderConstantData shaderData;
+        const CloudDensitySampler sampler = CreateSampler(shaderData);
+        const AZ::Vector3 start(0.0f, 0.0f, 0.0f);
+        const AZ::Vector3 end(1000.0f, 0.0f, 100.0f);
+        CloudTransmittanceResult result;
+        result.m_opticalDepth = -1.0f;
+        sampler.SampleTransmittance({ &start, 1 }, { &end, 1 }, { &result, 1 }, AZ::Vector3::CreateZero());
+        EXPECT_FLOAT_EQ(result.m_opticalDepth, 0.0f);
+        EXPECT_FLOAT_EQ(result.m_transmittance, 1.0f);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleTransmittance_VerticalSegment_MatchesIntegratedReference)
+    {
+        CloudscapeShaderConstantData shaderData;
+        // Thin clouds, so the march doesn't stop early at a large optical depth.
+        shaderData.m_cloudMaterialProperties.m_absorptionCoefficient = 0.0001f;
+        shaderData.m_cloudMaterialProperties.m_scatteringCoefficient = 0.0003f;
+        const float extinctionPerKm = (shaderData.m_cloudMaterialProperties.m_absorptionCoefficient +
+            shaderData.m_cloudMaterialProperties.m_scatteringCoefficient) * 1000.0f;
+        const CloudDensitySampler sampler = CreateSampler(shaderData);
+
+        // The march samples the clouds it finds with the high frequency noise.
+        constexpr uint32_t ReferenceStepCount = 10000;
+        const float stepKm = shaderData.m_cloudSlabThicknessKm / ReferenceStepCount;
+        double expectedOpticalDepth = 0.0;
+        for (uint32_t stepIndex = 0; stepIndex < ReferenceStepCount; ++stepIndex)
+        {
+            const float heightFraction = (stepIndex + 0.5f) / ReferenceStepCount;
+            expectedOpticalDepth += GetReferenceDensity(shaderData, heightFraction, true) * extinctionPerKm * stepKm;
+        }
+        ASSERT_GT(expectedOpticalDepth, 0.01);
+
+        // From the ground to well above the clouds. 3 segments, so the group of 4 has an idle lane.
+        const AZ::Vector3 starts[3] = { AZ::Vector3(0.0f, 0.0f, 0.0f), AZ::Vector3(0.0f, 0.0f, 10000.0f), AZ::Vector3(0.0f, 0.0f, 0.0f) };
+        const AZ::Vector3 ends[3] = { AZ::Vector3(0.0f, 0.0f, 10000.0f), AZ::Vector3(0.0f, 0.0f, 0.0f), AZ::Vector3(0.0f, 0.0f, 500.0f) };
+        CloudTransmittanceResult results[3];
+        sampler.SampleTransmittance(starts, ends, results, AZ::Vector3::CreateZero());
+
+        // The march takes ~32 steps through the slab.
+        const float tolerance = static_cast<float>(expectedOpticalDepth) * 0.05f;
+        EXPECT_NEAR(results[0].m_opticalDepth, expectedOpticalDepth, tolerance);
+        EXPECT_NEAR(results[0].m_transmittance, expf(-results[0].m_opticalDepth), 1.0e-6f);
+        EXPECT_NEAR(results[1].m_opticalDepth, expectedOpticalDepth, tolerance);
+        EXPECT_FLOAT_EQ(results[2].m_opticalDepth, 0.0f);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleTransmittance_SparseWeatherMap_MatchesFineStepReference)
+    {
+        CloudscapeShaderConstantData shaderData;
+        shaderData.m_cloudMaterialProperties.m_absorptionCoefficient = 0.001f;
+        shaderData.m_cloudMaterialProperties.m_scatteringCoefficient = 0.003f;
+        // Two clouds, a few km wide, in 60 km of low coverage. The march probes the empty space with large steps,
+        // marches each cloud with small steps, and goes back to large steps after 6 empty small steps.
+        constexpr AZStd::array<uint8_t, 4> ClearTexel = { 16, 0, 255, 255 };
+        constexpr AZStd::array<uint8_t, 4> CloudTexel = { 255, 0, 255, 255 };
+        WeatherRow weatherTexels(16, ClearTexel);
+        weatherTexels[4] = CloudTexel;
+        weatherTexels[11] = CloudTexel;
+        const CloudDensitySampler sampler(shaderData, CreateTexture(LowFrequencyTexel), CreateTexture(HighFrequencyTexel),
+            CreateWeatherRowTexture(weatherTexels));
+
+        // Horizontal, through the middle of the slab, across the whole weather map. Both directions.
+        const float altitudeMeters = (shaderData.m_cloudSlabDistanceAboveSeaLevelKm + shaderData.m_cloudSlabThicknessKm * 0.5f) * 1000.0f;
+        const AZ::Vector3 starts[2] = { AZ::Vector3(0.0f, 0.0f, altitudeMeters), AZ::Vector3(60000.0f, 0.0f, altitudeMeters) };
+        const AZ::Vector3 ends[2] = { AZ::Vector3(60000.0f, 0.0f, altitudeMeters), AZ::Vector3(0.0f, 0.0f, altitudeMeters) };
+
+        uint32_t cloudCount = 0;
+        const double expectedOpticalDepth = GetReferenceOpticalDepth(shaderData, weatherTexels, starts[0], ends[0], 20000, cloudCount);
+        ASSERT_EQ(cloudCount, 2u);
+        ASSERT_GT(expectedOpticalDepth, 0.1);
+
+        CloudTransmittanceResult results[2];
+        sampler.SampleTransmittance(starts, ends, results, AZ::Vector3::CreateZero());
+        const float tolerance = static_cast<float>(expectedOpticalDepth) * 0.02f;
+        EXPECT_NEAR(results[0].m_opticalDepth, expectedOpticalDepth, tolerance);
+        EXPECT_NEAR(results[1].m_opticalDepth, expectedOpticalDepth, tolerance);
+    }
+
+    TEST_F(CloudDensitySamplerTest, SampleTransmittance_SegmentCrossesTheSlabTwice_MatchesFineStepReference)
+    {
+        CloudscapeShaderConstantData shaderData;
+        // Very thin clouds, the segment is hundreds of km long.
+        shaderData.m_cloudMaterialProperties.m_absorptionCoefficient = 0.000001f;
+        shaderData.m_cloudMaterialProperties.m_scatteringCoefficient = 0.000003f;
+        const CloudDensitySampler sampler = CreateSampler(shaderData);
+
+        // Horizontal at 1 km, below the slab, over the planet center. Both ends are inside the slab, because the ground
+        // curves away, and the middle of the segment is inside the inner sphere, so the slab is clipped to two intervals.
+        const AZ::Vector3 start(-200000.0f, 0.0f, 1000.0f);
+        const AZ::Vector3 end(200000.0f, 0.0f, 1000.0f);
+        const WeatherRow weatherTexels = { { WeatherTexel[0], WeatherTexel[1], WeatherTexel[2], WeatherTexel[3] } };
+        uint32_t cloudCount = 0;
+        const double expectedOpticalDepth = GetReferenceOpticalDepth(shaderData, weatherTexels, start, end, 40000, cloudCount);
+        ASSERT_EQ(cloudCount, 2u);
+        ASSERT_GT(expectedOpticalDepth, 0.01);
+
+        CloudTransmittanceResult result;
+        sampler.SampleTransmittance({ &start, 1 }, { &end, 1 }, { &result, 1 }, AZ::Vector3::CreateZero());
+        EXPECT_NEAR(result.m_opticalDepth, expectedOpticalDepth, expectedOpticalDepth * 0.02);
+    }
+
+} // namespace UnitTest
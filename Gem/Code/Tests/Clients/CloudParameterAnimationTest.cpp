@@ -0,0 +1,101 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+
+#include <Renderer/CloudParameterAnimation.h>
+#include <Renderer/CloudscapeShaderConstantData.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class CloudParameterAnimationTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        // Goes from 0 to 1 in the first half, and back to 0 in the second half.
+        static CloudParameterTrack CreateTriangleTrack(bool loop)
+        {
+            CloudParameterTrack track;
+            track.m_keyframes = { AZ::Vector2(0.0f, 0.0f), AZ::Vector2(0.5f, 1.0f), AZ::Vector2(1.0f, 0.0f) };
+            track.m_durationSeconds = 10.0f;
+            track.m_loop = loop;
+            return track;
+        }
+    };
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_NoKeyframes_ReturnsZero)
+    {
+        CloudParameterTrack track;
+        EXPECT_FLOAT_EQ(track.Evaluate(1.0f), 0.0f);
+    }
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_BetweenKeyframes_Interpolates)
+    {
+        const CloudParameterTrack track = CreateTriangleTrack(false);
+        EXPECT_FLOAT_EQ(track.Evaluate(0.0f), 0.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(2.5f), 0.5f);
+        EXPECT_FLOAT_EQ(track.Evaluate(5.0f), 1.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(7.5f), 0.5f);
+    }
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_BeforeFirstKeyframe_HoldsFirstValue)
+    {
+        CloudParameterTrack track = CreateTriangleTrack(false);
+        track.m_keyframes.front() = AZ::Vector2(0.2f, 3.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(0.0f), 3.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(1.0f), 3.0f);
+    }
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_ClampedPastTheEnd_HoldsLastValue)
+    {
+        CloudParameterTrack track = CreateTriangleTrack(false);
+        track.m_keyframes.back() = AZ::Vector2(1.0f, 2.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(10.0f), 2.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(25.0f), 2.0f);
+        EXPECT_FALSE(track.IsFinished(9.9f));
+        EXPECT_TRUE(track.IsFinished(10.0f));
+    }
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_Looped_WrapsAround)
+    {
+        const CloudParameterTrack track = CreateTriangleTrack(true);
+        EXPECT_FLOAT_EQ(track.Evaluate(12.5f), 0.5f);
+        EXPECT_FLOAT_EQ(track.Evaluate(15.0f), 1.0f);
+        // Exactly at the end of a cycle the curve starts over.
+        EXPECT_FLOAT_EQ(track.Evaluate(20.0f), 0.0f);
+        EXPECT_FALSE(track.IsFinished(100.0f));
+    }
+
+    TEST_F(CloudParameterAnimationTest, Evaluate_ZeroDuration_ReturnsLastValue)
+    {
+        CloudParameterTrack track = CreateTriangleTrack(false);
+        track.m_durationSeconds = 0.0f;
+        track.m_keyframes.back() = AZ::Vector2(1.0f, 4.0f);
+        EXPECT_FLOAT_EQ(track.Evaluate(0.0f), 4.0f);
+    }
+
+    TEST_F(CloudParameterAnimationTest, Update_FlatCurve_DoesNotModifyShaderData)
+    {
+        CloudParameterTrack track;
+        track.m_parameter = AnimatedCloudParameter::CloudCoverage;
+        track.m_keyframes = { AZ::Vector2(0.0f, 0.5f), AZ::Vector2(1.0f, 0.5f) };
+        track.m_loop = true;
+        track.m_id = 1;
+
+        CloudParameterAnimator animator;
+        animator.SetTracks({ track });
+        CloudscapeShaderConstantData shaderData;
+        shaderData.m_globalCloudCoverage = 0.0f;
+        EXPECT_TRUE(animator.Update(0.1f, true /*reapplyAll*/, shaderData));
+        EXPECT_FLOAT_EQ(shaderData.m_globalCloudCoverage, 0.5f);
+        EXPECT_FALSE(animator.Update(0.1f, false /*reapplyAll*/, shaderData));
+    }
+
+} // namespace UnitTest
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+#include <AzCore/Math/MathUtils.h>
+
+#include <Renderer/CloudMaterialProperties.h>
+#include <Renderer/CloudPhaseFunctionLut.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class CloudPhaseFunctionLutTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        static CloudMaterialProperties CreateMaterialProperties(float henyeyGreensteinG)
+        {
+            CloudMaterialProperties materialProperties;
+            materialProperties.m_henyeyGreensteinG = henyeyGreensteinG;
+            return materialProperties;
+        }
+    };
+
+    TEST_F(CloudPhaseFunctionLutTest, GetTexelAngle_CoversForwardToBackward)
+    {
+        EXPECT_FLOAT_EQ(CloudPhaseFunctionLut::GetTexelAngle(0), 0.0f);
+        EXPECT_FLOAT_EQ(CloudPhaseFunctionLut::GetTexelAngle(CloudPhaseFunctionLut::Width - 1), AZ::Constants::Pi);
+        for (uint32_t texelIndex = 1; texelIndex < CloudPhaseFunctionLut::Width; ++texelIndex)
+        {
+            EXPECT_GT(CloudPhaseFunctionLut::GetTexelAngle(texelIndex), CloudPhaseFunctionLut::GetTexelAngle(texelIndex - 1));
+        }
+    }
+
+    TEST_F(CloudPhaseFunctionLutTest, GenerateTexels_Isotropic_IsScatteringCoefficientOver4Pi)
+    {
+        const CloudMaterialProperties materialProperties = CreateMaterialProperties(0.0f);
+        AZStd::vector<float> texels;
+        CloudPhaseFunctionLut::GenerateTexels(materialProperties, texels);
+        ASSERT_EQ(texels.size(), CloudPhaseFunctionLut::Width * 4);
+
+        const float scatteringCoefficientKm = materialProperties.m_scatteringCoefficient * 1000.0f;
+        for (uint32_t texelIndex = 0; texelIndex < CloudPhaseFunctionLut::Width; ++texelIndex)
+        {
+            const float* texel = &texels[texelIndex * 4];
+            float powB = 1.0f;
+            for (uint32_t octave = 0; octave < CloudPhaseFunctionLut::OctaveCount; ++octave)
+            {
+                const float expected = scatteringCoefficientKm * powB / (4.0f * AZ::Constants::Pi);
+                EXPECT_NEAR(texel[octave], expected, expected * 1.0e-4f) << "Texel " << texelIndex << ", octave " << octave;
+                powB *= materialProperties.m_multiScatteringB;
+            }
+            EXPECT_EQ(texel[3], 0.0f);
+        }
+    }
+
+    TEST_F(CloudPhaseFunctionLutTest, GenerateTexels_ExtremeExcentricity_IsFinite)
+    {
+        for (float henyeyGreensteinG : { -1.0f, 1.0f })
+        {
+            AZStd::vector<float> texels;
+            CloudPhaseFunctionLut::GenerateTexels(CreateMaterialProperties(henyeyGreensteinG), texels);
+            ASSERT_EQ(texels.size(), CloudPhaseFunctionLut::Width * 4);
+            for (float value : texels)
+            {
+                EXPECT_TRUE(AZ::IsFiniteFloat(value)) << "g = " << henyeyGreensteinG;
+                EXPECT_GE(value, 0.0f) << "g = " << henyeyGreensteinG;
+            }
+        }
+    }
+
+    TEST_F(CloudPhaseFunctionLutTest, GenerateTexels_NarrowForwardLobe_IsResolved)
+    {
+        AZStd::vector<float> texels;
+        CloudPhaseFunctionLut::GenerateTexels(CreateMaterialProperties(0.98f), texels);
+
+        // With evenly spaced angles the second texel would already be ~40% below the peak.
+        EXPECT_GT(texels[4], texels[0] * 0.99f);
+        for (uint32_t texelIndex = 1; texelIndex < 16; ++texelIndex)
+        {
+            EXPECT_LE(texels[texelIndex * 4], texels[(texelIndex - 1) * 4]) << "Texel " << texelIndex;
+        }
+        EXPECT_LT(texels[15 * 4], texels[0]);
+    }
+
+} // namespace UnitTest
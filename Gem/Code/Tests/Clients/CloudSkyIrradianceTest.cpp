@@ -0,0 +1,90 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+#include <AzCore/Math/MathUtils.h>
+
+#include <Renderer/CloudSkyIrradiance.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class CloudSkyIrradianceTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        static CloudSkyIrradiance Calculate(float sunElevationDegrees)
+        {
+            const float sunElevation = AZ::DegToRad(sunElevationDegrees);
+            const AZ::Vector3 directionTowardsTheSun(cosf(sunElevation), 0.0f, sinf(sunElevation));
+            return CloudSkyIrradiance::Calculate(directionTowardsTheSun, PlanetRadiusKm, CloudSlabTopKm);
+        }
+
+        static void ExpectInRange(const AZ::Vector3& value, float minValue, float maxValue)
+        {
+            for (int component = 0; component < 3; ++component)
+            {
+                EXPECT_TRUE(AZ::IsFiniteFloat(value.GetElement(component))) << "Component " << component;
+                EXPECT_GT(value.GetElement(component), minValue) << "Component " << component;
+                EXPECT_LT(value.GetElement(component), maxValue) << "Component " << component;
+            }
+        }
+
+        // Defaults of CloudscapeShaderConstantData.
+        static constexpr float PlanetRadiusKm = 6371.0f;
+        static constexpr float CloudSlabTopKm = 1.5f + 3.5f;
+    };
+
+    TEST_F(CloudSkyIrradianceTest, Calculate_SunAtZenith_IsBlueSkyBelowTheSun)
+    {
+        const CloudSkyIrradiance irradiance = Calculate(90.0f);
+        // Relative to the sun illuminance, the sky is a small fraction of it.
+        ExpectInRange(irradiance.m_skyIrradiance, 0.0f, 1.0f);
+        EXPECT_GT(irradiance.m_skyIrradiance.GetZ(), irradiance.m_skyIrradiance.GetX());
+
+        // The ground reflects at most the albedo times the sun and the sky that reach it.
+        ExpectInRange(irradiance.m_groundIrradiance, 0.0f, CloudSkyIrradiance::GroundAlbedo * 1.5f);
+    }
+
+    TEST_F(CloudSkyIrradianceTest, Calculate_LowerSun_IsDarker)
+    {
+        // The direct sun dominates the ground irradiance, so it follows the cosine of the sun zenith angle.
+        const float elevations[] = { 90.0f, 45.0f, 15.0f, 2.0f };
+        AZ::Vector3 previousGround = AZ::Vector3(1.0f);
+        for (float elevation : elevations)
+        {
+            const CloudSkyIrradiance irradiance = Calculate(elevation);
+            EXPECT_LT(irradiance.m_groundIrradiance.GetY(), previousGround.GetY()) << "Elevation " << elevation;
+            previousGround = irradiance.m_groundIrradiance;
+        }
+
+        // Close to the horizon most of the sun light is scattered away before reaching the sky above the clouds.
+        EXPECT_LT(Calculate(2.0f).m_skyIrradiance.GetY(), Calculate(90.0f).m_skyIrradiance.GetY());
+    }
+
+    TEST_F(CloudSkyIrradianceTest, Calculate_SunBelowTheHorizon_IsDark)
+    {
+        // Far enough below the horizon that no point of the atmosphere above the clouds sees the sun.
+        const CloudSkyIrradiance irradiance = Calculate(-30.0f);
+        EXPECT_TRUE(irradiance.m_skyIrradiance.IsClose(AZ::Vector3::CreateZero(), 1.0e-6f));
+        EXPECT_TRUE(irradiance.m_groundIrradiance.IsClose(AZ::Vector3::CreateZero(), 1.0e-6f));
+    }
+
+    TEST_F(CloudSkyIrradianceTest, Calculate_OnlyDependsOnTheSunElevation)
+    {
+        const CloudSkyIrradiance reference = Calculate(30.0f);
+        // Same elevation, another azimuth and a direction that is not normalized.
+        const float sunElevation = AZ::DegToRad(30.0f);
+        const AZ::Vector3 directionTowardsTheSun(0.0f, -2.0f * cosf(sunElevation), 2.0f * sinf(sunElevation));
+        const CloudSkyIrradiance irradiance = CloudSkyIrradiance::Calculate(directionTowardsTheSun, PlanetRadiusKm, CloudSlabTopKm);
+        EXPECT_TRUE(irradiance.m_skyIrradiance.IsClose(reference.m_skyIrradiance, 1.0e-5f));
+        EXPECT_TRUE(irradiance.m_groundIrradiance.IsClose(reference.m_groundIrradiance, 1.0e-5f));
+    }
+
+} // namespace UnitTest
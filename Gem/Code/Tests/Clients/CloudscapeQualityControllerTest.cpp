@@ -0,0 +1,131 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+
+#include <Renderer/CloudscapeQualityController.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class CloudscapeQualityControllerTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        static constexpr float BudgetMs = 1.0f;
+        static constexpr float OverBudgetMs = 1.5f;
+        static constexpr float UnderBudgetMs = 0.1f;
+        static constexpr uint32_t MaxFrames = 10000;
+
+        // Returns the number of frames until the quality level changes, or MaxFrames if it doesn't.
+        static uint32_t RunUntilQualityChanges(CloudscapeQualityController& controller, float gpuTimeMs)
+        {
+            for (uint32_t frame = 1; frame < MaxFrames; ++frame)
+            {
+                if (controller.Update(gpuTimeMs, BudgetMs))
+                {
+                    return frame;
+                }
+            }
+            return MaxFrames;
+        }
+    };
+
+    TEST_F(CloudscapeQualityControllerTest, Update_InvalidTime_IsIgnored)
+    {
+        CloudscapeQualityController controller;
+        EXPECT_FALSE(controller.Update(0.0f, BudgetMs));
+        EXPECT_FALSE(controller.Update(OverBudgetMs, 0.0f));
+        EXPECT_FLOAT_EQ(controller.GetSmoothedGpuTimeMs(), 0.0f);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_WithinBudget_KeepsHighestQuality)
+    {
+        CloudscapeQualityController controller;
+        EXPECT_EQ(RunUntilQualityChanges(controller, UnderBudgetMs), MaxFrames);
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 0u);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_OverBudget_DecreasesQualityAfterFewFrames)
+    {
+        CloudscapeQualityController controller;
+        EXPECT_EQ(RunUntilQualityChanges(controller, OverBudgetMs), 8u);
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 1u);
+        EXPECT_LT(controller.GetQualityLevel().m_rayMarchingStepsScale, 1.0f);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_GpuTimeDropsAfterTheFirstDecrease_LosesOnlyOneLevel)
+    {
+        CloudscapeQualityController controller;
+        // Three times the budget, then the lower level brings the GPU time under it. A smoothed time that still
+        // remembers the first level would stay over budget long enough to drop another level.
+        RunUntilQualityChanges(controller, BudgetMs * 3.0f);
+        ASSERT_EQ(controller.GetQualityLevelIndex(), 1u);
+        for (uint32_t frame = 0; frame < 30; ++frame)
+        {
+            EXPECT_FALSE(controller.Update(BudgetMs * 0.8f, BudgetMs));
+        }
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 1u);
+        EXPECT_FLOAT_EQ(controller.GetSmoothedGpuTimeMs(), BudgetMs * 0.8f);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_AlwaysOverBudget_StopsAtLowestQuality)
+    {
+        CloudscapeQualityController controller;
+        uint32_t decreaseCount = 0;
+        while (RunUntilQualityChanges(controller, OverBudgetMs) != MaxFrames)
+        {
+            ++decreaseCount;
+        }
+        EXPECT_EQ(decreaseCount, controller.GetQualityLevelIndex());
+        EXPECT_GT(decreaseCount, 0u);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_BetweenHeadroomAndBudget_KeepsLevel)
+    {
+        CloudscapeQualityController controller;
+        // Barely over budget, so the smoothed time doesn't stay over budget for long after the GPU time drops.
+        RunUntilQualityChanges(controller, BudgetMs * 1.05f);
+        ASSERT_EQ(controller.GetQualityLevelIndex(), 1u);
+        // Above 75% of the budget there is not enough headroom to increase the quality.
+        EXPECT_EQ(RunUntilQualityChanges(controller, BudgetMs * 0.9f), MaxFrames);
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 1u);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Update_RevertedIncrease_DoublesTheWait)
+    {
+        CloudscapeQualityController controller;
+        RunUntilQualityChanges(controller, OverBudgetMs);
+        ASSERT_EQ(controller.GetQualityLevelIndex(), 1u);
+
+        // Increasing the quality is much slower than decreasing it.
+        const uint32_t firstIncreaseFrames = RunUntilQualityChanges(controller, UnderBudgetMs);
+        EXPECT_GE(firstIncreaseFrames, 60u);
+        EXPECT_LT(firstIncreaseFrames, 120u);
+        ASSERT_EQ(controller.GetQualityLevelIndex(), 0u);
+
+        // The increase didn't fit in the budget.
+        EXPECT_LT(RunUntilQualityChanges(controller, OverBudgetMs), 60u);
+        ASSERT_EQ(controller.GetQualityLevelIndex(), 1u);
+
+        const uint32_t secondIncreaseFrames = RunUntilQualityChanges(controller, UnderBudgetMs);
+        EXPECT_GE(secondIncreaseFrames, 120u);
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 0u);
+    }
+
+    TEST_F(CloudscapeQualityControllerTest, Reset_GoesBackToHighestQuality)
+    {
+        CloudscapeQualityController controller;
+        RunUntilQualityChanges(controller, OverBudgetMs);
+        controller.Reset();
+        EXPECT_EQ(controller.GetQualityLevelIndex(), 0u);
+        EXPECT_FLOAT_EQ(controller.GetSmoothedGpuTimeMs(), 0.0f);
+    }
+
+} // namespace UnitTest
@@ -0,0 +1,146 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzCore/UnitTest/TestTypes.h>
+#include <AzCore/std/containers/array.h>
+#include <AzCore/std/containers/vector.h>
+#include <AzCore/std/parallel/atomic.h>
+#include <AzCore/std/parallel/thread.h>
+
+#include <Renderer/TripleBuffer.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class TripleBufferTest
+        : public LeakDetectionFixture
+    {
+    };
+
+    TEST_F(TripleBufferTest, Publish_NothingStaged_ReturnsFalse)
+    {
+        TripleBuffer<int> buffer;
+        EXPECT_FALSE(buffer.Publish());
+    }
+
+    TEST_F(TripleBufferTest, Publish_AfterStage_ReturnsTheStagedValueOnce)
+    {
+        TripleBuffer<int> buffer;
+        buffer.Stage(7);
+        EXPECT_TRUE(buffer.Publish());
+        EXPECT_EQ(buffer.GetPublished(), 7);
+        EXPECT_FALSE(buffer.Publish());
+        EXPECT_EQ(buffer.GetPublished(), 7);
+    }
+
+    TEST_F(TripleBufferTest, Publish_SeveralStages_ReturnsTheLatest)
+    {
+        TripleBuffer<int> buffer;
+        for (int value = 1; value <= 10; ++value)
+        {
+            buffer.Stage(value);
+        }
+        EXPECT_TRUE(buffer.Publish());
+        EXPECT_EQ(buffer.GetPublished(), 10);
+    }
+
+    TEST_F(TripleBufferTest, Stage_DoesNotTouchThePublishedSlot)
+    {
+        TripleBuffer<int> buffer;
+        buffer.Stage(1);
+        buffer.Publish();
+        const int* published = &buffer.GetPublished();
+        for (int value = 2; value <= 10; ++value)
+        {
+            buffer.Stage(value);
+            EXPECT_EQ(*published, 1);
+        }
+        EXPECT_TRUE(buffer.Publish());
+        EXPECT_EQ(buffer.GetPublished(), 10);
+    }
+
+    TEST_F(TripleBufferTest, StageAndPublish_FromTwoThreads_NeverGoesBack)
+    {
+        constexpr int LastValue = 100000;
+        TripleBuffer<int> buffer;
+        AZStd::thread producer([&buffer]()
+            {
+                for (int value = 1; value <= LastValue; ++value)
+                {
+                    buffer.Stage(value);
+                }
+            });
+
+        int lastPublished = 0;
+        while (lastPublished < LastValue)
+        {
+            if (buffer.Publish())
+            {
+                const int published = buffer.GetPublished();
+                ASSERT_GT(published, lastPublished);
+                lastPublished = published;
+            }
+        }
+        producer.join();
+        EXPECT_FALSE(buffer.Publish());
+    }
+
+    TEST_F(TripleBufferTest, StageAndPublish_FromSeveralProducers_NeverTearsNorGoesBack)
+    {
+        struct Value
+        {
+            int m_producer = 0;
+            int m_counter = 0;
+            // Catches a slot written by two producers at the same time.
+            int m_checksum = 0;
+        };
+        constexpr int ProducerCount = 6;
+        constexpr int LastCounter = 20000;
+        TripleBuffer<Value> buffer;
+        AZStd::atomic<int> finishedProducers{ 0 };
+        AZStd::vector<AZStd::thread> producers;
+        for (int producerIndex = 0; producerIndex < ProducerCount; ++producerIndex)
+        {
+            producers.emplace_back([&buffer, &finishedProducers, producerIndex]()
+                {
+                    for (int counter = 1; counter <= LastCounter; ++counter)
+                    {
+                        buffer.Stage(Value{ producerIndex, counter, producerIndex * LastCounter + counter });
+                    }
+                    finishedProducers.fetch_add(1);
+                });
+        }
+
+        // The values of each producer are staged in order, so the consumer never sees them go back.
+        AZStd::array<int, ProducerCount> lastPublished{};
+        bool isFinished = false;
+        while (!isFinished)
+        {
+            isFinished = finishedProducers.load() == ProducerCount;
+            if (buffer.Publish())
+            {
+                const Value published = buffer.GetPublished();
+                ASSERT_GE(published.m_producer, 0);
+                ASSERT_LT(published.m_producer, ProducerCount);
+                ASSERT_EQ(published.m_checksum, published.m_producer * LastCounter + published.m_counter);
+                ASSERT_GT(published.m_counter, lastPublished[published.m_producer]);
+                lastPublished[published.m_producer] = published.m_counter;
+            }
+        }
+        for (AZStd::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        // The last producer to stage wins, and its last value is the only one that can be left.
+        EXPECT_EQ(buffer.GetPublished().m_counter, LastCounter);
+        EXPECT_FALSE(buffer.Publish());
+    }
+
+} // namespace UnitTest
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) Galib Arrieta (aka lumbermixalot@github, aka galibzon@github).
+*
+* SPDX-License-Identifier: Apache-2.0 OR MIT
+*
+*/
+
+#include <AzTest/AzTest.h>
+#include <AzTest/Utils.h>
+#include <AzCore/IO/Path/Path.h>
+#include <AzCore/UnitTest/TestTypes.h>
+
+#include <Renderer/VolumetricCloudsStatsCollector.h>
+
+namespace UnitTest
+{
+    using namespace VolumetricClouds;
+
+    class VolumetricCloudsStatsCollectorTest
+        : public LeakDetectionFixture
+    {
+    protected:
+        static constexpr char ScopeName[] = "GPU/CloudscapeComputePass";
+        static constexpr StatsScope Scope = StatsScope::CloudscapeComputeGpu;
+    };
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, GetScopeStats_OneToHundred_ReturnsNearestRankPercentiles)
+    {
+        VolumetricCloudsStatsCollector collector;
+        // Not in order, the stats must not depend on it.
+        for (uint32_t sample = 100; sample >= 1; --sample)
+        {
+            collector.AddSample(Scope, static_cast<float>(sample));
+        }
+
+        VolumetricCloudsScopeStats stats;
+        ASSERT_TRUE(collector.GetScopeStats(ScopeName, stats));
+        EXPECT_EQ(stats.m_sampleCount, 100u);
+        EXPECT_FLOAT_EQ(stats.m_averageMs, 50.5f);
+        EXPECT_FLOAT_EQ(stats.m_p50Ms, 50.0f);
+        EXPECT_FLOAT_EQ(stats.m_p95Ms, 95.0f);
+        EXPECT_FLOAT_EQ(stats.m_p99Ms, 99.0f);
+        EXPECT_FLOAT_EQ(stats.m_maxMs, 100.0f);
+    }
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, GetScopeStats_MoreSamplesThanTheRingBuffer_KeepsTheLatest)
+    {
+        VolumetricCloudsStatsCollector collector;
+        for (uint32_t sample = 1; sample <= 300; ++sample)
+        {
+            collector.AddSample(Scope, static_cast<float>(sample));
+        }
+
+        // Samples 45 to 300.
+        VolumetricCloudsScopeStats stats;
+        ASSERT_TRUE(collector.GetScopeStats(ScopeName, stats));
+        EXPECT_EQ(stats.m_sampleCount, 256u);
+        EXPECT_FLOAT_EQ(stats.m_averageMs, 172.5f);
+        EXPECT_FLOAT_EQ(stats.m_p50Ms, 172.0f);
+        EXPECT_FLOAT_EQ(stats.m_maxMs, 300.0f);
+    }
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, ResetStats_DiscardsTheSamples)
+    {
+        VolumetricCloudsStatsCollector collector;
+        collector.AddSample(Scope, 1.0f);
+        collector.ResetStats();
+
+        VolumetricCloudsScopeStats stats;
+        ASSERT_TRUE(collector.GetScopeStats(ScopeName, stats));
+        EXPECT_EQ(stats.m_sampleCount, 0u);
+        EXPECT_FLOAT_EQ(stats.m_maxMs, 0.0f);
+    }
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, GetScopeStats_UnknownScope_ReturnsFalse)
+    {
+        VolumetricCloudsStatsCollector collector;
+        VolumetricCloudsScopeStats stats;
+        EXPECT_FALSE(collector.GetScopeStats("GPU/NotAPass", stats));
+    }
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, StopCsvFrameLog_RestoresTheCollectingStatsState)
+    {
+        AZ::Test::ScopedAutoTempDirectory tempDirectory;
+        const AZStd::string csvFilePath = (AZ::IO::Path(tempDirectory.GetDirectory()) / "Frames.csv").Native();
+        VolumetricCloudsStatsCollector collector;
+        collector.SetCollectingStats(false);
+
+        ASSERT_TRUE(collector.StartCsvFrameLog(csvFilePath));
+        EXPECT_TRUE(collector.IsCollectingStats());
+        collector.StopCsvFrameLog();
+        EXPECT_FALSE(collector.IsCollectingStats());
+
+        // Stopping it again must not touch a state set after the log ended.
+        collector.SetCollectingStats(true);
+        collector.StopCsvFrameLog();
+        EXPECT_TRUE(collector.IsCollectingStats());
+        collector.SetCollectingStats(false);
+    }
+
+    TEST_F(VolumetricCloudsStatsCollectorTest, StopCsvFrameLog_DuringABenchmark_KeepsCollectingUntilTheBenchmarkEnds)
+    {
+        AZ::Test::ScopedAutoTempDirectory tempDirectory;
+        const AZ::IO::Path directory(tempDirectory.GetDirectory());
+        {
+            VolumetricCloudsStatsCollector collector;
+            collector.SetCollectingStats(false);
+
+            ASSERT_TRUE(collector.StartCsvFrameLog((directory / "Frames.csv").Native()));
+            ASSERT_TRUE(collector.StartBenchmark("before", 10, (directory / "Summary.csv").Native()));
+            collector.StopCsvFrameLog();
+            EXPECT_TRUE(collector.IsCollectingStats());
+        }
+        // The benchmark was still running when the collector was destroyed.
+        EXPECT_FALSE(VolumetricCloudsStatsCollector::IsCollecting());
+    }
+
+} // namespace UnitTest
@@ -1,6 +1,8 @@
 
 set(FILES
     Include/VolumetricClouds/VolumetricCloudsBus.h
+    Include/VolumetricClouds/VolumetricCloudsStatsBus.h
+    Include/VolumetricClouds/CloudQueryBus.h
     Include/VolumetricClouds/VolumetricCloudsTypeIds.h
     Include/VolumetricClouds/CloudTextureProviderBus.h
 )
@@ -35,6 +35,21 @@ set(FILES
     Source/Renderer/CloudMaterialProperties.h
     Source/Renderer/CloudscapeShaderConstantData.cpp
     Source/Renderer/CloudscapeShaderConstantData.h
+    Source/Renderer/CloudscapeRenderSettings.cpp
+    Source/Renderer/CloudscapeRenderSettings.h
+    Source/Renderer/CloudParameterAnimation.cpp
+    Source/Renderer/CloudParameterAnimation.h
+    Source/Renderer/CloudDensitySampler.cpp
+    Source/Renderer/CloudDensitySampler.h
+    Source/Renderer/CloudPhaseFunctionLut.cpp
+    Source/Renderer/CloudPhaseFunctionLut.h
+    Source/Renderer/CloudSkyIrradiance.cpp
+    Source/Renderer/CloudSkyIrradiance.h
+    Source/Renderer/CloudscapeQualityController.cpp
+    Source/Renderer/CloudscapeQualityController.h
+    Source/Renderer/VolumetricCloudsStatsCollector.cpp
+    Source/Renderer/VolumetricCloudsStatsCollector.h
+    Source/Renderer/TripleBuffer.h
     Source/Renderer/Passes/CloudTextureComputePass.cpp
     Source/Renderer/Passes/CloudTextureComputePass.h
     Source/Renderer/Passes/CloudTextureComputeData.cpp
@@ -43,4 +58,14 @@ set(FILES
     Source/Renderer/Passes/CloudscapeRasterPass.h
     Source/Renderer/Passes/CloudscapeComputePass.cpp
     Source/Renderer/Passes/CloudscapeComputePass.h
+    Source/Renderer/Passes/CloudscapeSkyViewComputePass.cpp
+    Source/Renderer/Passes/CloudscapeSkyViewComputePass.h
+    Source/Renderer/Passes/CloudscapeSunVisibilityComputePass.cpp
+    Source/Renderer/Passes/CloudscapeSunVisibilityComputePass.h
+    Source/Renderer/Passes/CloudscapeShadowMapComputePass.cpp
+    Source/Renderer/Passes/CloudscapeShadowMapComputePass.h
+    Source/Renderer/Passes/CloudscapeShadowMapBarrierPass.cpp
+    Source/Renderer/Passes/CloudscapeShadowMapBarrierPass.h
+    Source/Renderer/Passes/CloudscapeStereoReprojectionComputePass.cpp
+    Source/Renderer/Passes/CloudscapeStereoReprojectionComputePass.h
 )
@@ -6,4 +6,11 @@
 
 set(FILES
     Tests/Clients/VolumetricCloudsTest.cpp
+    Tests/Clients/CloudParameterAnimationTest.cpp
+    Tests/Clients/CloudscapeQualityControllerTest.cpp
+    Tests/Clients/TripleBufferTest.cpp
+    Tests/Clients/CloudDensitySamplerTest.cpp
+    Tests/Clients/CloudPhaseFunctionLutTest.cpp
+    Tests/Clients/CloudSkyIrradianceTest.cpp
+    Tests/Clients/VolumetricCloudsStatsCollectorTest.cpp
 )